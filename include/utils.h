@@ -31,3 +31,14 @@ static auto GetRandomLocalColor() -> Color
 
     return {red, green, blue};
 }
+
+// Same from a caller owned generator, the sequence of colors repeats with the seed
+static auto GetRandomLocalColor(std::mt19937& generator) -> Color
+{
+    auto dist = std::uniform_int_distribution<>(0, 255);
+    const auto red = std::uint8_t(dist(generator));
+    const auto green = std::uint8_t(dist(generator));
+    const auto blue = std::uint8_t(dist(generator));
+
+    return {red, green, blue};
+}
@@ -1,17 +1,34 @@
 #include "SFML/Graphics.hpp"
+#include "bui_watcher.h"
+#include "display_list.h"
+#include "frame_profiler.h"
+#include "frame_scheduler.h"
+#include "input_recording.h"
 #include "renderer.h"
+#include "series_file.h"
+#include "texture_cache.h"
+#include "triple_buffer.h"
 #include "types.h"
 #include "uielement.h"
 #include "uitree.h"
+#include "uitree_commands.h"
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Window/ContextSettings.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Window/Keyboard.hpp>
 #include <SFML/Window/WindowEnums.hpp>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <queue>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
 #include <rect.h>
 #include <utils.h>
 
@@ -20,10 +37,185 @@
 #include "iostream"
 #include "plot_area.h"
 
-int main()
+namespace {
+
+struct Options {
+    std::optional<std::filesystem::path> layout;
+    // every window event is saved to this file on exit
+    std::optional<std::filesystem::path> record;
+    // recorded events are fed into the update loop instead of window input
+    std::optional<std::filesystem::path> replay;
+    // replay without a window and render thread as fast as possible
+    bool headless = false;
+    // plotted instead of the built in data, a .csv file is converted to a series file next to it
+    std::optional<std::filesystem::path> series;
+};
+
+// main [layout.bui] [--record <file>] [--replay <file> [--headless]] [--series <file>]
+auto ParseOptions(int argc, char** argv) -> Options
+{
+    auto options = Options();
+    for (int arg = 1; arg < argc; arg++) {
+        const auto name = std::string_view(argv[arg]);
+        if (name == "--headless") {
+            options.headless = true;
+        }
+        else if ((name == "--record" || name == "--replay") && arg + 1 < argc) {
+            (name == "--record" ? options.record : options.replay) = argv[++arg];
+        }
+        else if (name == "--series" && arg + 1 < argc) {
+            options.series = argv[++arg];
+        }
+        else if (!name.starts_with("--")) {
+            options.layout = name;
+        }
+        else {
+            throw std::runtime_error(std::format("Unknown option - {}", name));
+        }
+    }
+
+    if (options.headless && !options.replay) {
+        throw std::runtime_error("--headless needs --replay");
+    }
+
+    return options;
+}
+
+// Series files are opened as they are, csv files are converted first unless an up to date
+// series file already exists next to them
+auto OpenSeriesFile(const std::filesystem::path& path) -> SeriesFile
+{
+    if (path.extension() != ".csv") {
+        return SeriesFile(path);
+    }
+
+    auto seriesPath = path;
+    seriesPath.replace_extension(".uisf");
+    if (!std::filesystem::exists(seriesPath) ||
+        std::filesystem::last_write_time(seriesPath) < std::filesystem::last_write_time(path)) {
+        const auto samples = ConvertCsvToSeriesFile(path, seriesPath);
+        std::cout << std::format("Converted {} samples to {}", samples, seriesPath.string()) << std::endl;
+    }
+
+    return SeriesFile(seriesPath);
+}
+
+// State changed by input, shared by the window loop and the headless replay
+struct InputState {
+    int addedElements = 0;
+    bool showProfiler = false;
+    // colors of added elements, seeded the same on every run so a replay builds the recorded tree
+    std::mt19937 colors = std::mt19937(0x5eed);
+};
+
+// Returns false when the window should close
+auto HandleEvent(const sf::Event& event, UiTree& uiTree, InputState& state) -> bool
+{
+    if (event.is<sf::Event::Closed>()) {
+        return false;
+    }
+
+    if (const auto* resized = event.getIf<sf::Event::Resized>()) {
+        auto* root = uiTree.GetRoot();
+        root->properties.width = static_cast<float>(resized->size.x);
+        root->properties.height = static_cast<float>(resized->size.y);
+        root->RearrangeChildren();
+        root->Invalidate();
+    }
+    else if (const auto* key = event.getIf<sf::Event::KeyPressed>(); key && key->code == sf::Keyboard::Key::F3) {
+        state.showProfiler = !state.showProfiler;
+    }
+    else if (event.is<sf::Event::KeyPressed>()) {
+        auto& i = state.addedElements;
+
+        auto newElem = std::make_unique<UiElement>(std::format("elem-{}", i), ElemType::Box);
+        newElem->properties.border_radius_px = 20;
+        newElem->properties.color = GetRandomLocalColor(state.colors);
+        newElem->properties.layout_children = LayoutDirection::Horizontal;
+        newElem->properties.height = 100;
+        newElem->properties.width = 200;
+        newElem->properties.position = {10, 20};
+
+        if (i < 4) {
+            uiTree.GetRoot()->AddChild(std::move(newElem));
+        }
+        else {
+            auto elem = uiTree.GetChild("elem-0");
+
+            newElem->properties.width = 20;
+            newElem->properties.border_radius_px = 3;
+            elem->AddChild(std::move(newElem));
+        }
+
+        i++;
+    }
+
+    return true;
+}
+
+void PrintReplayReport(const FrameProfiler& profiler, uint64_t frames)
+{
+    const auto& histogram = profiler.GetHistogram();
+    std::cout << std::format("Replayed {} frames, frame time p50 {:.1f} us, p95 {:.1f} us, p99 {:.1f} us, "
+                             "max {:.1f} us",
+                             frames, histogram.GetPercentile(50), histogram.GetPercentile(95),
+                             histogram.GetPercentile(99), histogram.GetPercentile(100))
+              << std::endl;
+}
+
+// Runs the update loop over a recording without a window, every frame advances the
+// virtual clock by frameInterval no matter how long it took
+auto RunHeadlessReplay(const Options& options, std::chrono::microseconds frameInterval) -> int
+{
+    auto uiTree = std::make_unique<UiTree>(Size(1920, 1080));
+    uiTree->GetRoot()->properties.color = {20, 10, 2};
+    uiTree->GetRoot()->properties.layout_children = LayoutDirection::Horizontal;
+
+    auto hotReload = options.layout ? std::make_unique<BuiHotReload>(*options.layout, *uiTree) : nullptr;
+
+    auto renderQue = std::queue<UiElement*>();
+    auto renderer = std::make_unique<Renderer>(renderQue);
+    auto profiler = std::make_unique<FrameProfiler>();
+    renderer->SetProfiler(profiler.get());
+
+    auto replay = InputReplay(LoadInputRecordingFile(*options.replay), frameInterval);
+    auto state = InputState();
+    auto displayList = DisplayList();
+    bool running = true;
+
+    while (running && !replay.IsFinished()) {
+        profiler->BeginFrame();
+
+        while (const std::optional event = replay.PollEvent()) {
+            running = HandleEvent(*event, *uiTree, state) && running;
+        }
+
+        renderer->BuildDisplayList(uiTree.get(), displayList);
+        profiler->AddDrawCalls(static_cast<uint32_t>(displayList.GetBatchCount()));
+        profiler->EndFrame();
+
+        replay.AdvanceFrame();
+    }
+
+    PrintReplayReport(*profiler, replay.GetFrame());
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
 {
     assert(__cplusplus == 202302);
     {
+        const auto options = ParseOptions(argc, argv);
+
+        // update thread runs at the display rate, display() paces the render thread
+        const auto updateInterval = std::chrono::microseconds(1'000'000 / 144);
+
+        if (options.headless) {
+            return RunHeadlessReplay(options, updateInterval);
+        }
+
         sf::ContextSettings settings;
         settings.antiAliasingLevel = 16;
 
@@ -35,63 +227,178 @@ int main()
         uiTree->GetRoot()->properties.color = {20, 10, 2};
         uiTree->GetRoot()->properties.layout_children = LayoutDirection::Horizontal;
 
+        // background threads change the tree only through this queue, applied before every frame
+        auto commands = std::make_unique<UiTreeCommandQueue>();
+
+        // optional layout file, reloaded on every save
+        auto hotReload = options.layout ? std::make_unique<BuiHotReload>(*options.layout, *uiTree) : nullptr;
+
+        auto recorder = options.record ? std::make_unique<InputRecorder>() : nullptr;
+        auto replay = options.replay ? std::make_unique<InputReplay>(LoadInputRecordingFile(*options.replay),
+                                                                     updateInterval)
+                                     : nullptr;
+
         auto renderQue = std::queue<UiElement*>();
         auto renderer = std::make_unique<Renderer>(renderQue);
 
+        // F3 toggles the frame time overlay, graph height is 1/60 s
+        auto profiler = std::make_unique<FrameProfiler>();
+        auto profilerOverlay = ProfilerOverlay(*profiler, {10, 10}, 200, 1'000'000.0 / 60);
+        renderer->SetProfiler(profiler.get());
+
+        // image elements are decoded in the background and drawn as boxes until they are ready
+        auto textureCache = std::make_unique<TextureCache>();
+        renderer->SetTextureCache(textureCache.get());
+
         uint32_t prevPosition = 100;
 
         // auto data = std::vector<double>{100, 500, 100, 500, 100, 500, 100, 500, 100, 500};
         auto data = std::vector<double>{100, 100, 100};
 
-        auto plotArea = std::make_unique<PlotArea>(Pos{100, 1000}, 700, data, 2, 0);
+        // values are read from the mapping, the file is never copied into a vector
+        auto seriesFile = options.series ? std::make_unique<SeriesFile>(OpenSeriesFile(*options.series)) : nullptr;
+        const auto plotted = seriesFile && seriesFile->GetSampleCount() > 0 ? seriesFile->GetSamples().values
+                                                                             : std::span<const double>(data);
+
+        auto plotArea = std::make_unique<PlotArea>(Pos{100, 1000}, 700, plotted, 2, 0);
         auto vertices = plotArea->GetVertexArray();
 
-        int i = 0;
+        auto inputState = InputState();
 
         std::cout << "Y is : " << GetInterpolatedPosY({1, 1}, {2, 4}, {3, 9}, 2.5).top << std::endl;
 
-        while (window.isOpen()) {
-            window.clear();
+        // Frames are pipelined: this thread handles events, mutates the tree and builds a display
+        // list, the render thread draws the latest published list. While frame N is drawn frame
+        // N + 1 is already being built, a slow layout no longer blocks presenting.
+        auto displayLists = TripleBuffer<DisplayList>();
+        auto running = std::atomic<bool>(true);
+        auto submissionMicroseconds = std::atomic<double>(0);
 
-            while (const std::optional event = window.pollEvent()) {
-                if (event->is<sf::Event::Closed>()) {
-                    window.close();
+        if (!window.setActive(false)) {
+            throw std::runtime_error("Failed to release window context for the render thread");
+        }
+
+        auto renderThread = std::jthread([&window, &displayLists, &running, &submissionMicroseconds] {
+            if (!window.setActive(true)) {
+                running = false;
+                return;
+            }
+
+            // nothing is drawn until the update thread publishes a new list
+            while (running.load(std::memory_order_relaxed)) {
+                displayLists.WaitForPublish();
+
+                // the wake-up at shutdown publishes a stale list whose textures may already be freed
+                if (!running.load(std::memory_order_relaxed)) {
+                    break;
                 }
-                else if (event->is<sf::Event::KeyPressed>()) {
-
-                    auto newElem = std::make_unique<UiElement>(std::format("elem-{}", i), ElemType::Box);
-                    newElem->properties.border_radius_px = 20;
-                    newElem->properties.color = GetRandomLocalColor();
-                    newElem->properties.layout_children = LayoutDirection::Horizontal;
-                    newElem->properties.height = 100;
-                    newElem->properties.width = 200;
-                    newElem->properties.position = {10, 20};
-
-                    if (i < 4) {
-                        uiTree->GetRoot()->AddChild(std::move(newElem));
-                    }
-                    else {
-                        auto elem = uiTree->GetChild("elem-0");
-
-                        newElem->properties.width = 20;
-                        newElem->properties.border_radius_px = 3;
-                        elem->AddChild(std::move(newElem));
-                    }
-
-                    i++;
+                displayLists.Acquire();
+
+                const auto start = std::chrono::steady_clock::now();
+                window.clear();
+                window.draw(displayLists.GetReadBuffer());
+                window.display();
+                submissionMicroseconds.store(
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count(),
+                    std::memory_order_relaxed);
+            }
+        });
+
+        // Frames are built only when something changed, an idle window waits for input instead of
+        // redrawing at the display rate. Changes posted by other threads are picked up within
+        // FrameScheduler::MAX_WAIT.
+        auto scheduler = FrameScheduler(*uiTree, updateInterval);
+
+        while (running) {
+            const auto timeout = std::chrono::duration_cast<std::chrono::microseconds>(
+                scheduler.GetWaitTimeout(std::chrono::steady_clock::now()));
+
+            // zero timeout would wait forever
+            auto event = timeout.count() > 0 ? window.waitEvent(sf::microseconds(timeout.count())) : window.pollEvent();
+            const auto showProfiler = inputState.showProfiler;
+
+            for (; event; event = window.pollEvent()) {
+                if (recorder) {
+                    recorder->Record(*event);
                 }
+
+                // while replaying only closing the window is taken from the user
+                if (!replay || event->is<sf::Event::Closed>()) {
+                    running = HandleEvent(*event, *uiTree, inputState) && running;
+                }
+            }
+
+            commands->Apply(*uiTree);
+
+            // replay advances by one virtual frame per built frame, so it keeps requesting them
+            if (replay && !replay->IsFinished()) {
+                while (const std::optional replayed = replay->PollEvent()) {
+                    running = HandleEvent(*replayed, *uiTree, inputState) && running;
+                }
+                scheduler.Invalidate();
+            }
+
+            if (hotReload && !hotReload->Poll() && !hotReload->GetLastError().empty()) {
+                std::cout << hotReload->GetLastError() << std::endl;
+            }
+
+            if (inputState.showProfiler != showProfiler) {
+                scheduler.Invalidate();
+            }
+
+            // placeholders are replaced as soon as images are uploaded
+            if (textureCache->GetPendingCount() > 0) {
+                scheduler.RequestAnimationFrame();
             }
 
-            auto drawables = renderer->GetDrawables(uiTree.get());
-            for (const auto& [_, drawable] : drawables) {
-                window.draw(*drawable);
+            if (!running || !scheduler.BeginFrame(std::chrono::steady_clock::now())) {
+                continue;
             }
 
-            window.draw(vertices);
+            // textures stay alive until the render thread moved past every list which drew them
+            profiler->BeginFrame();
+            textureCache->Update(displayLists.GetWriteSequence(), displayLists.GetReadSequence());
+            auto& displayList = displayLists.GetWriteBuffer();
+            renderer->BuildDisplayList(uiTree.get(), displayList);
+            displayList.AddVertices(vertices);
 
-            window.display();
+            // render thread submits the previous list, its time is reported with this frame
+            profiler->AddStageTime(FrameStage::Submission, submissionMicroseconds.load(std::memory_order_relaxed));
+            if (inputState.showProfiler) {
+                profilerOverlay.Update();
+                displayList.AddVertices(profilerOverlay.GetVertices());
+            }
+
+            profiler->AddDrawCalls(static_cast<uint32_t>(displayList.GetBatchCount()));
+            displayLists.Publish();
+
+            profiler->EndFrame();
+            scheduler.EndFrame();
+
+            if (replay && !replay->IsFinished()) {
+                replay->AdvanceFrame();
+                if (replay->IsFinished()) {
+                    PrintReplayReport(*profiler, replay->GetFrame());
+                }
+            }
         };
 
+        // wakes the render thread waiting for a list so it can see running is false, the published
+        // slot holds an old list and is never acquired
+        displayLists.Publish();
+
+        renderThread.join();
+        window.close();
+
+        if (recorder) {
+            recorder->Save(*options.record);
+        }
+
+        const auto& schedulerStats = scheduler.GetStats();
+        std::cout << std::format("Rendered {} frames, skipped {} at {} Hz", schedulerStats.renderedFrames,
+                                 schedulerStats.skippedFrames, 1'000'000 / updateInterval.count())
+                  << std::endl;
+
         return 0;
     }
 }
@@ -1,54 +1,121 @@
 #include "grid.h"
 #include <SFML/Graphics/Color.hpp>
-#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <cassert>
 #include <cstdint>
 #include <stdexcept>
 
+namespace {
+
+constexpr size_t VERTICES_PER_CELL = 6;
+const auto FILL_COLOR = sf::Color::Cyan;
+
+} // namespace
+
 TestGrid::TestGrid(const uint64_t gridSize, const float cellSize, sf::RenderWindow& window)
     : m_window(&window)
     , m_size(gridSize)
     , m_cellSize(cellSize)
+    , m_cells(sf::PrimitiveType::Triangles, gridSize * gridSize * VERTICES_PER_CELL)
+    , m_gridLines(sf::PrimitiveType::Lines)
+    , m_outline(sf::PrimitiveType::LineStrip)
+    , m_outlinePoints(sf::PrimitiveType::Points)
+    , m_filledFrame(gridSize * gridSize, 0)
 {
+    for (uint64_t y = 0; y < gridSize; y++) {
+        for (uint64_t x = 0; x < gridSize; x++) {
+            const auto left = x * m_cellSize;
+            const auto top = y * m_cellSize;
+            const auto right = left + m_cellSize;
+            const auto bottom = top + m_cellSize;
+
+            auto* quad = &m_cells[(y * gridSize + x) * VERTICES_PER_CELL];
+            quad[0].position = {left, top};
+            quad[1].position = {right, top};
+            quad[2].position = {left, bottom};
+            quad[3].position = {left, bottom};
+            quad[4].position = {right, top};
+            quad[5].position = {right, bottom};
+            for (size_t i = 0; i < VERTICES_PER_CELL; i++) {
+                quad[i].color = sf::Color::Transparent;
+            }
+        }
+    }
+
     auto outlineColor = sf::Color::White;
     outlineColor.a = 45;
 
-    for (uint32_t y = 0; y < gridSize; y++) {
-        auto tmpVector = std::vector<sf::RectangleShape>{};
-        tmpVector.reserve(gridSize);
-        for (uint32_t x = 0; x < gridSize; x++) {
-            auto shape = sf::RectangleShape({m_cellSize, m_cellSize});
-            shape.setPosition({x * m_cellSize, static_cast<float>(y * m_cellSize)});
-            shape.setFillColor(sf::Color::Transparent);
-            shape.setOutlineThickness(1);
-            shape.setOutlineColor(outlineColor);
-            tmpVector.push_back(shape);
-        }
-        m_grid.push_back((tmpVector));
+    const auto extent = gridSize * m_cellSize;
+    for (uint64_t line = 0; line <= gridSize; line++) {
+        const auto offset = line * m_cellSize;
+        m_gridLines.append({{offset, 0}, outlineColor});
+        m_gridLines.append({{offset, extent}, outlineColor});
+        m_gridLines.append({{0, offset}, outlineColor});
+        m_gridLines.append({{extent, offset}, outlineColor});
     }
 }
 
-void TestGrid::Draw(std::vector<pos> positions)
+void TestGrid::Draw(const std::vector<pos>& positions)
 {
-    assert(m_grid[0].size() == m_size && "Row size needs to equal grid size");
-    assert(m_grid.size() == m_size && "Row count needs to equal grid size");
+    assert(m_cells.getVertexCount() == m_size * m_size * VERTICES_PER_CELL && "Cell count needs to equal grid size");
 
-    m_window->clear();
+    counter++;
 
-    auto color = sf::Color::Cyan;
     for (const auto& pos : positions) {
-        if (pos.y >= m_grid.size() || pos.x >= m_grid.size()) {
+        if (pos.y >= m_size || pos.x >= m_size) {
             throw std::runtime_error("Cant handle positions outside of the grid");
-            continue;
         }
-        m_grid[pos.y][pos.x].setFillColor(color);
+
+        const auto cell = pos.y * m_size + pos.x;
+        if (m_filledFrame[cell] == 0) {
+            SetCellColor(cell, FILL_COLOR);
+            m_filled.push_back(cell);
+        }
+        m_filledFrame[cell] = counter;
     }
 
-    for (const auto& row : m_grid) {
-        for (const auto& elem : row) {
-            m_window->draw(elem);
+    // cells not filled again are cleared, m_filled keeps only the current ones
+    std::erase_if(m_filled, [this](uint64_t cell) {
+        if (m_filledFrame[cell] == counter) {
+            return false;
         }
+
+        SetCellColor(cell, sf::Color::Transparent);
+        m_filledFrame[cell] = 0;
+        return true;
+    });
+
+    m_window->clear();
+    m_window->draw(m_cells);
+    m_window->draw(m_gridLines);
+    m_window->draw(m_outline);
+    m_window->draw(m_outlinePoints);
+}
+
+void TestGrid::SetOutline(const std::vector<sf::Vector2f>& points)
+{
+    m_outline.clear();
+    m_outlinePoints.clear();
+    if (points.empty()) {
+        return;
     }
 
-    counter++;
+    for (const auto& point : points) {
+        const auto position = (point + sf::Vector2f{0.5f, 0.5f}) * m_cellSize;
+        m_outline.append({position, sf::Color::Yellow});
+        m_outlinePoints.append({position, sf::Color::Red});
+    }
+    m_outline.append(m_outline[0]);
+}
+
+auto TestGrid::GetCellSize() const -> float { return m_cellSize; }
+
+void TestGrid::SetCellColor(uint64_t cell, sf::Color color)
+{
+    auto* quad = &m_cells[cell * VERTICES_PER_CELL];
+    for (size_t i = 0; i < VERTICES_PER_CELL; i++) {
+        quad[i].color = color;
+    }
 }
@@ -1,22 +1,48 @@
-#include <SFML/Graphics/RectangleShape.hpp>
+#pragma once
+
+#include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 #include <SFML/Window/Window.hpp>
 #include <cstdint>
+#include <vector>
 
 struct pos {
     uint32_t x;
     uint32_t y;
 };
 
+// Grid of square cells for inspecting tessellation output, every cell is a quad in one
+// vertex array so a frame is four draw calls regardless of the size: cells, grid lines,
+// outline and outline points
 class TestGrid {
   public:
     TestGrid(const uint64_t gridSize, const float cellSize, sf::RenderWindow& window);
-    void Draw(std::vector<pos> positions);
+
+    // Fills cells at positions, cells filled by the previous call are cleared. Only
+    // vertices of cells which changed are written
+    void Draw(const std::vector<pos>& positions);
+
+    // Closed polygon drawn over the cells, points are in cell units and connect cell
+    // centers. Lines and points stay one pixel wide at any zoom
+    void SetOutline(const std::vector<sf::Vector2f>& points);
+
+    auto GetCellSize() const -> float;
 
   private:
+    void SetCellColor(uint64_t cell, sf::Color color);
+
     sf::RenderWindow* m_window;
     uint64_t m_size;
-    std::vector<std::vector<sf::RectangleShape>> m_grid;
     float m_cellSize;
-    int counter = 0;
+
+    sf::VertexArray m_cells;
+    sf::VertexArray m_gridLines;
+    sf::VertexArray m_outline;
+    sf::VertexArray m_outlinePoints;
+
+    // frame in which a cell was last filled, cells of older frames are cleared
+    std::vector<uint32_t> m_filledFrame;
+    std::vector<uint64_t> m_filled;
+    uint32_t counter = 0;
 };
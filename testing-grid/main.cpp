@@ -2,9 +2,11 @@
 #include "rect.h"
 #include "types.h"
 #include <SFML/Graphics/Color.hpp>
-#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
+#include <optional>
 
 constexpr unsigned int SCREEN_WIDTH = 2400;
 constexpr unsigned int SCREEN_HEIGHT = 1800;
@@ -12,6 +14,48 @@ constexpr uint32_t CELL_NUMBER = 150;
 constexpr float CELL_WIDTH = static_cast<float>(SCREEN_WIDTH) / CELL_NUMBER;
 constexpr unsigned int SCREEN_HEIGH_ADJUSTED = CELL_NUMBER * CELL_WIDTH;
 
+// each wheel step zooms by this factor around the cursor
+constexpr float ZOOM_STEP = 1.25f;
+constexpr float PAN_STEP_PX = 50;
+
+namespace {
+
+// Tessellated rect inspected by the viewer, Add / Subtract change the border radius
+struct InspectedRect {
+    Components::Size size = {100, 50};
+    Components::Border border = {10};
+    Pos position = {30, 30};
+};
+
+void ShowRect(const InspectedRect& inspected, TestGrid& testGrid, std::vector<pos>& cells)
+{
+    const auto positions = Components::Rect(inspected.size, inspected.border, inspected.position).GetPositions();
+
+    cells.clear();
+    auto outline = std::vector<sf::Vector2f>{};
+    for (const auto& p : positions) {
+        cells.push_back({static_cast<uint32_t>(p.left), static_cast<uint32_t>(p.top)});
+        outline.push_back({p.left, p.top});
+    }
+
+    testGrid.SetOutline(outline);
+    std::cout << "radius " << inspected.border.radius << ", " << positions.size() << " points" << std::endl;
+}
+
+// Zooms the view keeping the point under the cursor in place
+void ZoomAt(sf::RenderWindow& window, sf::View& view, sf::Vector2i pixel, float factor)
+{
+    const auto before = window.mapPixelToCoords(pixel);
+    view.zoom(factor);
+    window.setView(view);
+
+    const auto after = window.mapPixelToCoords(pixel);
+    view.setCenter(view.getCenter() + before - after);
+    window.setView(view);
+}
+
+} // namespace
+
 int main()
 {
     // Create the main window
@@ -20,41 +64,83 @@ int main()
 
     auto testGrid = TestGrid(CELL_NUMBER, CELL_WIDTH, window);
 
-    auto testRect = Components::Rect({100, 50}, {10}, {30, 30});
-    auto positions = testRect.GetPositions();
-    auto transformedPos = std::vector<pos>{};
-    for (const auto& p : positions) {
-        std::cout << p.left << "  " << p.top << std::endl;
-        transformedPos.push_back({p.left, p.top});
-    }
-
-    // auto circlePositions = std::vector<Components::Pos>();
-    // for (int x = 25; x < 76; x++) {
-    //     const auto pos = Components::GetCircleXPos(x, {50, 50}, CircleSide::Bottom, 25);
-    //     circlePositions.push_back(pos);
-    // }
+    // Viewer controls: wheel zooms, left drag or arrows pan, Add / Subtract change the
+    // radius, Space toggles the outline, R resets the view
+    auto inspected = InspectedRect();
+    auto cells = std::vector<pos>{};
+    ShowRect(inspected, testGrid, cells);
 
-    // for (int x = 25; x < 76; x++) {
-    //     const auto pos = Components::GetCircleXPos(x, {50, 50}, CircleSide::Top, 25);
-    //     circlePositions.push_back(pos);
-    // }
-
-    // auto transformedPos = std::vector<pos>{};
-    // for (const auto& p : circlePositions) {
-    //     std::cout << p.left << "  " << p.top << std::endl;
-    //     transformedPos.push_back({p.left, p.top});
-    // }
+    auto view = window.getDefaultView();
+    bool showOutline = true;
+    auto dragFrom = std::optional<sf::Vector2i>();
 
     // Start the game loop
     while (window.isOpen()) {
         // Process events
         while (const std::optional event = window.pollEvent()) {
             // Close window: exit
-            if (event->is<sf::Event::Closed>())
+            if (event->is<sf::Event::Closed>()) {
                 window.close();
+            }
+            else if (const auto* scrolled = event->getIf<sf::Event::MouseWheelScrolled>()) {
+                ZoomAt(window, view, scrolled->position, scrolled->delta > 0 ? 1 / ZOOM_STEP : ZOOM_STEP);
+            }
+            else if (const auto* pressed = event->getIf<sf::Event::MouseButtonPressed>();
+                     pressed && pressed->button == sf::Mouse::Button::Left) {
+                dragFrom = pressed->position;
+            }
+            else if (event->is<sf::Event::MouseButtonReleased>()) {
+                dragFrom.reset();
+            }
+            else if (const auto* moved = event->getIf<sf::Event::MouseMoved>(); moved && dragFrom) {
+                view.setCenter(view.getCenter() + window.mapPixelToCoords(*dragFrom) -
+                               window.mapPixelToCoords(moved->position));
+                window.setView(view);
+                dragFrom = moved->position;
+            }
+            else if (const auto* key = event->getIf<sf::Event::KeyPressed>()) {
+                // pan distance is in screen pixels at the current zoom
+                const auto pan = PAN_STEP_PX * view.getSize().x / static_cast<float>(window.getSize().x);
+
+                switch (key->code) {
+                case sf::Keyboard::Key::Add:
+                    inspected.border.radius = std::min(inspected.border.radius + 1, inspected.size.height / 2);
+                    ShowRect(inspected, testGrid, cells);
+                    break;
+                case sf::Keyboard::Key::Subtract:
+                    inspected.border.radius = std::max(inspected.border.radius - 1, 0.f);
+                    ShowRect(inspected, testGrid, cells);
+                    break;
+                case sf::Keyboard::Key::Space:
+                    showOutline = !showOutline;
+                    testGrid.SetOutline({});
+                    if (showOutline) {
+                        ShowRect(inspected, testGrid, cells);
+                    }
+                    break;
+                case sf::Keyboard::Key::R:
+                    view = window.getDefaultView();
+                    break;
+                case sf::Keyboard::Key::Left:
+                    view.setCenter(view.getCenter() + sf::Vector2f{-pan, 0});
+                    break;
+                case sf::Keyboard::Key::Right:
+                    view.setCenter(view.getCenter() + sf::Vector2f{pan, 0});
+                    break;
+                case sf::Keyboard::Key::Up:
+                    view.setCenter(view.getCenter() + sf::Vector2f{0, -pan});
+                    break;
+                case sf::Keyboard::Key::Down:
+                    view.setCenter(view.getCenter() + sf::Vector2f{0, pan});
+                    break;
+                default:
+                    break;
+                }
+                window.setView(view);
+            }
         }
 
-        testGrid.Draw(transformedPos);
+        testGrid.Draw(cells);
 
         // Update the window
         window.display();
@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "compressed_series.h"
+#include "plot_aggregation.h"
+#include "plot_area.h"
+#include "plot_heatmap.h"
+#include "rect.h"
+
+static void BM_RectConstruction(benchmark::State& state)
+{
+    const auto radius = static_cast<float>(state.range(0));
+
+    for (auto _ : state) {
+        auto rect = Components::Rect({200, 200}, {radius, 1}, {10, 10});
+        benchmark::DoNotOptimize(rect.GetUnderlayingShape());
+    }
+    state.counters["points"] = static_cast<double>(Components::Rect({200, 200}, {radius, 1}, {10, 10})
+                                                       .GetUnderlayingShape()
+                                                       ->getPointCount());
+}
+BENCHMARK(BM_RectConstruction)->Arg(0)->Arg(5)->Arg(20)->Arg(50)->Arg(100);
+
+static void BM_PlotAreaConstruction(benchmark::State& state)
+{
+    auto data = std::vector<double>(state.range(0));
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = 100 + 50 * std::sin(static_cast<double>(i) * 0.01);
+    }
+
+    for (auto _ : state) {
+        auto plotArea = PlotArea({0, 500}, 1000, data, 1, 10);
+        benchmark::DoNotOptimize(plotArea);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PlotAreaConstruction)->RangeMultiplier(10)->Range(1'000, 10'000'000)->Unit(benchmark::kMillisecond);
+
+static void BM_ColormapMap(benchmark::State& state)
+{
+    auto values = std::vector<float>(state.range(0));
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<float>(std::sin(static_cast<double>(i) * 0.01));
+    }
+    auto pixels = std::vector<uint32_t>(values.size());
+    const auto colormap = Colormap::Viridis();
+
+    for (auto _ : state) {
+        colormap.Map(values, {-1, 1}, pixels);
+        benchmark::DoNotOptimize(pixels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ColormapMap)->RangeMultiplier(16)->Range(256, 1 << 20);
+
+// One spectrogram column per iteration, 4096 bins downsampled to 512 pixel rows
+static void BM_HeatmapPushColumn(benchmark::State& state)
+{
+    auto heatmap = PlotHeatmap({0, 0}, {1000, 512}, 4096, 1000, {0, 1});
+    auto column = std::vector<float>(4096);
+    for (size_t i = 0; i < column.size(); i++) {
+        column[i] = static_cast<float>(i % 100) / 100;
+    }
+
+    for (auto _ : state) {
+        heatmap.PushColumn(column);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(column.size()));
+}
+BENCHMARK(BM_HeatmapPushColumn);
+
+// Histogram and 1000 sample intervals of a 10M sample batch, argument is the number of pool threads
+static void BM_SampleAggregatorAppend(benchmark::State& state)
+{
+    auto samples = std::vector<double>(10'000'000);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = std::sin(static_cast<double>(i) * 0.001) * 100;
+    }
+    const auto threads = static_cast<size_t>(state.range(0));
+    auto pool = std::optional<AggregationPool>();
+    if (threads > 0) {
+        pool.emplace(threads);
+    }
+
+    for (auto _ : state) {
+        auto aggregator = SampleAggregator({-100, 100}, 256, 1000, pool ? &*pool : nullptr);
+        aggregator.Append(samples);
+        benchmark::DoNotOptimize(aggregator.GetIntervals().data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(samples.size()));
+}
+BENCHMARK(BM_SampleAggregatorAppend)->Arg(0)->Arg(1)->Arg(3)->Arg(7)->Unit(benchmark::kMillisecond);
+
+// One day of 1 Hz samples of a slowly changing gauge, like a long plot history
+static auto MakeCompressedDay(uint32_t samplesPerBlock) -> CompressedSeries
+{
+    auto series = CompressedSeries(samplesPerBlock);
+    for (int i = 0; i < 86'400; i++) {
+        series.Append(int64_t(1'700'000'000'000) + i * 1000, std::round(std::sin(i / 3600.0) * 1000) / 10);
+    }
+    return series;
+}
+
+static void BM_CompressedSeriesAppend(benchmark::State& state)
+{
+    auto ratio = 0.0;
+    for (auto _ : state) {
+        const auto series = MakeCompressedDay(static_cast<uint32_t>(state.range(0)));
+        ratio = series.GetCompressionRatio();
+    }
+    state.SetItemsProcessed(state.iterations() * 86'400);
+    state.counters["ratio"] = ratio;
+}
+BENCHMARK(BM_CompressedSeriesAppend)->Arg(256)->Arg(1024)->Arg(4096)->Unit(benchmark::kMillisecond);
+
+// Whole history decoded every iteration, the cache holds fewer blocks than the history has
+static void BM_CompressedSeriesDecode(benchmark::State& state)
+{
+    auto series = MakeCompressedDay(static_cast<uint32_t>(state.range(0)));
+    auto timestamps = std::vector<int64_t>();
+    auto values = std::vector<double>();
+
+    for (auto _ : state) {
+        series.Read({std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()}, timestamps, values);
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 86'400);
+    state.counters["ratio"] = series.GetCompressionRatio();
+}
+BENCHMARK(BM_CompressedSeriesDecode)->Arg(256)->Arg(1024)->Arg(4096)->Unit(benchmark::kMillisecond);
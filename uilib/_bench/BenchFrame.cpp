@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+
+#include <queue>
+
+#include "bench_utils.h"
+#include "renderer.h"
+
+// Full frame without a window: traversal, tessellation of changed elements and drawable collection.
+// Second argument is how many elements change their properties every frame.
+static void BM_HeadlessFrame(benchmark::State& state)
+{
+    auto uiTree = MakeBenchTree(state.range(0), 10);
+    auto renderQue = std::queue<UiElement*>();
+    auto renderer = Renderer(renderQue);
+    const auto elements = uiTree->GetAllDescendantsBreathFirst();
+    const auto changedPerFrame = static_cast<size_t>(state.range(1));
+
+    // first frame creates every drawable
+    benchmark::DoNotOptimize(renderer.GetDrawables(uiTree.get()).data());
+
+    size_t next = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < changedPerFrame; i++) {
+            elements[next]->properties.border_radius_px += 1;
+            next = (next + 1) % elements.size();
+        }
+        benchmark::DoNotOptimize(renderer.GetDrawables(uiTree.get()).data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HeadlessFrame)->ArgsProduct({{100, 1000, 9000}, {0, 10, 100}});
+
+static void BM_HeadlessFrameProfiled(benchmark::State& state)
+{
+    auto uiTree = MakeBenchTree(state.range(0), 10);
+    auto renderQue = std::queue<UiElement*>();
+    auto renderer = Renderer(renderQue);
+    auto profiler = FrameProfiler();
+    renderer.SetProfiler(&profiler);
+
+    for (auto _ : state) {
+        profiler.BeginFrame();
+        benchmark::DoNotOptimize(renderer.GetDrawables(uiTree.get()).data());
+        profiler.EndFrame();
+    }
+    state.counters["p99_us"] = profiler.GetHistogram().GetPercentile(99);
+}
+BENCHMARK(BM_HeadlessFrameProfiled)->Arg(1000)->Arg(9000);
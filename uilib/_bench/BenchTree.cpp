@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <format>
+#include <memory>
+#include <memory_resource>
+
+#include "bench_utils.h"
+#include "uielement.h"
+#include "uitree.h"
+
+// Arguments are {element count, fanout}, element count stays under MAX_ALL_CHILDREN
+static void TreeShapes(benchmark::internal::Benchmark* benchmark)
+{
+    for (const int64_t count : {100, 1000, 9000}) {
+        for (const int64_t fanout : {4, 32, 100}) {
+            benchmark->Args({count, fanout});
+        }
+    }
+}
+
+static void BM_GetChild(benchmark::State& state)
+{
+    const auto uiTree = MakeBenchTree(state.range(0), state.range(1));
+    const auto name = std::format("e-{}", state.range(0) - 1);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(uiTree->GetChild(name));
+    }
+}
+BENCHMARK(BM_GetChild)->Apply(TreeShapes);
+
+static void BM_HasChildMissing(benchmark::State& state)
+{
+    const auto uiTree = MakeBenchTree(state.range(0), state.range(1));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(uiTree->HasChild("missing"));
+    }
+}
+BENCHMARK(BM_HasChildMissing)->Apply(TreeShapes);
+
+static void BM_TraversalDepthFirst(benchmark::State& state)
+{
+    const auto uiTree = MakeBenchTree(state.range(0), state.range(1));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(uiTree->GetAllDescendantsDepthFirst());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TraversalDepthFirst)->Apply(TreeShapes);
+
+static void BM_TraversalBreathFirst(benchmark::State& state)
+{
+    const auto uiTree = MakeBenchTree(state.range(0), state.range(1));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(uiTree->GetAllDescendantsBreathFirst());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TraversalBreathFirst)->Apply(TreeShapes);
+
+static void BM_TraversalBreathFirstArena(benchmark::State& state)
+{
+    const auto uiTree = MakeBenchTree(state.range(0), state.range(1));
+    auto buffer = std::pmr::monotonic_buffer_resource();
+
+    for (auto _ : state) {
+        auto elements = std::pmr::vector<UiElement*>(&buffer);
+        elements.reserve(state.range(0) + 1);
+        uiTree->GetAllDescendantsBreathFirst(elements);
+        benchmark::DoNotOptimize(elements.data());
+        buffer.release();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TraversalBreathFirstArena)->Apply(TreeShapes);
+
+// Adding children one by one relayouts the parent after every insert
+static void BM_AddChild(benchmark::State& state)
+{
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto parent = std::make_unique<UiElement>("parent", ElemType::Box);
+        parent->properties.width = 1000;
+        parent->properties.height = 1000;
+        state.ResumeTiming();
+
+        for (int64_t i = 0; i < state.range(0); i++) {
+            parent->AddChild(std::make_unique<UiElement>(std::format("c-{}", i), ElemType::Box));
+        }
+
+        state.PauseTiming();
+        parent.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddChild)->RangeMultiplier(4)->Range(4, MAX_CHILDREN);
+
+static void BM_RearrangeChildren(benchmark::State& state)
+{
+    auto parent = std::make_unique<UiElement>("parent", ElemType::Box);
+    parent->properties.width = 1000;
+    parent->properties.height = 1000;
+    auto children = std::vector<std::unique_ptr<UiElement>>();
+    for (int64_t i = 0; i < state.range(0); i++) {
+        children.push_back(std::make_unique<UiElement>(std::format("c-{}", i), ElemType::Box));
+    }
+    parent->AddChildren(std::move(children));
+
+    for (auto _ : state) {
+        parent->RearrangeChildren();
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RearrangeChildren)->RangeMultiplier(4)->Range(4, MAX_CHILDREN);
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <format>
+#include <memory>
+
+#include "uitree.h"
+
+// Builds a tree of given number of elements, every element has up to fanout children.
+// Names are "e-<index>" in breadth first order.
+inline auto MakeBenchTree(size_t elementCount, size_t fanout) -> std::unique_ptr<UiTree>
+{
+    auto uiTree = std::make_unique<UiTree>(Size{1920, 1080});
+
+    auto parents = std::vector<UiElement*>{uiTree->GetRoot()};
+    size_t created = 0;
+    for (size_t parent = 0; created < elementCount; parent++) {
+        auto children = std::vector<std::unique_ptr<UiElement>>();
+        for (size_t i = 0; i < fanout && created < elementCount; i++, created++) {
+            children.push_back(std::make_unique<UiElement>(std::format("e-{}", created), ElemType::Box));
+            parents.push_back(children.back().get());
+        }
+        parents[parent]->AddChildren(std::move(children));
+    }
+
+    return uiTree;
+}
@@ -0,0 +1,199 @@
+#include "plot_aggregation.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+auto MakeSamples(size_t count) -> std::vector<double>
+{
+    auto samples = std::vector<double>(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = static_cast<double>((i * 7919) % 1000) / 10.0;
+    }
+    return samples;
+}
+
+void ExpectSameAggregate(const SampleAggregate& a, const SampleAggregate& b)
+{
+    EXPECT_EQ(a.count, b.count);
+    EXPECT_EQ(a.min, b.min);
+    EXPECT_EQ(a.max, b.max);
+    // summation order differs between lanes and parts
+    EXPECT_NEAR(a.sum, b.sum, std::abs(a.sum) * 1e-12);
+}
+
+void ExpectSameAggregator(const SampleAggregator& a, const SampleAggregator& b)
+{
+    EXPECT_EQ(a.GetSampleCount(), b.GetSampleCount());
+    ExpectSameAggregate(a.GetHistogram().GetTotal(), b.GetHistogram().GetTotal());
+    EXPECT_EQ(a.GetHistogram().GetUnderflow(), b.GetHistogram().GetUnderflow());
+    EXPECT_EQ(a.GetHistogram().GetOverflow(), b.GetHistogram().GetOverflow());
+
+    const auto binsA = a.GetHistogram().GetBins();
+    const auto binsB = b.GetHistogram().GetBins();
+    EXPECT_TRUE(std::equal(binsA.begin(), binsA.end(), binsB.begin(), binsB.end()));
+
+    ASSERT_EQ(a.GetIntervals().size(), b.GetIntervals().size());
+    for (size_t i = 0; i < a.GetIntervals().size(); i++) {
+        ExpectSameAggregate(a.GetIntervals()[i], b.GetIntervals()[i]);
+    }
+}
+
+} // namespace
+
+TEST(TestAggregation, AggregatesSamples)
+{
+    const auto samples = std::vector<double>{3, -1, 4, 1, 5, 9, 2};
+    const auto aggregate = AggregateSamples(samples);
+    EXPECT_EQ(aggregate.count, 7);
+    EXPECT_EQ(aggregate.min, -1);
+    EXPECT_EQ(aggregate.max, 9);
+    EXPECT_EQ(aggregate.sum, 23);
+    EXPECT_DOUBLE_EQ(aggregate.GetMean(), 23.0 / 7);
+
+    const auto empty = AggregateSamples({});
+    EXPECT_EQ(empty.count, 0);
+    EXPECT_EQ(empty.GetMean(), 0);
+}
+
+TEST(TestAggregation, HistogramCountsBinsAndOutliers)
+{
+    auto histogram = SampleHistogram({0, 10}, 5);
+
+    const auto samples = std::vector<double>{-1, 0, 1.9, 2, 5, 9.99, 10, 20, NAN};
+    histogram.Add(samples);
+
+    const auto bins = histogram.GetBins();
+    ASSERT_EQ(bins.size(), size_t(5));
+    EXPECT_EQ(bins[0], 2);
+    EXPECT_EQ(bins[1], 1);
+    EXPECT_EQ(bins[2], 1);
+    EXPECT_EQ(bins[3], 0);
+    EXPECT_EQ(bins[4], 1);
+    EXPECT_EQ(histogram.GetUnderflow(), 2);
+    EXPECT_EQ(histogram.GetOverflow(), 2);
+
+    EXPECT_EQ(histogram.GetBinRange(1).start, 2);
+    EXPECT_EQ(histogram.GetBinRange(1).end, 4);
+
+    histogram.Clear();
+    EXPECT_EQ(histogram.GetTotal().count, 0);
+    EXPECT_EQ(histogram.GetUnderflow(), 0);
+
+    EXPECT_THROW(SampleHistogram({0, 10}, 0), std::runtime_error);
+    EXPECT_THROW(SampleHistogram({10, 10}, 4), std::runtime_error);
+}
+
+TEST(TestAggregation, HistogramPercentiles)
+{
+    auto histogram = SampleHistogram({0, 100}, 100);
+    EXPECT_EQ(histogram.GetPercentile(50), 0);
+
+    auto samples = std::vector<double>();
+    for (int i = 0; i < 1000; i++) {
+        samples.push_back(i / 10.0 + 0.05);
+    }
+    histogram.Add(samples);
+
+    // one bin is 1 wide, error is below a bin
+    EXPECT_NEAR(histogram.GetPercentile(50), 50, 1);
+    EXPECT_NEAR(histogram.GetPercentile(95), 95, 1);
+    EXPECT_NEAR(histogram.GetPercentile(99), 99, 1);
+    EXPECT_EQ(histogram.GetPercentile(100), histogram.GetTotal().max);
+
+    // outliers resolve to the observed extremes
+    histogram.Add(std::vector<double>(2000, 500));
+    EXPECT_EQ(histogram.GetPercentile(99), 500);
+}
+
+TEST(TestAggregation, SplitsIntervalsAcrossAppends)
+{
+    auto aggregator = SampleAggregator({0, 10}, 10, 4);
+
+    aggregator.Append(std::vector<double>{1, 2, 3});
+    ASSERT_EQ(aggregator.GetIntervals().size(), size_t(1));
+    EXPECT_EQ(aggregator.GetIntervals()[0].count, 3);
+
+    aggregator.Append(std::vector<double>{4, 5, 6, 7, 8, 9});
+    const auto intervals = aggregator.GetIntervals();
+    ASSERT_EQ(intervals.size(), size_t(3));
+    EXPECT_EQ(intervals[0].count, 4);
+    EXPECT_EQ(intervals[0].sum, 10);
+    EXPECT_EQ(intervals[1].min, 5);
+    EXPECT_EQ(intervals[1].max, 8);
+    EXPECT_EQ(intervals[2].count, 1);
+    EXPECT_EQ(aggregator.GetSampleCount(), 9);
+    EXPECT_EQ(aggregator.GetHistogram().GetTotal().count, 9);
+
+    EXPECT_THROW(SampleAggregator({0, 10}, 10, 0), std::runtime_error);
+}
+
+TEST(TestAggregation, ParallelMatchesSerial)
+{
+    auto pool = AggregationPool(3);
+    const auto samples = MakeSamples(AggregationPool::MIN_PART_SIZE * 4 + 123);
+    ASSERT_EQ(pool.GetPartCount(samples.size()), size_t(4));
+    EXPECT_EQ(pool.GetPartCount(100), size_t(1));
+
+    // interval size not dividing the part size, intervals are split between parts
+    auto serial = SampleAggregator({0, 100}, 64, 1000);
+    auto parallel = SampleAggregator({0, 100}, 64, 1000, &pool);
+    serial.Append(samples);
+    parallel.Append(samples);
+
+    ExpectSameAggregator(serial, parallel);
+}
+
+TEST(TestAggregation, IncrementalMatchesOneShot)
+{
+    auto pool = AggregationPool(2);
+    auto series = MakeSamples(AggregationPool::MIN_PART_SIZE * 3);
+
+    auto oneShot = SampleAggregator({0, 100}, 32, 777);
+    oneShot.Append(series);
+
+    auto incremental = SampleAggregator({0, 100}, 32, 777, &pool);
+    incremental.Update(std::span(series).first(100));
+    incremental.Update(std::span(series).first(AggregationPool::MIN_PART_SIZE * 2 + 5));
+    incremental.Update(series);
+    incremental.Update(series);
+    ExpectSameAggregator(oneShot, incremental);
+
+    // shorter series was replaced, aggregated again from the start
+    series.resize(1000);
+    auto replaced = SampleAggregator({0, 100}, 32, 777);
+    replaced.Append(series);
+    incremental.Update(series);
+    ExpectSameAggregator(replaced, incremental);
+}
+
+TEST(TestAggregation, PoolRunsPartsOnSeveralThreads)
+{
+    auto pool = AggregationPool(3);
+    const auto size = AggregationPool::MIN_PART_SIZE * 4;
+
+    for (int run = 0; run < 20; run++) {
+        auto mutex = std::mutex();
+        auto threads = std::set<std::thread::id>();
+        auto covered = std::atomic<size_t>(0);
+        auto parts = std::set<size_t>();
+
+        pool.Run(size, [&](size_t part, size_t begin, size_t end) {
+            covered += end - begin;
+            const auto lock = std::scoped_lock(mutex);
+            threads.insert(std::this_thread::get_id());
+            parts.insert(part);
+        });
+
+        EXPECT_EQ(covered, size);
+        EXPECT_EQ(parts.size(), size_t(4));
+        EXPECT_EQ(threads.size(), size_t(4));
+        EXPECT_TRUE(threads.contains(std::this_thread::get_id()));
+    }
+}
@@ -0,0 +1,159 @@
+#include "frame_arena.h"
+#include "renderer.h"
+#include "types.h"
+#include "uielement.h"
+#include "uitree.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstdlib>
+#include <format>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <queue>
+
+// Global heap allocations are counted while counting is enabled, the replacement
+// operators are used by the whole test binary but only count inside the tests below
+namespace {
+
+std::atomic<bool> g_countAllocations = false;
+std::atomic<size_t> g_allocations = 0;
+
+void StartCounting()
+{
+    g_allocations = 0;
+    g_countAllocations = true;
+}
+
+auto StopCounting() -> size_t
+{
+    g_countAllocations = false;
+    return g_allocations;
+}
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    if (g_countAllocations) {
+        g_allocations++;
+    }
+
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+class TestAllocations : public testing::Test {
+  protected:
+    TestAllocations()
+        : m_uiTree(std::make_unique<UiTree>(Size{1000, 500}))
+        , m_renderQue()
+        , m_renderer(std::make_unique<Renderer>(m_renderQue))
+    {
+        // names fit into the small string buffer, so copying them does not allocate
+        for (int panel = 0; panel < 10; panel++) {
+            auto panelElement = std::make_unique<UiElement>(std::format("p-{}", panel), ElemType::Box);
+            for (int cell = 0; cell < 8; cell++) {
+                panelElement->AddChild(std::make_unique<UiElement>(std::format("c-{}-{}", panel, cell), ElemType::Box));
+            }
+            m_uiTree->GetRoot()->AddChild(std::move(panelElement));
+        }
+    }
+
+    std::unique_ptr<UiTree> m_uiTree;
+    std::queue<UiElement*> m_renderQue;
+    std::unique_ptr<Renderer> m_renderer;
+};
+
+TEST_F(TestAllocations, NodePool_ElementsComeFromPool)
+{
+    auto& pool = UiElement::GetNodePool();
+    const auto usedBefore = pool.GetUsedBlocks();
+
+    {
+        auto element = std::make_unique<UiElement>("pooled", ElemType::Box);
+        EXPECT_EQ(pool.GetUsedBlocks(), usedBefore + 1);
+    }
+
+    EXPECT_EQ(pool.GetUsedBlocks(), usedBefore);
+    EXPECT_GE(pool.GetBlockSize(), sizeof(UiElement));
+}
+
+TEST_F(TestAllocations, FrameArena_GrowsToSteadyState)
+{
+    auto arena = FrameArena(256);
+
+    const auto fillFrame = [&arena]() {
+        arena.Reset();
+        auto scratch = std::pmr::vector<int>(arena.GetResource());
+        scratch.reserve(1000);
+        for (int i = 0; i < 1000; i++) {
+            scratch.push_back(i);
+        }
+    };
+
+    fillFrame();
+    EXPECT_GT(arena.GetOverflowAllocations(), size_t(0));
+
+    // overflowing frame makes the next reset grow the buffer
+    fillFrame();
+    EXPECT_EQ(arena.GetOverflowAllocations(), size_t(0));
+    EXPECT_GE(arena.GetCapacity(), 1000 * sizeof(int));
+
+    StartCounting();
+    fillFrame();
+    fillFrame();
+    EXPECT_EQ(StopCounting(), size_t(0));
+}
+
+TEST_F(TestAllocations, SteadyStateFrames_NoHeapAllocations)
+{
+    // first frames create drawables and size the frame arena
+    for (int i = 0; i < 3; i++) {
+        m_renderer->GetDrawables(m_uiTree.get());
+    }
+
+    StartCounting();
+    size_t drawables = 0;
+    for (int i = 0; i < 100; i++) {
+        const auto& frame = m_renderer->GetDrawables(m_uiTree.get());
+        drawables += frame.size();
+    }
+    const auto allocations = StopCounting();
+
+    EXPECT_EQ(drawables, size_t(100 * 91));
+    EXPECT_EQ(allocations, size_t(0));
+}
+
+TEST_F(TestAllocations, ChangedElement_OnlyChangedDrawableRecreated)
+{
+    const auto& first = m_renderer->GetDrawables(m_uiTree.get());
+    const auto before = std::vector(first.begin(), first.end());
+
+    m_uiTree->GetChild("c-3-3")->properties.color = {255, 0, 0};
+    const auto& second = m_renderer->GetDrawables(m_uiTree.get());
+
+    ASSERT_EQ(before.size(), second.size());
+    size_t recreated = 0;
+    for (size_t i = 0; i < before.size(); i++) {
+        if (before[i].second != second[i].second) {
+            recreated++;
+            EXPECT_EQ(GetElementName(second[i].first), "c-3-3");
+        }
+    }
+
+    EXPECT_LE(recreated, size_t(1));
+}
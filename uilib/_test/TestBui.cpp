@@ -0,0 +1,501 @@
+#include "bui_binary.h"
+#include "bui_diff.h"
+#include "bui_parser.h"
+#include "bui_watcher.h"
+#include "uitree.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+constexpr auto EXAMPLE_LAYOUT = R"(// root comment
+Element: main
+    width: max
+    height: max
+    layout: vertical // can be vertical / horizontal
+    border: 1px
+    visible: true
+    bg-color: #140a02
+
+   // comments can have any indentation
+    Element: left
+        width: 30
+        radius: 4px
+    Element:
+        width: 40
+        visible: false
+    Element: right
+        width: 30
+        clip: true
+
+        Element: nested
+            bg-color: #10203040
+)";
+
+class TestBui : public testing::Test {
+  protected:
+    TestBui()
+        : m_uiTree(std::make_unique<UiTree>(Size{200, 100}))
+    {
+    }
+
+    // Generates a layout with panelCount panels, each having childrenPerPanel children
+    static auto GenerateLayout(int panelCount, int childrenPerPanel) -> std::string
+    {
+        auto source = std::string("Element: screen\n    width: max\n    height: max\n");
+        for (int panel = 0; panel < panelCount; panel++) {
+            source += std::format("    Element: panel-{}\n        height: 500\n        bg-color: #202020\n", panel);
+            for (int child = 0; child < childrenPerPanel; child++) {
+                source += std::format("        Element: panel-{}-{}\n            height: 20\n            radius: 3px\n",
+                                      panel, child);
+            }
+        }
+
+        return source;
+    }
+
+    std::unique_ptr<UiTree> m_uiTree;
+};
+
+TEST_F(TestBui, ParseStructure)
+{
+    const auto document = ParseBui(EXAMPLE_LAYOUT);
+    ASSERT_EQ(document.elements.size(), size_t(5));
+
+    EXPECT_EQ(document.elements[0].name, "main");
+    EXPECT_EQ(document.elements[0].parent, BUI_NO_PARENT);
+    EXPECT_EQ(document.elements[1].name, "left");
+    EXPECT_EQ(document.elements[1].parent, 0);
+    EXPECT_TRUE(document.elements[2].name.empty());
+    auto nameBuffer = std::string();
+    EXPECT_EQ(GetBuiElementName(document, 1, nameBuffer), "left");
+    EXPECT_EQ(GetBuiElementName(document, 1, nameBuffer).data(), document.elements[1].name.data());
+    EXPECT_EQ(GetBuiElementName(document, 2, nameBuffer), "element-2");
+    EXPECT_EQ(document.elements[2].parent, 0);
+    EXPECT_EQ(document.elements[3].parent, 0);
+    EXPECT_EQ(document.elements[4].name, "nested");
+    EXPECT_EQ(document.elements[4].parent, 3);
+}
+
+TEST_F(TestBui, ParseProperties)
+{
+    const auto document = ParseBui(EXAMPLE_LAYOUT);
+
+    const auto& main = document.elements[0];
+    EXPECT_EQ(main.sizeFlags, BUI_WIDTH_MAX | BUI_HEIGHT_MAX);
+    EXPECT_EQ(main.properties.layout_children, LayoutDirection::Vertical);
+    EXPECT_TRUE(main.properties.border);
+    EXPECT_EQ(main.properties.border_width, 1);
+    EXPECT_FALSE(main.properties.hidden);
+    EXPECT_EQ(main.properties.color.red, 0x14);
+    EXPECT_EQ(main.properties.color.green, 0x0a);
+    EXPECT_EQ(main.properties.color.blue, 0x02);
+    EXPECT_EQ(main.properties.color.alpha, 255);
+
+    EXPECT_EQ(document.elements[1].properties.width, 30);
+    EXPECT_EQ(document.elements[1].properties.border_radius_px, 4);
+    EXPECT_TRUE(document.elements[2].properties.hidden);
+    EXPECT_FALSE(main.properties.clip_children);
+    EXPECT_TRUE(document.elements[3].properties.clip_children);
+    EXPECT_EQ(document.elements[4].properties.color.alpha, 0x40);
+}
+
+TEST_F(TestBui, ParseErrors)
+{
+    EXPECT_THROW(ParseBui("width: 10\n"), std::runtime_error);
+    EXPECT_THROW(ParseBui("Element:\n    width: ten\n"), std::runtime_error);
+    EXPECT_THROW(ParseBui("Element:\n    unknown: 1\n"), std::runtime_error);
+    EXPECT_THROW(ParseBui("Element:\n    bg-color: red\n"), std::runtime_error);
+    EXPECT_THROW(ParseBui("Element:\nElement:\n"), std::runtime_error);
+    EXPECT_THROW(ParseBui("Element:\n    width 10\n"), std::runtime_error);
+    EXPECT_THROW(ParseBui("Element:\n    width: 10 20\n"), std::runtime_error);
+}
+
+TEST_F(TestBui, TooManyChildrenAreRejected)
+{
+    auto source = std::string("Element: list\n");
+    for (size_t i = 0; i <= MAX_CHILDREN; i++) {
+        source += std::format("    Element: row-{}\n", i);
+    }
+
+    try {
+        ParseBui(source);
+        FAIL() << "too many children should throw";
+    }
+    catch (const BuiParseError& error) {
+        EXPECT_EQ(error.GetLine(), MAX_CHILDREN + 2);
+        EXPECT_NE(std::string(error.what()).find("list"), std::string::npos);
+    }
+
+    // compiled layouts do not go through the parser
+    auto document = BuiDocument();
+    document.elements.push_back({.name = "list"});
+    for (size_t i = 0; i <= MAX_CHILDREN; i++) {
+        document.elements.push_back({.parent = 0});
+    }
+
+    try {
+        LoadCompiledBui(CompileBui(document), *m_uiTree);
+        FAIL() << "too many children should throw";
+    }
+    catch (const std::runtime_error& error) {
+        EXPECT_NE(std::string(error.what()).find("list"), std::string::npos);
+    }
+    EXPECT_TRUE(m_uiTree->GetRoot()->GetAllChildren().empty());
+}
+
+TEST_F(TestBui, ParseErrorPosition)
+{
+    try {
+        ParseBui("Element:\n    width: 10\n\n    height: tall // comment\n");
+        FAIL() << "invalid height should throw";
+    }
+    catch (const BuiParseError& error) {
+        EXPECT_EQ(error.GetLine(), size_t(4));
+        EXPECT_EQ(error.GetColumn(), size_t(13));
+    }
+}
+
+TEST_F(TestBui, ParseNamesAreViewsIntoSource)
+{
+    const auto source = std::string(EXAMPLE_LAYOUT);
+    const auto document = ParseBui(source);
+
+    const auto* begin = source.data();
+    const auto* end = source.data() + source.size();
+    EXPECT_GE(document.elements[0].name.data(), begin);
+    EXPECT_LT(document.elements[0].name.data(), end);
+}
+
+TEST_F(TestBui, ParseLargeFile)
+{
+    // ~7 MB of layout nested so that no element has more than MAX_CHILDREN children
+    constexpr int GROUPS = 50;
+    constexpr int PANELS = 100;
+    constexpr int CELLS = 20;
+    static_assert(GROUPS <= MAX_CHILDREN && PANELS <= MAX_CHILDREN && CELLS <= MAX_CHILDREN);
+
+    auto source = std::string("Element: screen\n    width: max\n    height: max\n");
+    for (int group = 0; group < GROUPS; group++) {
+        source += std::format("    Element: group-{}\n        layout: vertical\n", group);
+        for (int panel = 0; panel < PANELS; panel++) {
+            source += std::format("        Element: panel-{}-{}\n            height: 500\n"
+                                  "            bg-color: #202020\n",
+                                  group, panel);
+            for (int cell = 0; cell < CELLS; cell++) {
+                source += std::format("            Element: cell-{}-{}-{}\n                width: 12px // cell\n",
+                                      group, panel, cell);
+            }
+        }
+    }
+
+    auto uiTree = std::make_unique<UiTree>(Size{1920, 1080});
+    auto t1 = std::chrono::high_resolution_clock::now();
+    const auto document = ParseBui(source);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    BuildUiTree(document, *uiTree);
+    auto t3 = std::chrono::high_resolution_clock::now();
+
+    std::cout << std::format("Parsed {} bytes, {} elements in {}, built the tree in {}", source.size(),
+                             document.elements.size(),
+                             std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1),
+                             std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2))
+              << std::endl;
+
+    EXPECT_EQ(document.elements.size(), size_t(1 + GROUPS * (1 + PANELS * (1 + CELLS))));
+
+    // tree root on top of the layout
+    EXPECT_EQ(uiTree->GetAllDescendantsDepthFirst().size(), document.elements.size() + 1);
+}
+
+TEST_F(TestBui, BuildUiTree)
+{
+    BuildUiTree(ParseBui(EXAMPLE_LAYOUT), *m_uiTree);
+
+    auto main = m_uiTree->GetChild("main");
+    ASSERT_NE(main, nullptr);
+    EXPECT_EQ(main->GetParent(), m_uiTree->GetRoot());
+    EXPECT_EQ(main->properties.height, 100);
+    EXPECT_EQ(main->GetAllChildren().size(), size_t(3));
+
+    auto nested = m_uiTree->GetChild("nested");
+    ASSERT_NE(nested, nullptr);
+    EXPECT_EQ(nested->GetParent(), m_uiTree->GetChild("right"));
+}
+
+TEST_F(TestBui, CompiledRoundTrip)
+{
+    const auto document = ParseBui(EXAMPLE_LAYOUT);
+    BuildUiTree(document, *m_uiTree);
+
+    auto compiledTree = std::make_unique<UiTree>(Size{200, 100});
+    LoadCompiledBui(CompileBui(document), *compiledTree);
+
+    const auto expected = m_uiTree->GetAllDescendantsDepthFirst();
+    const auto loaded = compiledTree->GetAllDescendantsDepthFirst();
+    ASSERT_EQ(expected.size(), loaded.size());
+
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i]->GetName(), loaded[i]->GetName());
+        EXPECT_EQ(expected[i]->GetElementType(), loaded[i]->GetElementType());
+        EXPECT_EQ(expected[i]->properties.width, loaded[i]->properties.width);
+        EXPECT_EQ(expected[i]->properties.height, loaded[i]->properties.height);
+        EXPECT_EQ(expected[i]->properties.position.x, loaded[i]->properties.position.x);
+        EXPECT_EQ(expected[i]->properties.hidden, loaded[i]->properties.hidden);
+        EXPECT_EQ(expected[i]->properties.clip_children, loaded[i]->properties.clip_children);
+        EXPECT_EQ(expected[i]->properties.color.alpha, loaded[i]->properties.color.alpha);
+    }
+}
+
+TEST_F(TestBui, CompiledRejectsMalformedData)
+{
+    auto compiled = CompileBui(ParseBui(EXAMPLE_LAYOUT));
+
+    auto truncated = compiled;
+    truncated.resize(truncated.size() / 2);
+    EXPECT_THROW(LoadCompiledBui(truncated, *m_uiTree), std::runtime_error);
+
+    compiled[0] = std::byte{0};
+    EXPECT_THROW(LoadCompiledBui(compiled, *m_uiTree), std::runtime_error);
+}
+
+TEST_F(TestBui, CompiledStartupTime)
+{
+    const auto source = GenerateLayout(80, 60);
+    const auto textPath = std::filesystem::temp_directory_path() / "boleui-startup.bui";
+    const auto binaryPath = std::filesystem::temp_directory_path() / "boleui-startup.buic";
+
+    std::ofstream(textPath) << source;
+    WriteCompiledBui(ParseBui(source), binaryPath);
+
+    auto textTree = std::make_unique<UiTree>(Size{1920, 1080});
+    auto t1 = std::chrono::high_resolution_clock::now();
+    BuildUiTree(LoadBuiFile(textPath), *textTree);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    auto binaryTree = std::make_unique<UiTree>(Size{1920, 1080});
+    auto t3 = std::chrono::high_resolution_clock::now();
+    LoadCompiledBuiFile(binaryPath, *binaryTree);
+    auto t4 = std::chrono::high_resolution_clock::now();
+
+    std::cout << std::format("Layout startup text: {}, compiled: {}",
+                             std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1),
+                             std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3))
+              << std::endl;
+
+    EXPECT_EQ(textTree->GetAllDescendantsDepthFirst().size(), binaryTree->GetAllDescendantsDepthFirst().size());
+
+    std::filesystem::remove(textPath);
+    std::filesystem::remove(binaryPath);
+}
+
+TEST_F(TestBui, LayoutDiff_UnchangedLayoutKeepsElements)
+{
+    const auto document = ParseBui(EXAMPLE_LAYOUT);
+    BuildUiTree(document, *m_uiTree);
+    const auto before = m_uiTree->GetAllDescendantsDepthFirst();
+
+    const auto stats = ApplyLayoutDiff(document, document, *m_uiTree);
+
+    EXPECT_EQ(stats.inserted, size_t(0));
+    EXPECT_EQ(stats.removed, size_t(0));
+    EXPECT_EQ(stats.moved, size_t(0));
+    EXPECT_EQ(stats.updated, size_t(0));
+    EXPECT_EQ(stats.reordered, size_t(0));
+    EXPECT_EQ(stats.unchanged, document.elements.size());
+    EXPECT_EQ(m_uiTree->GetAllDescendantsDepthFirst(), before);
+}
+
+TEST_F(TestBui, LayoutDiff_InsertRemoveUpdate)
+{
+    const auto previous = ParseBui(EXAMPLE_LAYOUT);
+    BuildUiTree(previous, *m_uiTree);
+
+    auto* main = m_uiTree->GetChild("main");
+    auto* left = m_uiTree->GetChild("left");
+    auto* right = m_uiTree->GetChild("right");
+
+    const auto next = ParseBui(R"(Element: main
+    width: max
+    height: max
+    layout: vertical
+    border: 1px
+    visible: true
+    bg-color: #140a02
+    Element: left
+        width: 30
+        radius: 8px
+    Element:
+        width: 40
+        visible: false
+    Element: right
+        width: 30
+        clip: true
+    Element: added
+)");
+    const auto stats = ApplyLayoutDiff(previous, next, *m_uiTree);
+
+    EXPECT_EQ(stats.inserted, size_t(1));
+    EXPECT_EQ(stats.removed, size_t(1));
+    EXPECT_EQ(stats.updated, size_t(1));
+    EXPECT_EQ(stats.moved, size_t(0));
+
+    EXPECT_EQ(m_uiTree->GetChild("main"), main);
+    EXPECT_EQ(m_uiTree->GetChild("left"), left);
+    EXPECT_EQ(m_uiTree->GetChild("right"), right);
+    EXPECT_EQ(left->properties.border_radius_px, 8);
+    EXPECT_FALSE(m_uiTree->HasChild("nested"));
+
+    const auto children = main->GetAllChildren();
+    ASSERT_EQ(children.size(), size_t(4));
+    EXPECT_EQ(children[3]->GetName(), "added");
+}
+
+TEST_F(TestBui, LayoutDiff_MoveAndReorder)
+{
+    const auto previous = ParseBui(EXAMPLE_LAYOUT);
+    BuildUiTree(previous, *m_uiTree);
+
+    auto* nested = m_uiTree->GetChild("nested");
+    auto* left = m_uiTree->GetChild("left");
+
+    const auto next = ParseBui(R"(Element: main
+    width: max
+    height: max
+    layout: vertical
+    border: 1px
+    visible: true
+    bg-color: #140a02
+    Element: right
+        width: 30
+    Element:
+        width: 40
+        visible: false
+    Element: left
+        width: 30
+        radius: 4px
+        Element: nested
+            bg-color: #10203040
+)");
+    const auto stats = ApplyLayoutDiff(previous, next, *m_uiTree);
+
+    EXPECT_EQ(stats.inserted, size_t(0));
+    EXPECT_EQ(stats.removed, size_t(0));
+    EXPECT_EQ(stats.moved, size_t(1));
+    EXPECT_EQ(m_uiTree->GetChild("nested"), nested);
+    EXPECT_EQ(nested->GetParent(), left);
+
+    const auto children = m_uiTree->GetChild("main")->GetAllChildren();
+    ASSERT_EQ(children.size(), size_t(3));
+    EXPECT_EQ(children[0]->GetName(), "right");
+    EXPECT_EQ(children[1]->GetName(), "element-2");
+    EXPECT_EQ(children[2]->GetName(), "left");
+}
+
+TEST_F(TestBui, LayoutDiff_KeepsElementsCreatedFromCode)
+{
+    const auto previous = ParseBui(EXAMPLE_LAYOUT);
+    BuildUiTree(previous, *m_uiTree);
+    m_uiTree->GetChild("right")->AddChild(std::make_unique<UiElement>("plot", ElemType::Box));
+
+    const auto next = ParseBui("Element: main\n    Element: right\n");
+    const auto stats = ApplyLayoutDiff(previous, next, *m_uiTree);
+
+    EXPECT_EQ(stats.removed, size_t(3));
+    EXPECT_TRUE(m_uiTree->HasChild("plot"));
+    EXPECT_FALSE(m_uiTree->HasChild("element-2"));
+    EXPECT_FALSE(m_uiTree->HasChild("left"));
+    EXPECT_FALSE(m_uiTree->HasChild("nested"));
+}
+
+TEST_F(TestBui, LayoutDiff_DoesNotMatchCodeElementsSharingName)
+{
+    const auto previous = ParseBui(EXAMPLE_LAYOUT);
+    BuildUiTree(previous, *m_uiTree);
+
+    // code elements named like an element the next layout adds and like one it removes
+    auto* left = m_uiTree->GetChild("left");
+    auto codeElements = std::vector<std::unique_ptr<UiElement>>();
+    codeElements.push_back(std::make_unique<UiElement>("status", ElemType::Box));
+    codeElements.push_back(std::make_unique<UiElement>("nested", ElemType::Box));
+    auto* codeStatus = codeElements[0].get();
+    auto* codeNested = codeElements[1].get();
+    left->AddChildren(std::move(codeElements));
+
+    auto next = std::string(EXAMPLE_LAYOUT);
+    next.erase(next.find("        Element: nested"));
+    next += "    Element: status\n";
+    const auto stats = ApplyLayoutDiff(previous, ParseBui(next), *m_uiTree);
+
+    EXPECT_EQ(stats.inserted, size_t(1));
+    EXPECT_EQ(stats.moved, size_t(0));
+    EXPECT_EQ(stats.removed, size_t(1));
+    EXPECT_EQ(codeStatus->GetParent(), left);
+    EXPECT_EQ(codeNested->GetParent(), left);
+    EXPECT_EQ(m_uiTree->GetChild("main")->GetAllChildren().size(), size_t(4));
+    EXPECT_TRUE(m_uiTree->GetChild("right")->GetAllChildren().empty());
+}
+
+TEST_F(TestBui, LayoutDiff_MaxSizedChildFollowsParent)
+{
+    // vertical layouts keep declared widths, so only resolving max decides the width of the child
+    constexpr auto PANEL = "Element: panel\n    width: {}\n    layout: vertical\n"
+                           "    Element: fill\n        width: max\n";
+    m_uiTree->GetRoot()->properties.layout_children = LayoutDirection::Vertical;
+    const auto previousSource = std::format(PANEL, 100);
+    const auto previous = ParseBui(previousSource);
+    BuildUiTree(previous, *m_uiTree);
+    auto* fill = m_uiTree->GetChild("fill");
+    EXPECT_EQ(fill->properties.width, 100);
+
+    // only the parent declaration changed, the child has to end up as in a freshly built tree
+    const auto source = std::format(PANEL, 150);
+    const auto next = ParseBui(source);
+    const auto stats = ApplyLayoutDiff(previous, next, *m_uiTree);
+
+    EXPECT_EQ(stats.updated, size_t(2));
+    EXPECT_EQ(m_uiTree->GetChild("fill"), fill);
+
+    auto freshTree = UiTree(Size{200, 100});
+    freshTree.GetRoot()->properties.layout_children = LayoutDirection::Vertical;
+    BuildUiTree(next, freshTree);
+    EXPECT_EQ(fill->properties, freshTree.GetChild("fill")->properties);
+    EXPECT_EQ(fill->properties.width, 150);
+}
+
+TEST_F(TestBui, HotReload_AppliesFileChanges)
+{
+    const auto path = std::filesystem::temp_directory_path() / "boleui-hot-reload.bui";
+    std::ofstream(path) << EXAMPLE_LAYOUT;
+
+    auto hotReload = BuiHotReload(path, *m_uiTree);
+    auto* main = m_uiTree->GetChild("main");
+    ASSERT_NE(main, nullptr);
+    EXPECT_FALSE(hotReload.Poll().has_value());
+
+    std::ofstream(path) << "Element: main\n    Element: left\n    Element: fresh\n";
+    const auto stats = hotReload.Poll();
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->inserted, size_t(1));
+    EXPECT_EQ(m_uiTree->GetChild("main"), main);
+    EXPECT_TRUE(m_uiTree->HasChild("fresh"));
+
+    std::ofstream(path) << "Element: main\n    width: wide\n";
+    EXPECT_FALSE(hotReload.Poll().has_value());
+    EXPECT_FALSE(hotReload.GetLastError().empty());
+    EXPECT_TRUE(m_uiTree->HasChild("fresh"));
+
+    std::ofstream(path, std::ios::trunc).flush();
+    EXPECT_FALSE(hotReload.Poll().has_value());
+    EXPECT_FALSE(hotReload.GetLastError().empty());
+    EXPECT_EQ(m_uiTree->GetChild("main"), main);
+    EXPECT_TRUE(m_uiTree->HasChild("fresh"));
+
+    std::filesystem::remove(path);
+}
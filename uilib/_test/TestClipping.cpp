@@ -0,0 +1,215 @@
+#include "display_list.h"
+#include "frame_profiler.h"
+#include "renderer.h"
+#include "uielement.h"
+#include "uitree.h"
+#include "gtest/gtest.h"
+#include <SFML/Graphics/Vertex.hpp>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <queue>
+
+class TestClipping : public testing::Test {
+  protected:
+    // Adds a box at an absolute position, layout of the parent is vertical so it is kept
+    static auto AddBox(UiElement* parent, std::string_view name, BoundingBox bounds) -> UiElement*
+    {
+        auto element = std::make_unique<UiElement>(name, ElemType::Box);
+        element->properties.position = {bounds.left, bounds.top};
+        element->properties.width = bounds.right - bounds.left;
+        element->properties.height = bounds.bottom - bounds.top;
+        element->properties.layout_children = LayoutDirection::Vertical;
+
+        auto* added = element.get();
+        parent->AddChild(std::move(element));
+        return added;
+    }
+
+    TestClipping()
+    {
+        m_tree = std::make_unique<UiTree>(Size{1000, 1000});
+        auto* root = m_tree->GetRoot();
+        root->properties.layout_children = LayoutDirection::Vertical;
+
+        m_panel = AddBox(root, "panel", {100, 100, 300, 300});
+        m_panel->properties.clip_children = true;
+        m_inside = AddBox(m_panel, "inside", {120, 120, 200, 200});
+        m_partial = AddBox(m_panel, "partial", {250, 250, 400, 400});
+        m_outside = AddBox(m_panel, "outside", {500, 500, 600, 600});
+
+        m_sibling = AddBox(root, "sibling", {600, 100, 700, 200});
+    }
+
+    std::unique_ptr<UiTree> m_tree;
+    UiElement* m_panel;
+    UiElement* m_inside;
+    UiElement* m_partial;
+    UiElement* m_outside;
+    UiElement* m_sibling;
+    std::queue<UiElement*> m_renderQue;
+};
+
+TEST_F(TestClipping, BoundingBoxIntersection)
+{
+    const auto box = BoundingBox{0, 0, 10, 10};
+
+    EXPECT_EQ(box.Intersect({5, 5, 20, 20}), (BoundingBox{5, 5, 10, 10}));
+    EXPECT_TRUE(box.Intersect({20, 20, 30, 30}).IsEmpty());
+    EXPECT_TRUE(box.Overlaps({10, 10, 20, 20}));
+    EXPECT_TRUE(box.Overlaps({5, 5, 5, 5}));
+    EXPECT_FALSE(box.Overlaps({11, 0, 20, 10}));
+}
+
+TEST_F(TestClipping, TraversalKeepsClipStack)
+{
+    auto* nested = AddBox(m_partial, "nested", {260, 260, 280, 280});
+    m_partial->properties.clip_children = true;
+
+    auto elements = std::pmr::vector<UiElement*>();
+    auto elementClips = std::pmr::vector<uint32_t>();
+    auto clipRects = std::pmr::vector<BoundingBox>{{0, 0, 1000, 1000}};
+    m_tree->GetAllDescendantsBreathFirst(elements, elementClips, clipRects);
+
+    ASSERT_EQ(elements.size(), size_t(7));
+    ASSERT_EQ(elementClips.size(), elements.size());
+    ASSERT_EQ(clipRects.size(), size_t(3));
+    EXPECT_EQ(clipRects[1], (BoundingBox{100, 100, 300, 300}));
+    EXPECT_EQ(clipRects[2], (BoundingBox{250, 250, 300, 300}));
+
+    for (size_t i = 0; i < elements.size(); i++) {
+        if (elements[i] == m_panel || elements[i] == m_sibling) {
+            EXPECT_EQ(elementClips[i], 0);
+        }
+        else if (elements[i] == nested) {
+            EXPECT_EQ(elementClips[i], 2);
+        }
+        else if (elements[i] != m_tree->GetRoot()) {
+            EXPECT_EQ(elementClips[i], 1);
+        }
+    }
+}
+
+TEST_F(TestClipping, EmptyClipSkipsSubtree)
+{
+    AddBox(m_outside, "under-outside", {510, 510, 520, 520});
+    m_outside->properties.clip_children = true;
+
+    auto elements = std::pmr::vector<UiElement*>();
+    auto elementClips = std::pmr::vector<uint32_t>();
+    auto clipRects = std::pmr::vector<BoundingBox>{{0, 0, 1000, 1000}};
+    m_tree->GetAllDescendantsBreathFirst(elements, elementClips, clipRects);
+
+    // outside itself is visited, its child can not be visible and is not
+    EXPECT_EQ(elements.size(), size_t(6));
+    EXPECT_TRUE(clipRects.back().IsEmpty());
+}
+
+TEST_F(TestClipping, RendererCullsAndGroupsClippedElements)
+{
+    auto renderer = Renderer(m_renderQue);
+    auto displayList = DisplayList();
+    renderer.BuildDisplayList(m_tree.get(), displayList);
+
+    EXPECT_EQ(renderer.GetCulledElementCount(), size_t(1));
+
+    // root, panel and sibling unclipped in one batch, inside and partial scissored in another,
+    // breadth first traversal reaches the sibling before the clipped children
+    EXPECT_EQ(displayList.GetBatchCount(), size_t(2));
+    EXPECT_EQ(displayList.GetClipRectCount(), size_t(1));
+
+    // drawables are culled the same way
+    EXPECT_EQ(renderer.GetDrawables(m_tree.get()).size(), size_t(5));
+    EXPECT_EQ(renderer.GetCulledElementCount(), size_t(1));
+
+    m_panel->properties.clip_children = false;
+    renderer.BuildDisplayList(m_tree.get(), displayList);
+    EXPECT_EQ(renderer.GetCulledElementCount(), size_t(0));
+    EXPECT_EQ(displayList.GetBatchCount(), size_t(1));
+}
+
+TEST_F(TestClipping, ClippedElementsKeepPaintOrder)
+{
+    // one level below the clipped children, so it is traversed after inside and drawn on top of it
+    auto* holder = AddBox(m_sibling, "holder", {600, 150, 700, 200});
+    auto* over = AddBox(holder, "over", {130, 130, 190, 190});
+    m_inside->properties.color = {255, 0, 0};
+    over->properties.color = {0, 0, 255};
+
+    auto renderer = Renderer(m_renderQue);
+    auto displayList = DisplayList();
+    renderer.BuildDisplayList(m_tree.get(), displayList);
+
+    const auto vertices = displayList.GetVertices();
+    const auto firstWithColor = [&vertices](sf::Color color) {
+        return std::ranges::find(vertices, color, &sf::Vertex::color) - vertices.begin();
+    };
+    const auto inside = firstWithColor(sf::Color::Red);
+    const auto overInside = firstWithColor(sf::Color::Blue);
+    ASSERT_LT(inside, std::ssize(vertices));
+    ASSERT_LT(overInside, std::ssize(vertices));
+    EXPECT_LT(inside, overInside);
+
+    // unclipped, clipped, unclipped again instead of moving over below the clipped group
+    EXPECT_EQ(displayList.GetBatchCount(), size_t(3));
+}
+
+TEST_F(TestClipping, CulledElementsKeepCachedDrawables)
+{
+    auto profiler = FrameProfiler();
+    auto renderer = Renderer(m_renderQue);
+    renderer.SetProfiler(&profiler);
+    auto displayList = DisplayList();
+    const auto build = [&] {
+        profiler.BeginFrame();
+        renderer.BuildDisplayList(m_tree.get(), displayList);
+        profiler.EndFrame();
+        return profiler.GetFrame(0).verticesGenerated;
+    };
+
+    m_panel->properties.clip_children = false;
+    EXPECT_GT(build(), 0);
+    EXPECT_EQ(renderer.GetCachedElementCount(), size_t(6));
+
+    // outside is culled while the removed sibling leaves a stale entry behind,
+    // only the panel is tessellated again since its clip flag changed
+    m_panel->properties.clip_children = true;
+    m_tree->RemoveChild("sibling");
+    const auto panelVertices = build();
+    for (uint64_t frame = 2; frame < Renderer::CACHE_RETAIN_FRAMES; frame++) {
+        build();
+    }
+    EXPECT_EQ(renderer.GetCulledElementCount(), size_t(1));
+    EXPECT_EQ(renderer.GetCachedElementCount(), size_t(6));
+
+    // outside comes back into view without being tessellated again
+    m_panel->properties.clip_children = false;
+    EXPECT_EQ(build(), panelVertices);
+
+    for (uint64_t frame = 0; frame < Renderer::CACHE_RETAIN_FRAMES; frame++) {
+        build();
+    }
+    EXPECT_EQ(renderer.GetCachedElementCount(), size_t(5));
+}
+
+TEST(DisplayList, ClipRectSplitsBatches)
+{
+    const auto triangle = std::array<sf::Vertex, 3>{};
+    auto displayList = DisplayList();
+
+    displayList.AddVertices(sf::PrimitiveType::Triangles, triangle);
+    displayList.SetClipRect(sf::FloatRect{{0, 0}, {10, 10}});
+    displayList.AddVertices(sf::PrimitiveType::Triangles, triangle);
+    displayList.SetClipRect(sf::FloatRect{{0, 0}, {10, 10}});
+    displayList.AddVertices(sf::PrimitiveType::Triangles, triangle);
+    displayList.SetClipRect(std::nullopt);
+    displayList.AddVertices(sf::PrimitiveType::Triangles, triangle);
+
+    EXPECT_EQ(displayList.GetBatchCount(), size_t(3));
+    EXPECT_EQ(displayList.GetClipRectCount(), size_t(1));
+
+    displayList.Clear();
+    EXPECT_EQ(displayList.GetClipRectCount(), size_t(0));
+}
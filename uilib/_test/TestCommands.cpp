@@ -0,0 +1,160 @@
+#include "uielement.h"
+#include "uitree.h"
+#include "uitree_commands.h"
+#include "gtest/gtest.h"
+#include <format>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class TestCommands : public testing::Test {
+  protected:
+    TestCommands()
+        : m_uiTree(std::make_unique<UiTree>(Size{1000, 500}))
+    {
+        auto panel = std::make_unique<UiElement>("panel", ElemType::Box);
+        panel->AddChild(std::make_unique<UiElement>("alarm", ElemType::Box));
+        m_uiTree->GetRoot()->AddChild(std::move(panel));
+    }
+
+    std::unique_ptr<UiTree> m_uiTree;
+    UiTreeCommandQueue m_commands;
+};
+
+TEST_F(TestCommands, PropertyWritesAreCoalesced)
+{
+    m_commands.SetProperty(InternElementId("alarm"), PropertyField::Color, Color{255, 0, 0});
+    m_commands.SetProperty(InternElementId("alarm"), PropertyField::Color, Color{0, 255, 0});
+    m_commands.SetProperty(InternElementId("alarm"), PropertyField::Hidden, true);
+    EXPECT_EQ(m_commands.GetPendingCount(), 3);
+
+    const auto stats = m_commands.Apply(*m_uiTree);
+    EXPECT_EQ(stats.applied, 3);
+    EXPECT_EQ(stats.coalesced, 1);
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_EQ(m_commands.GetPendingCount(), 0);
+
+    const auto* alarm = m_uiTree->GetChild("alarm");
+    EXPECT_EQ(alarm->properties.color, (Color{0, 255, 0}));
+    EXPECT_TRUE(alarm->properties.hidden);
+}
+
+TEST_F(TestCommands, AddedElementCanBeAddressedInSameBatch)
+{
+    m_commands.AddChild(InternElementId("panel"), InternElementId("status"), ElemType::Box);
+    m_commands.AddChild(InternElementId("status"), InternElementId("status-icon"), ElemType::Box);
+    m_commands.SetProperty(InternElementId("status-icon"), PropertyField::Width, 12.0f);
+
+    const auto stats = m_commands.Apply(*m_uiTree);
+    EXPECT_EQ(stats.applied, 3);
+
+    auto* icon = m_uiTree->GetChild("status-icon");
+    ASSERT_NE(icon, nullptr);
+    EXPECT_EQ(icon->GetParent(), m_uiTree->GetChild("status"));
+    EXPECT_EQ(icon->GetParent()->GetParent(), m_uiTree->GetChild("panel"));
+}
+
+TEST_F(TestCommands, CommandsForRemovedElementsAreDropped)
+{
+    m_commands.AddChild(InternElementId("alarm"), InternElementId("alarm-label"), ElemType::Box);
+    m_commands.RemoveSubtree(InternElementId("panel"));
+    m_commands.SetProperty(InternElementId("alarm"), PropertyField::Hidden, true);
+    m_commands.AddChild(InternElementId("alarm-label"), InternElementId("late"), ElemType::Box);
+    m_commands.RemoveSubtree(InternElementId("missing"));
+    m_commands.RemoveSubtree(m_uiTree->GetRoot()->GetId());
+    m_commands.SetProperty(InternElementId("panel"), PropertyField::Width, true);
+
+    const auto stats = m_commands.Apply(*m_uiTree);
+    EXPECT_EQ(stats.applied, 2);
+    EXPECT_EQ(stats.dropped, 5);
+
+    EXPECT_FALSE(m_uiTree->HasChild("panel"));
+    EXPECT_FALSE(m_uiTree->HasChild("alarm"));
+    EXPECT_FALSE(m_uiTree->HasChild("alarm-label"));
+    EXPECT_TRUE(m_uiTree->GetRoot()->GetAllChildren().empty());
+}
+
+TEST_F(TestCommands, ChildRemovedBeforeParent)
+{
+    m_commands.RemoveSubtree(InternElementId("alarm"));
+    m_commands.RemoveSubtree(InternElementId("panel"));
+
+    const auto stats = m_commands.Apply(*m_uiTree);
+    EXPECT_EQ(stats.applied, 2);
+    EXPECT_EQ(stats.dropped, 0);
+
+    EXPECT_FALSE(m_uiTree->HasChild("panel"));
+    EXPECT_FALSE(m_uiTree->HasChild("alarm"));
+    EXPECT_TRUE(m_uiTree->GetRoot()->GetAllChildren().empty());
+}
+
+TEST_F(TestCommands, IndexFollowsTreeBetweenBatches)
+{
+    m_commands.AddChild(InternElementId("panel"), InternElementId("status"), ElemType::Box);
+    EXPECT_TRUE(m_commands.Apply(*m_uiTree).reindexed);
+
+    // own changes keep the index, removed elements leave it with their subtree
+    m_commands.AddChild(InternElementId("status"), InternElementId("status-icon"), ElemType::Box);
+    m_commands.RemoveSubtree(InternElementId("panel"));
+    auto stats = m_commands.Apply(*m_uiTree);
+    EXPECT_FALSE(stats.reindexed);
+    EXPECT_EQ(stats.applied, 2);
+
+    m_commands.SetProperty(InternElementId("alarm"), PropertyField::Hidden, true);
+    m_commands.SetProperty(InternElementId("status"), PropertyField::Hidden, true);
+    stats = m_commands.Apply(*m_uiTree);
+    EXPECT_FALSE(stats.reindexed);
+    EXPECT_EQ(stats.dropped, 2);
+
+    // elements added outside the queue are found after the tree is indexed again
+    m_uiTree->GetRoot()->AddChild(std::make_unique<UiElement>("sidebar", ElemType::Box));
+    m_commands.SetProperty(InternElementId("sidebar"), PropertyField::Hidden, true);
+    stats = m_commands.Apply(*m_uiTree);
+    EXPECT_TRUE(stats.reindexed);
+    EXPECT_EQ(stats.applied, 1);
+    EXPECT_TRUE(m_uiTree->GetChild("sidebar")->properties.hidden);
+}
+
+TEST_F(TestCommands, MismatchedValueTypeIsDropped)
+{
+    m_commands.SetProperty(InternElementId("alarm"), PropertyField::Width, Color{});
+
+    const auto stats = m_commands.Apply(*m_uiTree);
+    EXPECT_EQ(stats.dropped, 1);
+    EXPECT_EQ(m_uiTree->GetChild("alarm")->properties.width, 0);
+}
+
+TEST_F(TestCommands, PostingFromManyThreads)
+{
+    constexpr int THREADS = 4;
+    constexpr int CHILDREN_PER_THREAD = 20;
+
+    auto threads = std::vector<std::thread>();
+    for (int thread = 0; thread < THREADS; thread++) {
+        threads.emplace_back([this, thread] {
+            const auto parent = InternElementId(std::format("worker-{}", thread));
+            m_commands.AddChild(InternElementId("panel"), parent, ElemType::Box);
+            for (int child = 0; child < CHILDREN_PER_THREAD; child++) {
+                m_commands.AddChild(parent, InternElementId(std::format("worker-{}-{}", thread, child)), ElemType::Box);
+                m_commands.SetProperty(parent, PropertyField::Height, static_cast<float>(child));
+            }
+        });
+    }
+
+    // ui thread keeps applying while the workers post, order per thread guarantees parents exist
+    auto applied = size_t{0};
+    while (applied < THREADS * (1 + 2 * CHILDREN_PER_THREAD)) {
+        applied += m_commands.Apply(*m_uiTree).applied;
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int thread = 0; thread < THREADS; thread++) {
+        const auto* worker = m_uiTree->GetChild(std::format("worker-{}", thread));
+        ASSERT_NE(worker, nullptr);
+        EXPECT_EQ(worker->GetAllChildren().size(), CHILDREN_PER_THREAD);
+        EXPECT_EQ(worker->properties.height, CHILDREN_PER_THREAD - 1);
+    }
+}
@@ -0,0 +1,130 @@
+#include "compressed_series.h"
+#include "gtest/gtest.h"
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+void ExpectBitExact(const std::vector<double>& expected, const std::vector<double>& real)
+{
+    ASSERT_EQ(expected.size(), real.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(std::bit_cast<uint64_t>(expected[i]), std::bit_cast<uint64_t>(real[i])) << i;
+    }
+}
+
+} // namespace
+
+TEST(TestCompressedSeries, RoundTripsArbitrarySamples)
+{
+    auto generator = std::mt19937_64(42);
+    auto timestamps = std::vector<int64_t>();
+    auto values = std::vector<double>();
+
+    // irregular steps including huge jumps and repeated timestamps, random bit patterns
+    auto timestamp = std::numeric_limits<int64_t>::min() / 2;
+    for (int i = 0; i < 5000; i++) {
+        const auto step = i % 97 == 0 ? int64_t(1) << 50 : static_cast<int64_t>(generator() % 5000);
+        timestamp += i % 13 == 0 ? 0 : step;
+        timestamps.push_back(timestamp);
+        values.push_back(std::bit_cast<double>(generator()));
+    }
+    values[10] = NAN;
+    values[11] = -0.0;
+    values[12] = std::numeric_limits<double>::infinity();
+    values[13] = values[12];
+
+    auto series = CompressedSeries(256);
+    series.Append(timestamps, values);
+    EXPECT_EQ(series.GetSampleCount(), 5000);
+    EXPECT_EQ(series.GetBlockCount(), size_t(20));
+
+    auto readTimestamps = std::vector<int64_t>();
+    auto readValues = std::vector<double>();
+    series.Read({std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()}, readTimestamps,
+                readValues);
+    EXPECT_EQ(readTimestamps, timestamps);
+    ExpectBitExact(values, readValues);
+}
+
+TEST(TestCompressedSeries, CompressesRegularSlowSeries)
+{
+    // one day of 1 Hz samples of a slowly changing gauge
+    auto series = CompressedSeries();
+    const auto start = int64_t(1'700'000'000'000);
+    for (int i = 0; i < 86'400; i++) {
+        series.Append(start + i * 1000, std::round(std::sin(i / 3600.0) * 100) / 4);
+    }
+
+    // raw samples take 16 bytes, here most timestamps cost 1 bit and most values a few
+    EXPECT_GT(series.GetCompressionRatio(), 8);
+    EXPECT_LT(series.GetCompressedBytes(), size_t(86'400 * 16 / 8));
+}
+
+TEST(TestCompressedSeries, ReadDecodesOnlyOverlappingBlocks)
+{
+    auto series = CompressedSeries(100, 2);
+    for (int i = 0; i < 1000; i++) {
+        series.Append(i * 10, i);
+    }
+
+    auto timestamps = std::vector<int64_t>();
+    auto values = std::vector<double>();
+
+    // samples 150 to 250 in blocks 1 and 2
+    series.Read({1500, 2500}, timestamps, values);
+    ASSERT_EQ(values.size(), size_t(101));
+    EXPECT_EQ(timestamps.front(), 1500);
+    EXPECT_EQ(values.back(), 250);
+    EXPECT_EQ(series.GetStats().cacheMisses, 2);
+    EXPECT_EQ(series.GetStats().decodedSamples, 200);
+
+    // same window again comes from the cache
+    series.Read({1505, 2495}, timestamps, values);
+    EXPECT_EQ(values.size(), size_t(99));
+    EXPECT_EQ(series.GetStats().cacheHits, 2);
+    EXPECT_EQ(series.GetStats().cacheMisses, 2);
+
+    // scrolling by one block decodes one block, the least recently used is evicted
+    series.Read({2500, 3500}, timestamps, values);
+    EXPECT_EQ(series.GetStats().cacheMisses, 3);
+    series.Read({1500, 1600}, timestamps, values);
+    EXPECT_EQ(series.GetStats().cacheMisses, 4);
+
+    series.Read({20'000, 30'000}, timestamps, values);
+    EXPECT_TRUE(values.empty());
+    series.Read({-100, -1}, timestamps, values);
+    EXPECT_TRUE(values.empty());
+}
+
+TEST(TestCompressedSeries, GrowingLastBlockIsDecodedAgain)
+{
+    auto series = CompressedSeries(100);
+    auto timestamps = std::vector<int64_t>();
+    auto values = std::vector<double>();
+
+    series.Append(0, 1);
+    series.Append(1, 2);
+    series.Read({0, 100}, timestamps, values);
+    EXPECT_EQ(values.size(), size_t(2));
+
+    series.Append(2, 3);
+    series.Read({0, 100}, timestamps, values);
+    ASSERT_EQ(values.size(), size_t(3));
+    EXPECT_EQ(values[2], 3);
+
+    EXPECT_THROW(series.Append(1, 0), std::runtime_error);
+    EXPECT_THROW(series.Append(std::vector<int64_t>{5}, std::vector<double>{}), std::runtime_error);
+    EXPECT_THROW(CompressedSeries(0), std::runtime_error);
+
+    series.Clear();
+    EXPECT_EQ(series.GetSampleCount(), 0);
+    series.Append(0, 7);
+    series.Read({0, 100}, timestamps, values);
+    ASSERT_EQ(values.size(), size_t(1));
+    EXPECT_EQ(values[0], 7);
+}
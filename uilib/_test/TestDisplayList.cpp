@@ -0,0 +1,175 @@
+#include "display_list.h"
+#include "renderer.h"
+#include "triple_buffer.h"
+#include "uielement.h"
+#include "uitree.h"
+#include "gtest/gtest.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <queue>
+#include <thread>
+
+TEST(TripleBuffer, ConsumerSeesLatestPublishedValue)
+{
+    auto buffer = TripleBuffer<int>();
+    EXPECT_FALSE(buffer.Acquire());
+
+    buffer.GetWriteBuffer() = 1;
+    buffer.Publish();
+    buffer.GetWriteBuffer() = 2;
+    buffer.Publish();
+
+    EXPECT_TRUE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetReadBuffer(), 2);
+
+    // nothing new, read buffer stays valid
+    EXPECT_FALSE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetReadBuffer(), 2);
+
+    buffer.GetWriteBuffer() = 3;
+    EXPECT_FALSE(buffer.Acquire());
+    buffer.Publish();
+    EXPECT_TRUE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetReadBuffer(), 3);
+}
+
+TEST(TripleBuffer, ReadSequenceFollowsAcquiredValue)
+{
+    auto buffer = TripleBuffer<int>();
+    EXPECT_EQ(buffer.GetWriteSequence(), 1);
+    EXPECT_EQ(buffer.GetReadSequence(), 0);
+
+    buffer.Publish();
+    buffer.Publish();
+    EXPECT_EQ(buffer.GetWriteSequence(), 3);
+
+    // value 1 was skipped, the consumer reads 2 and will never go back to 1
+    EXPECT_EQ(buffer.GetReadSequence(), 0);
+    EXPECT_TRUE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetReadSequence(), 2);
+
+    buffer.Publish();
+    EXPECT_EQ(buffer.GetReadSequence(), 2);
+    EXPECT_TRUE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetReadSequence(), 3);
+}
+
+TEST(TripleBuffer, ConcurrentHandOffNeverTearsOrGoesBack)
+{
+    struct Snapshot {
+        std::array<uint64_t, 16> values{};
+    };
+
+    constexpr uint64_t FRAMES = 200'000;
+    auto buffer = TripleBuffer<Snapshot>();
+    auto done = std::atomic<bool>(false);
+
+    auto producer = std::thread([&] {
+        for (uint64_t frame = 1; frame <= FRAMES; frame++) {
+            auto& snapshot = buffer.GetWriteBuffer();
+            snapshot.values.fill(frame);
+            buffer.Publish();
+        }
+        done = true;
+    });
+
+    uint64_t last = 0;
+    bool torn = false;
+    bool backwards = false;
+    bool finished = false;
+    while (!finished) {
+        // read before acquiring, so the last published frame is seen once the producer is done
+        finished = done;
+        buffer.Acquire();
+        const auto& snapshot = buffer.GetReadBuffer();
+        const auto frame = snapshot.values[0];
+        for (const auto value : snapshot.values) {
+            torn |= value != frame;
+        }
+        backwards |= frame < last;
+        last = frame;
+    }
+    producer.join();
+
+    EXPECT_FALSE(torn);
+    EXPECT_FALSE(backwards);
+    EXPECT_EQ(last, FRAMES);
+}
+
+TEST(TripleBuffer, WaitForPublishBlocksUntilNewValue)
+{
+    auto buffer = TripleBuffer<int>();
+    auto published = std::atomic<bool>(false);
+
+    auto producer = std::thread([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffer.GetWriteBuffer() = 7;
+        published = true;
+        buffer.Publish();
+    });
+
+    buffer.WaitForPublish();
+    EXPECT_TRUE(published);
+    EXPECT_TRUE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetReadBuffer(), 7);
+    producer.join();
+
+    // value that was not acquired yet returns immediately
+    buffer.GetWriteBuffer() = 8;
+    buffer.Publish();
+    buffer.WaitForPublish();
+    EXPECT_TRUE(buffer.Acquire());
+    EXPECT_EQ(buffer.GetReadBuffer(), 8);
+}
+
+TEST(DisplayList, MergesTriangleBatches)
+{
+    auto displayList = DisplayList();
+    const auto triangle = std::array<sf::Vertex, 3>{};
+
+    displayList.AddVertices(sf::PrimitiveType::Triangles, triangle);
+    displayList.AddVertices(sf::PrimitiveType::Triangles, triangle);
+    EXPECT_EQ(displayList.GetBatchCount(), 1);
+
+    displayList.AddVertices(sf::PrimitiveType::TriangleFan, triangle);
+    displayList.AddVertices(sf::PrimitiveType::TriangleFan, triangle);
+    displayList.AddVertices(sf::PrimitiveType::Triangles, triangle);
+    EXPECT_EQ(displayList.GetBatchCount(), 4);
+    EXPECT_EQ(displayList.GetVertexCount(), 15);
+
+    displayList.Clear();
+    EXPECT_EQ(displayList.GetBatchCount(), 0);
+    EXPECT_EQ(displayList.GetVertexCount(), 0);
+}
+
+TEST(DisplayList, SnapshotIsIndependentOfTree)
+{
+    auto uiTree = std::make_unique<UiTree>(Size{1000, 500});
+    auto renderQue = std::queue<UiElement*>();
+    auto renderer = Renderer(renderQue);
+
+    for (int i = 0; i < 3; i++) {
+        auto element = std::make_unique<UiElement>(std::format("box-{}", i), ElemType::Box);
+        element->properties.border_radius_px = 4;
+        uiTree->GetRoot()->AddChild(std::move(element));
+    }
+
+    auto displayList = DisplayList();
+    renderer.BuildDisplayList(uiTree.get(), displayList);
+
+    // root and three children are boxes, all of them are drawn with one call
+    EXPECT_EQ(displayList.GetBatchCount(), 1);
+    EXPECT_GT(displayList.GetVertexCount(), 0);
+    EXPECT_EQ(displayList.GetVertexCount() % 3, 0);
+
+    const auto vertexCount = displayList.GetVertexCount();
+    uiTree->RemoveChild("box-0");
+    EXPECT_EQ(displayList.GetVertexCount(), vertexCount);
+
+    auto nextList = DisplayList();
+    renderer.BuildDisplayList(uiTree.get(), nextList);
+    EXPECT_LT(nextList.GetVertexCount(), vertexCount);
+    EXPECT_GT(nextList.GetFrame(), displayList.GetFrame());
+}
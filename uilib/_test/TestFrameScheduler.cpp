@@ -0,0 +1,110 @@
+#include "frame_scheduler.h"
+#include "uielement.h"
+#include "uitree.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+class TestFrameScheduler : public testing::Test {
+  protected:
+    static constexpr auto INTERVAL = std::chrono::microseconds(10'000);
+
+    TestFrameScheduler()
+        : m_uiTree(std::make_unique<UiTree>(Size{800, 600}))
+        , m_scheduler(*m_uiTree, INTERVAL)
+        , m_start(FrameScheduler::Clock::now())
+    {
+    }
+
+    // Builds a frame at start + offset if one is due
+    auto RenderAt(FrameScheduler::Clock::duration offset) -> bool
+    {
+        if (!m_scheduler.BeginFrame(m_start + offset)) {
+            return false;
+        }
+
+        m_scheduler.EndFrame();
+        return true;
+    }
+
+    std::unique_ptr<UiTree> m_uiTree;
+    FrameScheduler m_scheduler;
+    FrameScheduler::Clock::time_point m_start;
+};
+
+TEST_F(TestFrameScheduler, UnchangedTreeIsNotRedrawn)
+{
+    EXPECT_TRUE(RenderAt(0us));
+
+    for (int frame = 1; frame <= 10; frame++) {
+        EXPECT_FALSE(RenderAt(INTERVAL * frame));
+    }
+    EXPECT_EQ(m_scheduler.GetWaitTimeout(m_start + INTERVAL), FrameScheduler::MAX_WAIT);
+
+    m_uiTree->GetRoot()->AddChild(std::make_unique<UiElement>("changed", ElemType::Box));
+    EXPECT_EQ(m_scheduler.GetWaitTimeout(m_start + INTERVAL * 10), FrameScheduler::Clock::duration::zero());
+    EXPECT_TRUE(RenderAt(INTERVAL * 10));
+    EXPECT_FALSE(RenderAt(INTERVAL * 11));
+
+    const auto& stats = m_scheduler.GetStats();
+    EXPECT_EQ(stats.renderedFrames, 2);
+    EXPECT_EQ(stats.skippedFrames, 9);
+}
+
+TEST_F(TestFrameScheduler, FramesAreCappedByInterval)
+{
+    EXPECT_TRUE(RenderAt(0us));
+
+    m_scheduler.Invalidate();
+    EXPECT_FALSE(RenderAt(INTERVAL / 2));
+    EXPECT_EQ(m_scheduler.GetWaitTimeout(m_start + INTERVAL / 2), INTERVAL / 2);
+    EXPECT_TRUE(RenderAt(INTERVAL));
+
+    // changes made while building a frame are part of it
+    m_scheduler.Invalidate();
+    EXPECT_TRUE(m_scheduler.BeginFrame(m_start + INTERVAL * 2));
+    m_uiTree->GetRoot()->AddChild(std::make_unique<UiElement>("during-frame", ElemType::Box));
+    m_scheduler.EndFrame();
+    EXPECT_FALSE(RenderAt(INTERVAL * 3));
+}
+
+TEST_F(TestFrameScheduler, AnimationFramesUseOwnCap)
+{
+    m_scheduler.SetAnimationInterval(INTERVAL * 4);
+
+    EXPECT_TRUE(m_scheduler.BeginFrame(m_start));
+    m_scheduler.RequestAnimationFrame();
+    m_scheduler.EndFrame();
+
+    EXPECT_FALSE(RenderAt(INTERVAL));
+    EXPECT_FALSE(RenderAt(INTERVAL * 3));
+    EXPECT_TRUE(RenderAt(INTERVAL * 4));
+
+    // animation stopped requesting frames
+    EXPECT_FALSE(RenderAt(INTERVAL * 8));
+
+    m_scheduler.RequestFrameAt(m_start + INTERVAL * 20);
+    EXPECT_FALSE(RenderAt(INTERVAL * 19));
+    EXPECT_TRUE(RenderAt(INTERVAL * 20));
+}
+
+TEST_F(TestFrameScheduler, NotifyWakesWaitingThread)
+{
+    EXPECT_TRUE(RenderAt(0us));
+
+    auto producer = std::thread([this] {
+        std::this_thread::sleep_for(20ms);
+        m_scheduler.Notify();
+    });
+
+    // nothing is due, only the notification ends the wait
+    m_scheduler.Wait();
+    producer.join();
+
+    EXPECT_TRUE(m_scheduler.BeginFrame(FrameScheduler::Clock::now()));
+    m_scheduler.EndFrame();
+    EXPECT_FALSE(m_scheduler.BeginFrame(FrameScheduler::Clock::now() + INTERVAL));
+}
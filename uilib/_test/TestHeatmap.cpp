@@ -0,0 +1,93 @@
+#include "plot_heatmap.h"
+#include "gtest/gtest.h"
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+TEST(TestHeatmap, ColormapClampsValuesIntoRange)
+{
+    const auto stops = std::array<sf::Color, 2>{sf::Color::Black, sf::Color::White};
+    const auto colormap = Colormap(stops);
+
+    const auto values = std::vector<float>{-1, 0, 0.5f, 1, 2, NAN};
+    auto pixels = std::vector<uint32_t>(values.size());
+    colormap.Map(values, {0, 1}, pixels);
+
+    const auto black = colormap.GetColor(0);
+    const auto white = colormap.GetColor(255);
+    EXPECT_EQ(black, sf::Color::Black);
+    EXPECT_EQ(white, sf::Color::White);
+
+    const auto expected = std::vector<uint8_t>{0, 0, 127, 255, 255, 0};
+    for (size_t i = 0; i < values.size(); i++) {
+        EXPECT_EQ(reinterpret_cast<const uint8_t*>(&pixels[i])[0], expected[i]) << i;
+    }
+    EXPECT_EQ(pixels[5], pixels[0]);
+
+    // more values than one chunk
+    const auto many = std::vector<float>(1000, 1);
+    auto manyPixels = std::vector<uint32_t>(many.size());
+    colormap.Map(many, {0, 1}, manyPixels);
+    EXPECT_EQ(manyPixels.front(), manyPixels.back());
+    EXPECT_EQ(manyPixels.back(), pixels[3]);
+}
+
+TEST(TestHeatmap, UploadsOnlyNewColumns)
+{
+    auto heatmap = PlotHeatmap({10, 10}, {100, 100}, 4, 8, {0, 100});
+    EXPECT_EQ(heatmap.GetTextureSize(), sf::Vector2u(4, 8));
+
+    const auto column = std::vector<float>{1, 2, 3, 4};
+    for (int i = 0; i < 3; i++) {
+        heatmap.PushColumn(column);
+    }
+    heatmap.Update();
+    heatmap.Update();
+
+    const auto& stats = heatmap.GetStats();
+    EXPECT_EQ(stats.linesUploaded, 3);
+    EXPECT_EQ(stats.uploads, 1);
+
+    // one quad while the ring did not wrap, newest column ends at the right edge
+    ASSERT_EQ(heatmap.GetVertices().size(), size_t(6));
+    EXPECT_EQ(heatmap.GetVertices()[1].position.x, 110);
+
+    // wraps, lines 3 to 7 and line 0
+    for (int i = 0; i < 6; i++) {
+        heatmap.PushColumn(column);
+    }
+    heatmap.Update();
+    EXPECT_EQ(stats.linesUploaded, 9);
+    EXPECT_EQ(stats.uploads, 3);
+    EXPECT_EQ(stats.columnsPushed, 9);
+
+    // oldest line 1 to 7 on the left, line 0 on the right
+    const auto vertices = heatmap.GetVertices();
+    ASSERT_EQ(vertices.size(), size_t(12));
+    EXPECT_EQ(vertices[0].position.x, 10);
+    EXPECT_EQ(vertices[0].texCoords.y, 1);
+    EXPECT_EQ(vertices[6].texCoords.y, 0);
+    EXPECT_EQ(vertices[7].position.x, 110);
+}
+
+TEST(TestHeatmap, DownsamplesCellsToPixels)
+{
+    // 20 rows per pixel row, 5 columns per pixel column
+    auto heatmap = PlotHeatmap({0, 0}, {100, 50}, 1000, 500, {0, 1});
+    EXPECT_EQ(heatmap.GetTextureSize(), sf::Vector2u(50, 100));
+
+    const auto column = std::vector<float>(1000, 0.5f);
+    for (int i = 0; i < 4; i++) {
+        heatmap.PushColumn(column);
+    }
+    heatmap.Update();
+    EXPECT_EQ(heatmap.GetStats().linesUploaded, 0);
+
+    heatmap.PushColumn(column);
+    heatmap.Update();
+    EXPECT_EQ(heatmap.GetStats().linesUploaded, 1);
+
+    EXPECT_THROW(heatmap.PushColumn(std::vector<float>(999)), std::runtime_error);
+    EXPECT_THROW(PlotHeatmap({0, 0}, {0, 50}, 10, 10, {0, 1}), std::runtime_error);
+}
@@ -0,0 +1,216 @@
+#include "display_list.h"
+#include "renderer.h"
+#include "texture_cache.h"
+#include "uielement.h"
+#include "uitree.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Sources look like "name-64x32", "broken" fails to decode
+auto DecodeTestImage(const std::string& source) -> std::optional<sf::Image>
+{
+    unsigned width = 0;
+    unsigned height = 0;
+    const auto separator = source.rfind('-');
+    if (separator == std::string::npos || std::sscanf(source.c_str() + separator + 1, "%ux%u", &width, &height) != 2) {
+        return std::nullopt;
+    }
+
+    return sf::Image(sf::Vector2u{width, height});
+}
+
+// Updates the cache until everything submitted so far is uploaded
+void WaitForDecodes(TextureCache& cache)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (cache.GetPendingCount() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        cache.Update();
+    }
+}
+
+// Same while the render thread may still draw lists from readFrame on
+void WaitForDecodes(TextureCache& cache, uint64_t frame, uint64_t readFrame)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (cache.GetPendingCount() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        cache.Update(frame, readFrame);
+    }
+}
+
+constexpr size_t BIG_IMAGE_BYTES = 256 * 256 * 4;
+constexpr size_t ATLAS_BYTES = size_t(TextureCache::ATLAS_SIZE) * TextureCache::ATLAS_SIZE * 4;
+
+} // namespace
+
+TEST(TestImages, DecodesOffTheUiThread)
+{
+    const auto uiThread = std::this_thread::get_id();
+    auto decodedOn = std::thread::id();
+
+    auto cache = TextureCache(64 * 1024 * 1024, 1, [&decodedOn](const std::string& source) {
+        decodedOn = std::this_thread::get_id();
+        return DecodeTestImage(source);
+    });
+
+    EXPECT_EQ(cache.Find("photo-128x128"), nullptr);
+    EXPECT_EQ(cache.Find("photo-128x128"), nullptr);
+    WaitForDecodes(cache);
+
+    ASSERT_NE(cache.Find("photo-128x128"), nullptr);
+    EXPECT_NE(decodedOn, uiThread);
+
+    // lookups while decoding are not counted as misses, the image is decoded only once
+    const auto& stats = cache.GetStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.textureCount, 1);
+    EXPECT_EQ(stats.usedBytes, 128 * 128 * 4);
+}
+
+TEST(TestImages, SmallImagesShareAtlas)
+{
+    auto cache = TextureCache(64 * 1024 * 1024, 2, DecodeTestImage);
+
+    for (int i = 0; i < 10; i++) {
+        cache.Find(std::format("icon{}-16x16", i));
+    }
+    cache.Find("icon-64x20");
+    cache.Find("photo-256x256");
+    WaitForDecodes(cache);
+
+    const auto* first = cache.Find("icon0-16x16");
+    ASSERT_NE(first, nullptr);
+    for (int i = 1; i < 10; i++) {
+        const auto* icon = cache.Find(std::format("icon{}-16x16", i));
+        ASSERT_NE(icon, nullptr);
+        EXPECT_EQ(icon->texture, first->texture);
+        EXPECT_EQ(icon->rect.size, sf::Vector2f(16, 16));
+
+        // packed images never overlap
+        EXPECT_NE(icon->rect.position, first->rect.position);
+    }
+
+    EXPECT_EQ(cache.Find("icon-64x20")->texture, first->texture);
+    EXPECT_NE(cache.Find("photo-256x256")->texture, first->texture);
+
+    const auto& stats = cache.GetStats();
+    EXPECT_EQ(stats.atlasCount, 1);
+    EXPECT_EQ(stats.textureCount, 1);
+}
+
+TEST(TestImages, EvictsLeastRecentlyUsedOverBudget)
+{
+    auto cache = TextureCache(3 * BIG_IMAGE_BYTES, 2, DecodeTestImage);
+
+    for (int i = 0; i < 3; i++) {
+        cache.Find(std::format("photo{}-256x256", i));
+    }
+    WaitForDecodes(cache);
+
+    // photo-0 is the least recently used after this
+    cache.Find("photo1-256x256");
+    cache.Find("photo2-256x256");
+
+    cache.Find("photo3-256x256");
+    WaitForDecodes(cache);
+
+    const auto& stats = cache.GetStats();
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.textureCount, 3);
+    EXPECT_LE(stats.usedBytes, 3 * BIG_IMAGE_BYTES);
+
+    EXPECT_NE(cache.Find("photo1-256x256"), nullptr);
+    EXPECT_NE(cache.Find("photo3-256x256"), nullptr);
+
+    // evicted image is decoded again
+    const auto misses = stats.misses;
+    EXPECT_EQ(cache.Find("photo0-256x256"), nullptr);
+    EXPECT_EQ(stats.misses, misses + 1);
+}
+
+TEST(TestImages, TexturesDrawnByRenderThreadAreNotTouched)
+{
+    auto cache = TextureCache(ATLAS_BYTES + BIG_IMAGE_BYTES, 2, DecodeTestImage);
+
+    // list 1 draws the photo and the icon, the render thread keeps reading list 1
+    cache.Find("photo-256x256");
+    cache.Find("icon0-16x16");
+    WaitForDecodes(cache, 1, 0);
+    ASSERT_NE(cache.Find("photo-256x256"), nullptr);
+    const auto* drawnAtlas = cache.Find("icon0-16x16")->texture;
+
+    // new icon is packed into a copy of the page, the evicted photo stays alive
+    cache.Find("icon1-16x16");
+    cache.Find("poster-200x200");
+    WaitForDecodes(cache, 2, 1);
+
+    const auto& stats = cache.GetStats();
+    EXPECT_EQ(stats.atlasCopies, 1);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.retiredCount, 2);
+    EXPECT_EQ(cache.Find("photo-256x256"), nullptr);
+    EXPECT_NE(cache.Find("icon0-16x16")->texture, drawnAtlas);
+    EXPECT_EQ(cache.Find("icon1-16x16")->texture, cache.Find("icon0-16x16")->texture);
+
+    // render thread moved on to list 2, nothing drawn in list 1 is read anymore
+    cache.Update(3, 2);
+    EXPECT_EQ(stats.retiredCount, 0);
+}
+
+TEST(TestImages, FailedAndOversizedImagesStayPlaceholders)
+{
+    auto cache = TextureCache(BIG_IMAGE_BYTES, 2, DecodeTestImage);
+
+    cache.Find("broken");
+    cache.Find("poster-1024x1024");
+    WaitForDecodes(cache);
+
+    EXPECT_EQ(cache.Find("broken"), nullptr);
+    EXPECT_EQ(cache.Find("poster-1024x1024"), nullptr);
+
+    const auto& stats = cache.GetStats();
+    EXPECT_EQ(stats.decodeFailures, 1);
+    EXPECT_EQ(stats.oversized, 1);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.usedBytes, 0);
+}
+
+TEST(TestImages, ImageElementsAreBatchedThroughAtlas)
+{
+    auto uiTree = std::make_unique<UiTree>(Size{1000, 500});
+    auto cache = TextureCache(64 * 1024 * 1024, 2, DecodeTestImage);
+
+    for (int i = 0; i < 4; i++) {
+        auto image = std::make_unique<UiElement>(std::format("image-{}", i), ElemType::Image);
+        cache.SetImage(image->GetId(), std::format("icon{}-32x32", i));
+        uiTree->GetRoot()->AddChild(std::move(image));
+    }
+
+    auto renderQue = std::queue<UiElement*>();
+    auto renderer = Renderer(renderQue);
+    renderer.SetTextureCache(&cache);
+
+    // placeholders are plain boxes, drawn together with the root
+    auto displayList = DisplayList();
+    renderer.BuildDisplayList(uiTree.get(), displayList);
+    EXPECT_EQ(displayList.GetBatchCount(), 1);
+    EXPECT_EQ(cache.GetStats().misses, 4);
+
+    WaitForDecodes(cache);
+    renderer.BuildDisplayList(uiTree.get(), displayList);
+
+    // root box and one batch for all icons from the atlas
+    EXPECT_EQ(displayList.GetBatchCount(), 2);
+    EXPECT_EQ(cache.GetStats().hits, 4);
+}
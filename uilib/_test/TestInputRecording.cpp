@@ -0,0 +1,116 @@
+#include "input_recording.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+auto KeyPressed(sf::Keyboard::Key code, bool shift = false) -> sf::Event
+{
+    return sf::Event::KeyPressed{code, sf::Keyboard::Scancode::Unknown, false, false, shift, false};
+}
+
+auto ToBytes(const InputRecorder& recorder) -> std::vector<std::byte>
+{
+    auto stream = std::stringstream();
+    recorder.Write(stream);
+
+    const auto text = stream.str();
+    auto bytes = std::vector<std::byte>(text.size());
+    std::memcpy(bytes.data(), text.data(), text.size());
+    return bytes;
+}
+
+} // namespace
+
+TEST(TestInputRecording, RoundTripKeepsEveryEvent)
+{
+    auto recorder = InputRecorder();
+    EXPECT_TRUE(recorder.Record(KeyPressed(sf::Keyboard::Key::A, true), 100));
+    EXPECT_TRUE(recorder.Record(sf::Event::Resized{{1280, 720}}, 2'000));
+    EXPECT_TRUE(recorder.Record(sf::Event::MouseMoved{{-5, 40}}, 2'500));
+    EXPECT_TRUE(recorder.Record(sf::Event::MouseButtonPressed{sf::Mouse::Button::Right, {10, 20}}, 3'000));
+    EXPECT_TRUE(recorder.Record(sf::Event::MouseWheelScrolled{sf::Mouse::Wheel::Vertical, -1.5f, {7, 8}}, 3'000));
+    EXPECT_TRUE(recorder.Record(sf::Event::Closed{}, 9'000));
+
+    // focus changes do not affect what is rendered
+    EXPECT_FALSE(recorder.Record(sf::Event::FocusLost{}, 9'500));
+
+    const auto events = LoadInputRecording(ToBytes(recorder));
+    ASSERT_EQ(events.size(), size_t(6));
+    EXPECT_TRUE(std::equal(events.begin(), events.end(), recorder.GetEvents().begin()));
+
+    const auto key = ToSfEvent(events[0]);
+    ASSERT_TRUE(key.is<sf::Event::KeyPressed>());
+    EXPECT_EQ(key.getIf<sf::Event::KeyPressed>()->code, sf::Keyboard::Key::A);
+    EXPECT_TRUE(key.getIf<sf::Event::KeyPressed>()->shift);
+    EXPECT_FALSE(key.getIf<sf::Event::KeyPressed>()->control);
+
+    const auto resized = ToSfEvent(events[1]);
+    ASSERT_TRUE(resized.is<sf::Event::Resized>());
+    EXPECT_EQ(resized.getIf<sf::Event::Resized>()->size, sf::Vector2u(1280, 720));
+
+    const auto moved = ToSfEvent(events[2]);
+    ASSERT_TRUE(moved.is<sf::Event::MouseMoved>());
+    EXPECT_EQ(moved.getIf<sf::Event::MouseMoved>()->position, sf::Vector2i(-5, 40));
+
+    const auto pressed = ToSfEvent(events[3]);
+    ASSERT_TRUE(pressed.is<sf::Event::MouseButtonPressed>());
+    EXPECT_EQ(pressed.getIf<sf::Event::MouseButtonPressed>()->button, sf::Mouse::Button::Right);
+
+    const auto scrolled = ToSfEvent(events[4]);
+    ASSERT_TRUE(scrolled.is<sf::Event::MouseWheelScrolled>());
+    EXPECT_EQ(scrolled.getIf<sf::Event::MouseWheelScrolled>()->delta, -1.5f);
+
+    EXPECT_TRUE(ToSfEvent(events[5]).is<sf::Event::Closed>());
+}
+
+TEST(TestInputRecording, ReplayFollowsVirtualClock)
+{
+    auto recorder = InputRecorder();
+    recorder.Record(KeyPressed(sf::Keyboard::Key::A), 0);
+    recorder.Record(KeyPressed(sf::Keyboard::Key::B), 9'999);
+    recorder.Record(KeyPressed(sf::Keyboard::Key::C), 10'000);
+    recorder.Record(KeyPressed(sf::Keyboard::Key::D), 35'000);
+
+    auto replay = InputReplay({recorder.GetEvents().begin(), recorder.GetEvents().end()},
+                              std::chrono::microseconds(10'000));
+
+    // events per frame, independent of real time spent in each frame
+    const auto expected = std::vector<size_t>{2, 1, 0, 1};
+    for (const auto count : expected) {
+        size_t polled = 0;
+        while (replay.PollEvent()) {
+            polled++;
+        }
+
+        EXPECT_EQ(polled, count) << "frame " << replay.GetFrame();
+        replay.AdvanceFrame();
+    }
+
+    EXPECT_TRUE(replay.IsFinished());
+    EXPECT_EQ(replay.GetFrame(), uint64_t(4));
+    EXPECT_EQ(replay.GetVirtualTime(), std::chrono::microseconds(40'000));
+}
+
+TEST(TestInputRecording, MalformedRecordingThrows)
+{
+    auto recorder = InputRecorder();
+    recorder.Record(KeyPressed(sf::Keyboard::Key::A), 500);
+    recorder.Record(KeyPressed(sf::Keyboard::Key::B), 100);
+    const auto unordered = ToBytes(recorder);
+    EXPECT_THROW(LoadInputRecording(unordered), std::runtime_error);
+
+    const auto truncated = std::vector<std::byte>(unordered.begin(), unordered.end() - 1);
+    EXPECT_THROW(LoadInputRecording(truncated), std::runtime_error);
+
+    auto badMagic = unordered;
+    badMagic[0] = std::byte{0};
+    EXPECT_THROW(LoadInputRecording(badMagic), std::runtime_error);
+
+    EXPECT_THROW(InputReplay({}, std::chrono::microseconds(0)), std::runtime_error);
+}
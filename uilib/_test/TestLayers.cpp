@@ -0,0 +1,136 @@
+#include "display_list.h"
+#include "layer_cache.h"
+#include "renderer.h"
+#include "uielement.h"
+#include "uitree.h"
+#include "gtest/gtest.h"
+#include <format>
+#include <memory>
+#include <queue>
+
+class TestLayers : public testing::Test {
+  protected:
+    TestLayers()
+        : m_uiTree(std::make_unique<UiTree>(Size{1000, 500}))
+        , m_renderQue()
+        , m_renderer(std::make_unique<Renderer>(m_renderQue))
+    {
+        for (int panel = 0; panel < 2; panel++) {
+            auto panelElement = std::make_unique<UiElement>(std::format("panel-{}", panel), ElemType::Box);
+            panelElement->properties.height = 100;
+            panelElement->properties.border_radius_px = 5;
+            for (int cell = 0; cell < 5; cell++) {
+                auto cellElement = std::make_unique<UiElement>(std::format("cell-{}-{}", panel, cell), ElemType::Box);
+                cellElement->properties.height = 20;
+                cellElement->properties.border_radius_px = 2;
+                panelElement->AddChild(std::move(cellElement));
+            }
+            m_uiTree->GetRoot()->AddChild(std::move(panelElement));
+        }
+    }
+
+    auto Build() -> size_t
+    {
+        m_renderer->BuildDisplayList(m_uiTree.get(), m_displayList);
+        return m_displayList.GetVertexCount();
+    }
+
+    std::unique_ptr<UiTree> m_uiTree;
+    std::queue<UiElement*> m_renderQue;
+    std::unique_ptr<Renderer> m_renderer;
+    DisplayList m_displayList;
+};
+
+TEST_F(TestLayers, LayerIsReusedUntilInvalidated)
+{
+    const auto uncachedVertices = Build();
+
+    m_uiTree->GetChild("panel-0")->SetCachedAsLayer(true);
+    EXPECT_EQ(Build(), uncachedVertices);
+    EXPECT_EQ(Build(), uncachedVertices);
+    EXPECT_EQ(Build(), uncachedVertices);
+
+    const auto& stats = m_renderer->GetLayerCache().GetStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 2);
+    EXPECT_EQ(stats.layerCount, 1);
+    EXPECT_GT(stats.usedBytes, 0);
+    EXPECT_NEAR(stats.GetHitRate(), 2.0 / 3.0, 1e-9);
+
+    // change inside the layer through a transaction rebuilds it
+    auto* cell = m_uiTree->GetChild("cell-0-3");
+    auto properties = cell->properties;
+    properties.border_radius_px = 8;
+    auto transaction = m_uiTree->BeginTransaction();
+    transaction.SetProperties(cell, properties);
+    transaction.Commit();
+
+    const auto changedVertices = Build();
+    EXPECT_NE(changedVertices, uncachedVertices);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.invalidations, 1);
+
+    // same result as without layers
+    m_uiTree->GetChild("panel-0")->SetCachedAsLayer(false);
+    EXPECT_EQ(Build(), changedVertices);
+}
+
+TEST_F(TestLayers, ChangeOutsideLayerKeepsIt)
+{
+    m_uiTree->GetChild("panel-0")->SetCachedAsLayer(true);
+    Build();
+
+    m_uiTree->GetChild("panel-1")->AddChild(std::make_unique<UiElement>("extra", ElemType::Box));
+    Build();
+
+    const auto& stats = m_renderer->GetLayerCache().GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.invalidations, 0);
+}
+
+TEST_F(TestLayers, LeastRecentlyUsedLayerIsEvicted)
+{
+    m_uiTree->GetChild("panel-0")->SetCachedAsLayer(true);
+    Build();
+
+    auto& layers = m_renderer->GetLayerCache();
+    const auto oneLayer = layers.GetStats().usedBytes;
+
+    // room for one of the two layers only
+    layers.SetBudget(oneLayer + oneLayer / 2);
+    m_uiTree->GetChild("panel-1")->SetCachedAsLayer(true);
+    Build();
+
+    EXPECT_GE(layers.GetStats().evictions, 1);
+    EXPECT_EQ(layers.GetStats().layerCount, 1);
+    EXPECT_LE(layers.GetStats().usedBytes, oneLayer + oneLayer / 2);
+
+    // a layer bigger than the whole budget is drawn without caching
+    const auto expectedVertices = m_displayList.GetVertexCount();
+    layers.SetBudget(1);
+    EXPECT_EQ(Build(), expectedVertices);
+    EXPECT_GT(layers.GetStats().oversized, 0);
+    EXPECT_EQ(layers.GetStats().layerCount, 0);
+}
+
+TEST(UiElementVersion, VersionChangesOnStructureAndIsUniquePerElement)
+{
+    auto parent = std::make_unique<UiElement>("parent", ElemType::Box);
+    const auto initial = parent->GetSubtreeVersion();
+
+    parent->AddChild(std::make_unique<UiElement>("child", ElemType::Box));
+    EXPECT_NE(parent->GetSubtreeVersion(), initial);
+
+    // grandchild change propagates to all ancestors
+    auto* child = parent->GetAllChildren()[0];
+    const auto beforeInvalidate = parent->GetSubtreeVersion();
+    child->Invalidate();
+    EXPECT_NE(parent->GetSubtreeVersion(), beforeInvalidate);
+    EXPECT_EQ(parent->GetSubtreeVersion(), child->GetSubtreeVersion());
+
+    // pooled memory is reused, version is not
+    const auto removedVersion = child->GetSubtreeVersion();
+    parent->RemoveImmediateChildren();
+    auto reused = std::make_unique<UiElement>("reused", ElemType::Box);
+    EXPECT_NE(reused->GetSubtreeVersion(), removedVersion);
+}
@@ -0,0 +1,47 @@
+#include "uielement.h"
+#include "uitree.h"
+#include "gtest/gtest.h"
+#include <format>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Budget per element on memory constrained screens: the element itself plus its slot in the parent
+constexpr double MAX_BYTES_PER_ELEMENT = 104;
+
+TEST(TestMemory, PropertiesAndElementsArePacked)
+{
+    EXPECT_EQ(sizeof(Properties), 32);
+    EXPECT_EQ(sizeof(Color), 4);
+    EXPECT_LE(sizeof(UiElement), 80);
+}
+
+TEST(TestMemory, BytesPerElement)
+{
+    auto uiTree = std::make_unique<UiTree>(Size{1920, 1080});
+
+    // 9000 elements, every element with children has 10 of them
+    auto parents = std::vector<UiElement*>{uiTree->GetRoot()};
+    int created = 0;
+    for (size_t parent = 0; created < 9000; parent++) {
+        auto children = std::vector<std::unique_ptr<UiElement>>();
+        for (int i = 0; i < 10; i++, created++) {
+            children.push_back(std::make_unique<UiElement>(std::format("m-{}", created), ElemType::Box));
+            parents.push_back(children.back().get());
+        }
+        parents[parent]->AddChildren(std::move(children));
+    }
+
+    const auto usage = uiTree->GetMemoryUsage();
+    EXPECT_EQ(usage.elementCount, 9001);
+    EXPECT_GT(usage.children, 0);
+    EXPECT_GE(usage.nodePoolReserved, usage.elements);
+
+    std::cout << std::format("elements: {} B, children: {} B, traversal: {} B, per element: {:.1f} B, "
+                             "shared pool: {} B, shared names: {} B",
+                             usage.elements, usage.children, usage.traversalBuffers, usage.GetBytesPerElement(),
+                             usage.nodePoolReserved, usage.internedNames)
+              << std::endl;
+
+    EXPECT_LE(usage.GetBytesPerElement(), MAX_BYTES_PER_ELEMENT);
+}
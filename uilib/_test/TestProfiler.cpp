@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "frame_profiler.h"
+
+TEST(FrameTimeHistogram, PercentilesAreWithinBucketPrecision)
+{
+    auto histogram = FrameTimeHistogram();
+    EXPECT_EQ(histogram.GetPercentile(50), 0);
+
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.Add(i * 10.0);
+    }
+
+    EXPECT_EQ(histogram.GetCount(), 1000);
+    EXPECT_NEAR(histogram.GetPercentile(50), 5000, 5000 * 0.04);
+    EXPECT_NEAR(histogram.GetPercentile(95), 9500, 9500 * 0.04);
+    EXPECT_NEAR(histogram.GetPercentile(99), 9900, 9900 * 0.04);
+
+    histogram.Clear();
+    EXPECT_EQ(histogram.GetCount(), 0);
+}
+
+TEST(FrameProfiler, NestedStagesAreExclusive)
+{
+    auto profiler = FrameProfiler();
+
+    profiler.BeginFrame();
+    {
+        const auto drawables = FrameProfiler::ScopedStage(&profiler, FrameStage::Drawables);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        {
+            const auto tessellation = FrameProfiler::ScopedStage(&profiler, FrameStage::Tessellation);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    profiler.AddElementsVisited(10);
+    profiler.AddDrawCalls(3);
+    profiler.EndFrame();
+
+    ASSERT_EQ(profiler.GetFrameCount(), 1);
+    const auto& frame = profiler.GetFrame(0);
+
+    const auto drawables = frame.stageMicroseconds[static_cast<size_t>(FrameStage::Drawables)];
+    const auto tessellation = frame.stageMicroseconds[static_cast<size_t>(FrameStage::Tessellation)];
+    EXPECT_GE(tessellation, 10'000);
+    EXPECT_GE(drawables, 2'000);
+    EXPECT_LT(drawables, tessellation);
+    EXPECT_GE(frame.frameMicroseconds, drawables + tessellation);
+    EXPECT_EQ(frame.elementsVisited, 10);
+    EXPECT_EQ(frame.drawCalls, 3);
+    EXPECT_EQ(profiler.GetHistogram().GetCount(), 1);
+}
+
+TEST(FrameProfiler, HistoryKeepsLastFrames)
+{
+    auto profiler = FrameProfiler();
+
+    for (uint32_t i = 0; i < FrameProfiler::HISTORY_SIZE + 10; ++i) {
+        profiler.BeginFrame();
+        profiler.AddDrawCalls(i);
+        profiler.EndFrame();
+    }
+
+    EXPECT_EQ(profiler.GetFrameCount(), FrameProfiler::HISTORY_SIZE);
+    EXPECT_EQ(profiler.GetFrame(0).drawCalls, FrameProfiler::HISTORY_SIZE + 9);
+    EXPECT_EQ(profiler.GetFrame(FrameProfiler::HISTORY_SIZE - 1).drawCalls, 10);
+}
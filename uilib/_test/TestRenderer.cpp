@@ -81,8 +81,8 @@ TEST_F(TestRenderer, TestGetDrawables_MultipleFrames)
 
     auto drawablesSecondFrame = renderer->GetDrawables(m_tree.get());
 
-    for (const auto& [name, drawable] : drawablesSecondFrame) {
-        if (name == "child-1") {
+    for (const auto& [id, drawable] : drawablesSecondFrame) {
+        if (GetElementName(id) == "child-1") {
             auto rect = dynamic_cast<sf::RectangleShape*>(drawable);
             ASSERT_NE(rect, nullptr);
 
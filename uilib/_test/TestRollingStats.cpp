@@ -0,0 +1,133 @@
+#include "plot_axis.h"
+#include "plot_series.h"
+#include "rolling_stats.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Statistics of the window recomputed from scratch
+void ExpectMatchesBruteForce(const RollingStats& stats, std::span<const double> history)
+{
+    const auto count = std::min(history.size(), stats.GetWindow());
+    const auto window = history.last(count);
+    ASSERT_EQ(stats.GetCount(), count);
+
+    auto mean = 0.0;
+    for (const auto value : window) {
+        mean += value;
+    }
+    mean /= static_cast<double>(count);
+
+    auto variance = 0.0;
+    for (const auto value : window) {
+        variance += (value - mean) * (value - mean);
+    }
+    variance /= static_cast<double>(count);
+
+    EXPECT_EQ(stats.GetMin(), *std::ranges::min_element(window));
+    EXPECT_EQ(stats.GetMax(), *std::ranges::max_element(window));
+    EXPECT_NEAR(stats.GetMean(), mean, 1e-9 * std::max(1.0, std::abs(mean)));
+    EXPECT_NEAR(stats.GetVariance(), variance, 1e-7 * std::max(1.0, variance));
+}
+
+} // namespace
+
+TEST(TestRollingStats, MatchesBruteForceOverSlidingWindow)
+{
+    auto generator = std::mt19937(7);
+    auto noise = std::normal_distribution<double>(0, 5);
+
+    for (const auto window : {size_t(1), size_t(2), size_t(17), size_t(256)}) {
+        auto stats = RollingStats(window);
+        auto history = std::vector<double>();
+
+        // trend, noise and plateaus so both deques see rising, falling and equal samples
+        for (int i = 0; i < 3000; i++) {
+            const auto value = i % 400 < 50 ? 1000.0 : std::sin(i * 0.01) * 1000 + noise(generator);
+            history.push_back(value);
+            stats.Push(value);
+
+            if (i % 7 == 0) {
+                ExpectMatchesBruteForce(stats, history);
+            }
+        }
+        ExpectMatchesBruteForce(stats, history);
+    }
+
+    EXPECT_THROW(RollingStats(0), std::runtime_error);
+}
+
+TEST(TestRollingStats, EmptyAndCleared)
+{
+    auto stats = RollingStats(4);
+    EXPECT_EQ(stats.GetCount(), size_t(0));
+    EXPECT_EQ(stats.GetMin(), 0);
+    EXPECT_EQ(stats.GetVariance(), 0);
+
+    stats.Push(std::vector<double>{5, 1, 9});
+    EXPECT_EQ(stats.GetRange().start, 1);
+    EXPECT_EQ(stats.GetRange().end, 9);
+
+    stats.Clear();
+    EXPECT_EQ(stats.GetCount(), size_t(0));
+    EXPECT_EQ(stats.GetMax(), 0);
+    stats.Push(3);
+    EXPECT_EQ(stats.GetMin(), 3);
+    EXPECT_EQ(stats.GetMean(), 3);
+}
+
+TEST(TestRollingStats, SeriesKeepsStatsOfItsTail)
+{
+    auto series = PlotSeries(64);
+    EXPECT_EQ(series.GetRollingStats(), nullptr);
+
+    series.SetSamples(std::vector<double>{100, 1, 2, 3});
+    series.SetRollingWindow(3);
+    ASSERT_NE(series.GetRollingStats(), nullptr);
+    EXPECT_EQ(series.GetRollingStats()->GetMax(), 3);
+
+    auto& producer = series.GetQueue().RegisterProducer();
+    producer.Push(std::vector<double>{10, -4});
+    series.Ingest();
+    ExpectMatchesBruteForce(*series.GetRollingStats(), series.GetSamples());
+    EXPECT_EQ(series.GetRollingStats()->GetMin(), -4);
+
+    series.SetSamples(std::vector<double>{7, 8});
+    ExpectMatchesBruteForce(*series.GetRollingStats(), series.GetSamples());
+
+    series.SetRollingWindow(0);
+    EXPECT_EQ(series.GetRollingStats(), nullptr);
+}
+
+TEST(TestRollingStats, AxisHysteresis)
+{
+    auto axis = PlotAxis({0, 0}, 100, AxisType::Y);
+
+    EXPECT_TRUE(axis.AutoScale({0, 100}));
+    EXPECT_DOUBLE_EQ(axis.GetRange().start, -10);
+    EXPECT_DOUBLE_EQ(axis.GetRange().end, 110);
+
+    // small changes inside the range and not shrinking below half leave it alone
+    EXPECT_FALSE(axis.AutoScale({5, 105}));
+    EXPECT_FALSE(axis.AutoScale({20, 80}));
+
+    // leaving the range grows it
+    EXPECT_TRUE(axis.AutoScale({0, 120}));
+    EXPECT_DOUBLE_EQ(axis.GetRange().end, 132);
+
+    // padded data covering less than half of the range shrinks it
+    EXPECT_TRUE(axis.AutoScale({50, 60}));
+    EXPECT_DOUBLE_EQ(axis.GetRange().start, 49);
+    EXPECT_DOUBLE_EQ(axis.GetRange().end, 61);
+
+    // flat data keeps a range around the value and does not rescale on every call
+    EXPECT_TRUE(axis.AutoScale({500, 500}));
+    EXPECT_DOUBLE_EQ(axis.GetRange().start, 450);
+    EXPECT_FALSE(axis.AutoScale({500, 500}));
+}
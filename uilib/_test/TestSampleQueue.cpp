@@ -0,0 +1,113 @@
+#include "plot_series.h"
+#include "sample_queue.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+TEST(SpscSampleQueue, PushDrainWrapsAround)
+{
+    auto queue = SpscSampleQueue(8);
+    EXPECT_EQ(queue.GetCapacity(), 8);
+
+    auto drained = std::vector<double>();
+    const auto append = [&drained](std::span<const double> samples) {
+        drained.insert(drained.end(), samples.begin(), samples.end());
+    };
+
+    const auto first = std::vector<double>{1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(queue.Push(first), 6);
+    EXPECT_EQ(queue.Drain(append), 6);
+
+    // wraps around the end of the ring, only the free space is taken
+    const auto second = std::vector<double>{7, 8, 9, 10, 11, 12, 13, 14, 15};
+    EXPECT_EQ(queue.Push(second), 8);
+    EXPECT_EQ(queue.Push(second), 0);
+    EXPECT_EQ(queue.Drain(append), 8);
+    EXPECT_EQ(queue.Drain(append), 0);
+
+    EXPECT_EQ(drained, (std::vector<double>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14}));
+}
+
+TEST(MpscSampleQueue, ProducerLimit)
+{
+    auto queue = MpscSampleQueue(16);
+    for (size_t i = 0; i < MpscSampleQueue::MAX_PRODUCERS; i++) {
+        queue.RegisterProducer();
+    }
+
+    EXPECT_EQ(queue.GetProducerCount(), MpscSampleQueue::MAX_PRODUCERS);
+    EXPECT_THROW(queue.RegisterProducer(), std::runtime_error);
+}
+
+// Producers push 1M samples/sec each in batches while the ui thread ingests once per 1ms frame.
+// Sample value encodes producer and sequence number, so loss and reordering can be detected.
+TEST(PlotSeries, StressManyProducersNoLossNoReorder)
+{
+    constexpr uint64_t PRODUCERS = 4;
+    constexpr uint64_t SAMPLES_PER_PRODUCER = 250'000;
+    constexpr uint64_t BATCH = 1000;
+
+    auto series = PlotSeries(16 * 1024);
+    auto finished = std::atomic<uint64_t>(0);
+
+    auto producers = std::vector<std::thread>();
+    for (uint64_t producer = 0; producer < PRODUCERS; producer++) {
+        producers.emplace_back([&series, &finished, producer] {
+            auto& queue = series.GetQueue().RegisterProducer();
+            auto batch = std::vector<double>(BATCH);
+            auto next = std::chrono::steady_clock::now();
+
+            for (uint64_t sent = 0; sent < SAMPLES_PER_PRODUCER; sent += BATCH) {
+                for (uint64_t i = 0; i < BATCH; i++) {
+                    batch[i] = static_cast<double>(producer * SAMPLES_PER_PRODUCER + sent + i);
+                }
+
+                auto pending = std::span<const double>(batch);
+                while (!pending.empty()) {
+                    pending = pending.subspan(queue.Push(pending));
+                    if (!pending.empty()) {
+                        std::this_thread::yield();
+                    }
+                }
+
+                next += std::chrono::milliseconds(1);
+                std::this_thread::sleep_until(next);
+            }
+            finished++;
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    bool done = false;
+    while (!done) {
+        done = finished == PRODUCERS;
+        series.Ingest();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    const auto& samples = series.GetSamples();
+    ASSERT_EQ(samples.size(), PRODUCERS * SAMPLES_PER_PRODUCER);
+
+    auto expected = std::vector<uint64_t>(PRODUCERS);
+    for (const auto sample : samples) {
+        const auto value = static_cast<uint64_t>(sample);
+        const auto producer = value / SAMPLES_PER_PRODUCER;
+        ASSERT_LT(producer, PRODUCERS);
+        ASSERT_EQ(value % SAMPLES_PER_PRODUCER, expected[producer]);
+        expected[producer]++;
+    }
+
+    std::cout << std::format("{} samples from {} producers ingested in {}", samples.size(), PRODUCERS,
+                             std::chrono::duration_cast<std::chrono::milliseconds>(duration))
+              << std::endl;
+}
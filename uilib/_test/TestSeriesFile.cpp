@@ -0,0 +1,159 @@
+#include "series_file.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+auto ToBytes(const std::string& data) -> std::span<const std::byte>
+{
+    return {reinterpret_cast<const std::byte*>(data.data()), data.size()};
+}
+
+// 1000 samples, one every 0.5 s, value is the sample index
+auto WriteTestSeries(uint32_t chunkSize) -> std::string
+{
+    auto timestamps = std::vector<double>();
+    auto values = std::vector<double>();
+    for (int i = 0; i < 1000; i++) {
+        timestamps.push_back(i * 0.5);
+        values.push_back(i);
+    }
+
+    auto out = std::ostringstream();
+    WriteSeries(timestamps, values, out, chunkSize);
+    return std::move(out).str();
+}
+
+} // namespace
+
+TEST(TestSeriesFile, ColumnsAreReadInPlace)
+{
+    // string storage is not aligned for doubles, copied into an aligned buffer like a mapping
+    const auto written = WriteTestSeries(100);
+    auto buffer = std::vector<double>(written.size() / sizeof(double) + 1);
+    std::memcpy(buffer.data(), written.data(), written.size());
+    const auto bytes = std::span(reinterpret_cast<const std::byte*>(buffer.data()), written.size());
+
+    const auto file = SeriesFile(bytes);
+    EXPECT_EQ(file.GetSampleCount(), 1000);
+    EXPECT_EQ(file.GetChunkSize(), 100);
+
+    const auto samples = file.GetSamples();
+    ASSERT_EQ(samples.values.size(), size_t(1000));
+    EXPECT_EQ(samples.timestamps[999], 499.5);
+    EXPECT_EQ(samples.values[999], 999);
+
+    // no copy, the spans point into the buffer
+    EXPECT_GE(reinterpret_cast<const std::byte*>(samples.values.data()), bytes.data());
+    EXPECT_LT(reinterpret_cast<const std::byte*>(samples.values.data()), bytes.data() + bytes.size());
+    EXPECT_EQ((reinterpret_cast<const std::byte*>(samples.values.data()) - bytes.data()) % 64, 0);
+
+    const auto chunks = file.GetChunks();
+    ASSERT_EQ(chunks.size(), size_t(10));
+    EXPECT_EQ(chunks[3].firstTimestamp, 150);
+    EXPECT_EQ(chunks[3].lastTimestamp, 199.5);
+    EXPECT_EQ(chunks[3].minValue, 300);
+    EXPECT_EQ(chunks[3].maxValue, 399);
+}
+
+TEST(TestSeriesFile, SliceSkipsChunksOutsideTimeRange)
+{
+    const auto path = std::filesystem::temp_directory_path() / "boleui-series.uisf";
+    {
+        const auto written = WriteTestSeries(64);
+        auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+        out.write(written.data(), static_cast<std::streamsize>(written.size()));
+    }
+
+    const auto file = SeriesFile(path);
+
+    // samples 200 to 300 inclusive, spread over chunks 3 to 4
+    const auto slice = file.GetSlice({100, 150});
+    ASSERT_EQ(slice.values.size(), size_t(101));
+    EXPECT_EQ(slice.timestamps.front(), 100);
+    EXPECT_EQ(slice.timestamps.back(), 150);
+    EXPECT_EQ(slice.values.front(), 200);
+    EXPECT_EQ(slice.values.data(), file.GetSamples().values.data() + 200);
+
+    // between two samples
+    const auto between = file.GetSlice({100.1, 100.4});
+    EXPECT_TRUE(between.values.empty());
+
+    // past both ends
+    EXPECT_EQ(file.GetSlice({-10, 1000}).values.size(), size_t(1000));
+    EXPECT_TRUE(file.GetSlice({600, 700}).values.empty());
+    EXPECT_TRUE(file.GetSlice({-10, -1}).values.empty());
+
+    // whole chunks 3 and 4 from the chunk table, samples 192 to 319
+    const auto valueRange = file.GetValueRange({100, 150});
+    EXPECT_EQ(valueRange.start, 192);
+    EXPECT_EQ(valueRange.end, 319);
+    EXPECT_GT(file.GetValueRange({600, 700}).start, file.GetValueRange({600, 700}).end);
+
+    std::filesystem::remove(path);
+}
+
+TEST(TestSeriesFile, ConvertsCsv)
+{
+    const auto csv = std::string("time,value\n0,1.5\n 1 , -2\r\n\n2.5,3e2\n");
+    auto out = std::ostringstream();
+    EXPECT_EQ(ConvertCsvToSeries(csv, out, 2), 3);
+
+    const auto written = std::move(out).str();
+    auto buffer = std::vector<double>(written.size() / sizeof(double) + 1);
+    std::memcpy(buffer.data(), written.data(), written.size());
+    const auto file = SeriesFile(std::span(reinterpret_cast<const std::byte*>(buffer.data()), written.size()));
+
+    const auto samples = file.GetSamples();
+    ASSERT_EQ(samples.values.size(), size_t(3));
+    EXPECT_EQ(samples.timestamps[1], 1);
+    EXPECT_EQ(samples.timestamps[2], 2.5);
+    EXPECT_EQ(samples.values[0], 1.5);
+    EXPECT_EQ(samples.values[1], -2);
+    EXPECT_EQ(samples.values[2], 300);
+    EXPECT_EQ(file.GetChunks().size(), size_t(2));
+
+    auto ignored = std::ostringstream();
+    EXPECT_THROW(ConvertCsvToSeries("0,1\nx,2\n", ignored), std::runtime_error);
+    EXPECT_THROW(ConvertCsvToSeries("0,1\n1,2,3\n", ignored), std::runtime_error);
+    EXPECT_THROW(ConvertCsvToSeries("1,1\n0,2\n", ignored), std::runtime_error);
+}
+
+TEST(TestSeriesFile, RejectsMalformedFiles)
+{
+    auto ignored = std::ostringstream();
+    const auto timestamps = std::vector<double>{0, 1};
+    EXPECT_THROW(WriteSeries(timestamps, std::vector<double>{1}, ignored), std::runtime_error);
+    EXPECT_THROW(WriteSeries(timestamps, timestamps, ignored, 0), std::runtime_error);
+
+    const auto written = WriteTestSeries(100);
+    auto buffer = std::vector<double>(written.size() / sizeof(double) + 1);
+    const auto load = [&buffer](const std::string& data) {
+        std::memcpy(buffer.data(), data.data(), data.size());
+        return SeriesFile(std::span(reinterpret_cast<const std::byte*>(buffer.data()), data.size()));
+    };
+
+    EXPECT_NO_THROW(load(written));
+    EXPECT_THROW(load(written.substr(0, 20)), std::runtime_error);
+    EXPECT_THROW(load(written.substr(0, written.size() - 8)), std::runtime_error);
+
+    auto badMagic = written;
+    badMagic[0] = 'X';
+    EXPECT_THROW(load(badMagic), std::runtime_error);
+
+    // chunk count not matching the sample count
+    auto badChunks = written;
+    auto header = SeriesFileHeader{};
+    std::memcpy(&header, badChunks.data(), sizeof(header));
+    header.chunkCount = 3;
+    std::memcpy(badChunks.data(), &header, sizeof(header));
+    EXPECT_THROW(load(badChunks), std::runtime_error);
+
+    EXPECT_THROW(SeriesFile(std::filesystem::temp_directory_path() / "boleui-missing.uisf"), std::runtime_error);
+}
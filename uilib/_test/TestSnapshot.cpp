@@ -0,0 +1,239 @@
+#include "display_list.h"
+#include "plot_series.h"
+#include "renderer.h"
+#include "ui_snapshot.h"
+#include "uielement.h"
+#include "uitree.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+class TestSnapshot : public testing::Test {
+  protected:
+    TestSnapshot()
+        : m_uiTree(std::make_unique<UiTree>(Size{1920, 1080}))
+    {
+        auto* root = m_uiTree->GetRoot();
+        root->properties.color = {20, 10, 2};
+
+        for (int panel = 0; panel < 5; panel++) {
+            auto panelElement = std::make_unique<UiElement>(std::format("panel-{}", panel), ElemType::Box);
+            panelElement->properties.height = 400;
+            panelElement->properties.layout_children = LayoutDirection::Horizontal;
+            panelElement->properties.clip_children = panel % 2 == 0;
+            auto* added = panelElement.get();
+            root->AddChild(std::move(panelElement));
+
+            for (int child = 0; child < 8; child++) {
+                auto element = std::make_unique<UiElement>(std::format("panel-{}-{}", panel, child),
+                                                           child == 0 ? ElemType::Image : ElemType::Box);
+                element->properties.height = 20.5f + child;
+                element->properties.border_radius_px = 3;
+                element->properties.color = {uint8_t(panel * 40), uint8_t(child * 30), 200, 180};
+                element->properties.hidden = child == 7;
+                added->AddChild(std::move(element));
+            }
+        }
+
+        m_uiTree->GetChild("panel-3")->SetCachedAsLayer(true);
+
+        auto cpu = std::vector<double>(10'000);
+        auto memory = std::vector<double>(3'333);
+        for (size_t i = 0; i < cpu.size(); i++) {
+            cpu[i] = double(i) * 0.25;
+        }
+        for (size_t i = 0; i < memory.size(); i++) {
+            memory[i] = 1e9 - double(i);
+        }
+        m_cpu.SetSamples(cpu);
+        m_memory.SetSamples(memory);
+    }
+
+    auto GetSeries() -> std::vector<NamedPlotSeries>
+    {
+        return {{"cpu", &m_cpu}, {"memory", &m_memory}};
+    }
+
+    auto Save() -> std::vector<std::byte>
+    {
+        auto stream = std::stringstream();
+        WriteUiSnapshot(*m_uiTree, GetSeries(), stream);
+
+        const auto text = stream.str();
+        auto bytes = std::vector<std::byte>(text.size());
+        std::memcpy(bytes.data(), text.data(), text.size());
+        return bytes;
+    }
+
+    static auto Render(UiTree& uiTree) -> DisplayList
+    {
+        auto renderQue = std::queue<UiElement*>();
+        auto renderer = Renderer(renderQue);
+        auto displayList = DisplayList();
+        renderer.BuildDisplayList(&uiTree, displayList);
+        return displayList;
+    }
+
+    std::unique_ptr<UiTree> m_uiTree;
+    PlotSeries m_cpu;
+    PlotSeries m_memory;
+};
+
+TEST_F(TestSnapshot, RoundTripRestoresIdenticalTree)
+{
+    const auto bytes = Save();
+
+    auto restoredTree = std::make_unique<UiTree>(Size{800, 600});
+    auto restoredCpu = PlotSeries();
+    auto restoredMemory = PlotSeries();
+    const auto series = std::vector<NamedPlotSeries>{{"memory", &restoredMemory}, {"cpu", &restoredCpu}};
+    EXPECT_EQ(LoadUiSnapshot(bytes, *restoredTree, series), size_t(2));
+
+    const auto expected = m_uiTree->GetAllDescendantsDepthFirst();
+    const auto restored = restoredTree->GetAllDescendantsDepthFirst();
+    ASSERT_EQ(expected.size(), restored.size());
+
+    // root keeps its own name, everything else has to match exactly
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (i > 0) {
+            EXPECT_EQ(expected[i]->GetName(), restored[i]->GetName());
+        }
+        EXPECT_EQ(expected[i]->GetElementType(), restored[i]->GetElementType());
+        EXPECT_EQ(expected[i]->properties, restored[i]->properties);
+        EXPECT_EQ(expected[i]->IsCachedAsLayer(), restored[i]->IsCachedAsLayer());
+    }
+
+    EXPECT_EQ(restoredCpu.GetSamples(), m_cpu.GetSamples());
+    EXPECT_EQ(restoredMemory.GetSamples(), m_memory.GetSamples());
+
+    const auto expectedFrame = Render(*m_uiTree);
+    const auto restoredFrame = Render(*restoredTree);
+    EXPECT_EQ(expectedFrame.GetBatchCount(), restoredFrame.GetBatchCount());
+    ASSERT_EQ(expectedFrame.GetVertexCount(), restoredFrame.GetVertexCount());
+    EXPECT_GT(expectedFrame.GetVertexCount(), 0);
+
+    const auto expectedVertices = expectedFrame.GetVertices();
+    const auto restoredVertices = restoredFrame.GetVertices();
+    for (size_t i = 0; i < expectedVertices.size(); i++) {
+        EXPECT_EQ(expectedVertices[i].position, restoredVertices[i].position);
+        EXPECT_EQ(expectedVertices[i].color, restoredVertices[i].color);
+    }
+}
+
+TEST_F(TestSnapshot, RestoreReplacesExistingTree)
+{
+    const auto bytes = Save();
+
+    auto restoredTree = std::make_unique<UiTree>(Size{800, 600});
+    restoredTree->GetRoot()->AddChild(std::make_unique<UiElement>("stale", ElemType::Box));
+    auto untouched = PlotSeries();
+    untouched.SetSamples(std::vector<double>{1, 2, 3});
+
+    const auto series = std::vector<NamedPlotSeries>{{"not-in-snapshot", &untouched}};
+    EXPECT_EQ(LoadUiSnapshot(bytes, *restoredTree, series), size_t(0));
+
+    EXPECT_FALSE(restoredTree->HasChild("stale"));
+    EXPECT_EQ(restoredTree->GetAllDescendantsDepthFirst().size(), m_uiTree->GetAllDescendantsDepthFirst().size());
+    EXPECT_EQ(untouched.GetSamples().size(), size_t(3));
+}
+
+TEST_F(TestSnapshot, MalformedSnapshotLeavesTreeUntouched)
+{
+    const auto bytes = Save();
+    auto target = std::make_unique<UiTree>(Size{800, 600});
+    target->GetRoot()->AddChild(std::make_unique<UiElement>("kept", ElemType::Box));
+
+    const auto expectFailure = [&target](std::vector<std::byte> data) {
+        EXPECT_THROW(LoadUiSnapshot(data, *target, {}), std::runtime_error);
+        EXPECT_TRUE(target->HasChild("kept"));
+    };
+
+    expectFailure({bytes.begin(), bytes.begin() + 16});
+    expectFailure({bytes.begin(), bytes.end() - 64});
+
+    auto badMagic = bytes;
+    badMagic[0] = std::byte{0};
+    expectFailure(badMagic);
+
+    auto badVersion = bytes;
+    badVersion[offsetof(UiSnapshotHeader, version)] = std::byte{99};
+    expectFailure(badVersion);
+
+    // second element pointing to itself as parent
+    auto badParent = bytes;
+    const auto parentOffset = sizeof(UiSnapshotHeader) + sizeof(UiSnapshotElement);
+    badParent[parentOffset] = std::byte{1};
+    expectFailure(badParent);
+}
+
+TEST_F(TestSnapshot, TooManyChildrenAreRejected)
+{
+    auto wideTree = std::make_unique<UiTree>(Size{800, 600});
+    for (size_t panel = 0; panel < MAX_CHILDREN; panel++) {
+        auto panelElement = std::make_unique<UiElement>(std::format("wide-{}", panel), ElemType::Box);
+        panelElement->AddChild(std::make_unique<UiElement>(std::format("wide-{}-0", panel), ElemType::Box));
+        wideTree->GetRoot()->AddChild(std::move(panelElement));
+    }
+
+    auto stream = std::stringstream();
+    WriteUiSnapshot(*wideTree, {}, stream);
+    const auto text = stream.str();
+    auto bytes = std::vector<std::byte>(text.size());
+    std::memcpy(bytes.data(), text.data(), text.size());
+
+    // exactly MAX_CHILDREN children is still valid
+    auto restored = std::make_unique<UiTree>(Size{800, 600});
+    EXPECT_NO_THROW(LoadUiSnapshot(bytes, *restored, {}));
+
+    // every element moved under the root, parents stay before their children
+    auto header = UiSnapshotHeader{};
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    for (uint32_t i = 1; i < header.elementCount; i++) {
+        const auto parent = uint32_t(0);
+        const auto offset = header.elementTableOffset + size_t(i) * sizeof(UiSnapshotElement);
+        std::memcpy(bytes.data() + offset + offsetof(UiSnapshotElement, parent), &parent, sizeof(parent));
+    }
+
+    auto target = std::make_unique<UiTree>(Size{800, 600});
+    target->GetRoot()->AddChild(std::make_unique<UiElement>("kept", ElemType::Box));
+    EXPECT_THROW(LoadUiSnapshot(bytes, *target, {}), std::runtime_error);
+    EXPECT_TRUE(target->HasChild("kept"));
+}
+
+TEST_F(TestSnapshot, PlotDataRestoreThroughput)
+{
+    auto big = PlotSeries();
+    auto samples = std::vector<double>(8 * 1024 * 1024);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = double(i);
+    }
+    big.SetSamples(samples);
+
+    const auto path = std::filesystem::temp_directory_path() / "boleui-snapshot.uisn";
+    const auto series = std::vector<NamedPlotSeries>{{"big", &big}};
+    WriteUiSnapshotFile(*m_uiTree, series, path);
+
+    auto restoredTree = std::make_unique<UiTree>(Size{800, 600});
+    auto restored = PlotSeries();
+    const auto restoredSeries = std::vector<NamedPlotSeries>{{"big", &restored}};
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    LoadUiSnapshotFile(path, *restoredTree, restoredSeries);
+    const auto seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    const auto bytes = double(samples.size() * sizeof(double));
+    std::cout << std::format("Snapshot restore of {} MB of samples: {:.3f} s, {:.2f} GB/s", bytes / 1e6, seconds,
+                             bytes / 1e9 / seconds)
+              << std::endl;
+
+    EXPECT_EQ(restored.GetSamples(), samples);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,226 @@
+#include "types.h"
+#include "uielement.h"
+#include "uitree.h"
+#include "uitree_transaction.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+class TestTransaction : public testing::Test {
+  protected:
+    TestTransaction()
+        : m_uiTree(std::make_unique<UiTree>(Size{300, 100}))
+        , m_root(m_uiTree->GetRoot())
+    {
+    }
+
+    static auto MakeElement(const std::string& name) -> std::unique_ptr<UiElement>
+    {
+        return std::make_unique<UiElement>(name, ElemType::Box);
+    }
+
+    std::unique_ptr<UiTree> m_uiTree;
+    UiElement* m_root;
+};
+
+TEST_F(TestTransaction, AddChildren_LayoutMatchesSingleInserts)
+{
+    auto transaction = m_uiTree->BeginTransaction();
+    auto panel = MakeElement("panel");
+    auto* panelPtr = panel.get();
+    transaction.AddChild(m_root, std::move(panel));
+    transaction.AddChild(m_root, MakeElement("side"));
+    transaction.AddChild(panelPtr, MakeElement("panel-1"));
+    transaction.AddChild(panelPtr, MakeElement("panel-2"));
+
+    EXPECT_EQ(transaction.GetSize(), size_t(4));
+    EXPECT_FALSE(m_uiTree->HasChild("panel"));
+
+    transaction.Commit();
+    EXPECT_EQ(transaction.GetSize(), size_t(0));
+
+    const auto children = m_root->GetAllChildren();
+    ASSERT_EQ(children.size(), size_t(2));
+    EXPECT_EQ(children[0]->GetName(), "panel");
+    EXPECT_EQ(children[1]->GetName(), "side");
+    EXPECT_EQ(children[0]->properties.width, 150);
+    EXPECT_EQ(children[1]->properties.position.x, 150);
+
+    const auto panelChildren = panelPtr->GetAllChildren();
+    ASSERT_EQ(panelChildren.size(), size_t(2));
+    EXPECT_EQ(panelChildren[0]->properties.width, 75);
+    EXPECT_EQ(panelChildren[1]->properties.position.x, 75);
+}
+
+TEST_F(TestTransaction, RemoveChild_RelayoutsParent)
+{
+    m_root->AddChild(MakeElement("child-1"));
+    m_root->AddChild(MakeElement("child-2"));
+    m_root->AddChild(MakeElement("child-3"));
+
+    auto transaction = m_uiTree->BeginTransaction();
+    transaction.RemoveChild(m_uiTree->GetChild("child-2"));
+    transaction.Commit();
+
+    const auto children = m_root->GetAllChildren();
+    ASSERT_EQ(children.size(), size_t(2));
+    EXPECT_EQ(children[0]->GetName(), "child-1");
+    EXPECT_EQ(children[1]->GetName(), "child-3");
+    EXPECT_EQ(children[1]->properties.width, 150);
+    EXPECT_EQ(children[1]->properties.position.x, 150);
+}
+
+TEST_F(TestTransaction, SetProperties_RelayoutsSubtree)
+{
+    m_root->AddChild(MakeElement("child-1"));
+    auto* child = m_uiTree->GetChild("child-1");
+    child->AddChild(MakeElement("child-11"));
+    child->AddChild(MakeElement("child-12"));
+
+    auto properties = m_root->properties;
+    properties.width = 600;
+    properties.position = {10, 20};
+
+    auto transaction = m_uiTree->BeginTransaction();
+    transaction.SetProperties(m_root, properties);
+    transaction.Commit();
+
+    EXPECT_EQ(child->properties.width, 600);
+    EXPECT_EQ(child->properties.position.x, 10);
+
+    auto grandChildren = child->GetAllChildren();
+    EXPECT_EQ(grandChildren[1]->properties.width, 300);
+    EXPECT_EQ(grandChildren[1]->properties.position.x, 310);
+    EXPECT_EQ(grandChildren[1]->properties.position.y, 20);
+}
+
+TEST_F(TestTransaction, Commit_InvalidTransactionLeavesTreeUnchanged)
+{
+    m_root->AddChild(MakeElement("child-1"));
+    auto* child = m_uiTree->GetChild("child-1");
+
+    auto tooManyChildren = m_uiTree->BeginTransaction();
+    tooManyChildren.AddChild(m_root, MakeElement("valid"));
+    for (size_t i = 0; i < MAX_CHILDREN + 1; i++) {
+        tooManyChildren.AddChild(child, MakeElement("child"));
+    }
+    EXPECT_THROW(tooManyChildren.Commit(), std::runtime_error);
+    EXPECT_EQ(m_root->GetAllChildren().size(), size_t(1));
+    EXPECT_EQ(child->GetAllChildren().size(), size_t(0));
+
+    auto intoRemoved = m_uiTree->BeginTransaction();
+    intoRemoved.RemoveChild(child);
+    intoRemoved.AddChild(child, MakeElement("orphan"));
+    EXPECT_THROW(intoRemoved.Commit(), std::runtime_error);
+    EXPECT_TRUE(m_uiTree->HasChild("child-1"));
+
+    auto removeRoot = m_uiTree->BeginTransaction();
+    removeRoot.RemoveChild(m_root);
+    EXPECT_THROW(removeRoot.Commit(), std::runtime_error);
+
+    auto detached = MakeElement("detached");
+    auto outsideTree = m_uiTree->BeginTransaction();
+    outsideTree.AddChild(detached.get(), MakeElement("child"));
+    EXPECT_THROW(outsideTree.Commit(), std::runtime_error);
+}
+
+TEST_F(TestTransaction, MoveAndReorder)
+{
+    m_root->AddChild(MakeElement("child-1"));
+    m_root->AddChild(MakeElement("child-2"));
+    auto* child1 = m_uiTree->GetChild("child-1");
+    auto* child2 = m_uiTree->GetChild("child-2");
+    child1->AddChild(MakeElement("child-11"));
+    auto* child11 = m_uiTree->GetChild("child-11");
+
+    auto transaction = m_uiTree->BeginTransaction();
+    transaction.MoveChild(child11, m_root);
+    transaction.ReorderChildren(m_root, {child11, child2, child1});
+    transaction.Commit();
+
+    const auto children = m_root->GetAllChildren();
+    ASSERT_EQ(children.size(), size_t(3));
+    EXPECT_EQ(children[0], child11);
+    EXPECT_EQ(children[1], child2);
+    EXPECT_EQ(children[2], child1);
+    EXPECT_EQ(child11->GetParent(), m_root);
+    EXPECT_EQ(child11->properties.width, 100);
+    EXPECT_EQ(child1->GetAllChildren().size(), size_t(0));
+
+    auto cycle = m_uiTree->BeginTransaction();
+    cycle.MoveChild(child1, child2);
+    cycle.MoveChild(child2, child1);
+    EXPECT_THROW(cycle.Commit(), std::runtime_error);
+
+    auto incompleteOrder = m_uiTree->BeginTransaction();
+    incompleteOrder.ReorderChildren(m_root, {child1, child2});
+    EXPECT_THROW(incompleteOrder.Commit(), std::runtime_error);
+    EXPECT_EQ(m_root->GetAllChildren()[0], child11);
+}
+
+// Builds 100 panels x 100 rows x 9 cells, ~100k elements
+TEST_F(TestTransaction, Benchmark100kElements_SingleVsBatched)
+{
+    constexpr size_t PANELS = 100;
+    constexpr size_t ROWS = 100;
+    constexpr size_t CELLS = 9;
+
+    size_t singleCount = 0;
+    {
+        auto uiTree = std::make_unique<UiTree>(Size{1920, 1080});
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (size_t panel = 0; panel < PANELS; panel++) {
+            auto panelElement = MakeElement("panel");
+            auto* panelPtr = panelElement.get();
+            uiTree->GetRoot()->AddChild(std::move(panelElement));
+
+            for (size_t row = 0; row < ROWS; row++) {
+                auto rowElement = MakeElement("row");
+                auto* rowPtr = rowElement.get();
+                panelPtr->AddChild(std::move(rowElement));
+
+                for (size_t cell = 0; cell < CELLS; cell++) {
+                    rowPtr->AddChild(MakeElement("cell"));
+                }
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        singleCount = uiTree->GetAllDescendantsDepthFirst().size();
+        std::cout << std::format("Single inserts of {} elements: {}", singleCount,
+                                 std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1))
+                  << std::endl;
+    }
+
+    auto uiTree = std::make_unique<UiTree>(Size{1920, 1080});
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto transaction = uiTree->BeginTransaction();
+    for (size_t panel = 0; panel < PANELS; panel++) {
+        auto panelElement = MakeElement("panel");
+        auto* panelPtr = panelElement.get();
+        transaction.AddChild(uiTree->GetRoot(), std::move(panelElement));
+
+        for (size_t row = 0; row < ROWS; row++) {
+            auto rowElement = MakeElement("row");
+            auto* rowPtr = rowElement.get();
+            transaction.AddChild(panelPtr, std::move(rowElement));
+
+            for (size_t cell = 0; cell < CELLS; cell++) {
+                transaction.AddChild(rowPtr, MakeElement("cell"));
+            }
+        }
+    }
+    transaction.Commit();
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    const auto batchedCount = uiTree->GetAllDescendantsDepthFirst().size();
+    std::cout << std::format("Batched inserts of {} elements: {}", batchedCount,
+                             std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1))
+              << std::endl;
+
+    EXPECT_EQ(singleCount, size_t(1 + PANELS + PANELS * ROWS + PANELS * ROWS * CELLS));
+    EXPECT_EQ(batchedCount, singleCount);
+}
@@ -309,3 +309,24 @@ TEST_F(UiTreeTest, TestRemoveImmediateChildren)
     const auto& children = m_parent->GetAllChildren();
     EXPECT_EQ(children.size(), size_t(0));
 }
+
+TEST_F(UiTreeTest, TestElementIds)
+{
+    BasicUiTreeSetup();
+
+    EXPECT_EQ(InternElementId("child-1"), m_child1->GetId());
+    EXPECT_NE(m_child1->GetId(), m_child2->GetId());
+    EXPECT_EQ(m_child1->GetName(), "child-1");
+    EXPECT_EQ(GetElementName(m_child2->GetId()), "child-2");
+
+    // looking up unknown names does not intern them
+    const auto interned = GetInternedElementCount();
+    EXPECT_FALSE(FindElementId("never-used-name").has_value());
+    EXPECT_FALSE(m_parent->HasChild(m_traversalBuffer, "never-used-name"));
+    EXPECT_EQ(GetInternedElementCount(), interned);
+
+    EXPECT_EQ(m_parent->GetChild(m_traversalBuffer, m_child3->GetId()), m_child3);
+    EXPECT_TRUE(m_parent->RemoveChild(m_traversalBuffer, m_child2->GetId()));
+    EXPECT_FALSE(m_parent->HasChild(m_traversalBuffer, InternElementId("child-2")));
+    EXPECT_FALSE(m_parent->RemoveChild(m_traversalBuffer, InternElementId("child-2")));
+}
@@ -0,0 +1,151 @@
+#include "uielement.h"
+#include "uitree.h"
+#include "virtual_list.h"
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <vector>
+
+constexpr size_t ROW_COUNT = 1'000'000;
+constexpr float ROW_HEIGHT = 20;
+
+class TestVirtualList : public testing::Test {
+  protected:
+    TestVirtualList()
+    {
+        m_tree = std::make_unique<UiTree>(Size{800, 600});
+
+        auto container = std::make_unique<UiElement>("log", ElemType::Box);
+        m_container = container.get();
+        m_tree->GetRoot()->AddChild(std::move(container));
+
+        // root lays out its children horizontally, the list sits below a header
+        m_container->properties.position = {0, 100};
+        m_container->properties.height = 400;
+
+        // rows show their index in the red channel, so tests can tell which row an element is bound to
+        m_list = std::make_unique<VirtualList>(m_container, ROW_HEIGHT, [this](size_t row, UiElement& element) {
+            m_boundRows.push_back(row);
+            element.properties.color = {static_cast<uint8_t>(row % 256), 0, 0};
+        });
+        m_list->SetRowCount(ROW_COUNT);
+    }
+
+    std::unique_ptr<UiTree> m_tree;
+    UiElement* m_container;
+    std::unique_ptr<VirtualList> m_list;
+    std::vector<size_t> m_boundRows;
+};
+
+TEST_F(TestVirtualList, OnlyViewportAndOverscanAreMaterialized)
+{
+    m_list->Update();
+
+    // 400 / 20 visible, one partial row, 4 overscan rows on each side
+    EXPECT_EQ(m_list->GetMaterializedRowCount(), size_t(29));
+    EXPECT_EQ(m_container->GetAllChildren().size(), size_t(29));
+    EXPECT_EQ(m_boundRows.size(), size_t(29));
+    EXPECT_EQ(m_tree->GetAllDescendantsBreathFirst().size(), size_t(31));
+
+    auto* first = m_list->GetRowElement(0);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->properties.position.y, 100);
+    EXPECT_EQ(first->properties.width, 800);
+    EXPECT_EQ(first->properties.height, ROW_HEIGHT);
+    EXPECT_EQ(m_list->GetRowElement(29), nullptr);
+}
+
+TEST_F(TestVirtualList, ScrollMapsToRowWithoutWalkingHiddenRows)
+{
+    m_list->Update();
+    m_boundRows.clear();
+
+    m_list->ScrollTo(500'000 * ROW_HEIGHT + 5);
+    m_list->Update();
+
+    EXPECT_EQ(m_list->GetFirstVisibleRow(), size_t(500'000));
+    EXPECT_EQ(m_boundRows.size(), size_t(29));
+    EXPECT_EQ(m_boundRows.front(), size_t(500'000 - 4));
+
+    auto* row = m_list->GetRowElement(500'000);
+    ASSERT_NE(row, nullptr);
+    EXPECT_EQ(row->properties.position.y, 95);
+    EXPECT_EQ(row->properties.color.red, 500'000 % 256);
+
+    EXPECT_EQ(m_list->GetRowAt(100), 500'000);
+    EXPECT_EQ(m_list->GetRowAt(116), 500'001);
+    EXPECT_EQ(m_list->GetRowAt(99), std::nullopt);
+    EXPECT_EQ(m_list->GetRowAt(500), std::nullopt);
+}
+
+TEST_F(TestVirtualList, ScrollingByOneRowRecyclesOneRow)
+{
+    m_list->ScrollTo(1000 * ROW_HEIGHT);
+    m_list->Update();
+    m_boundRows.clear();
+
+    const auto elementsBefore = m_container->GetAllChildren();
+    const auto createdBefore = m_list->GetStats().rowsCreated;
+
+    m_list->ScrollBy(ROW_HEIGHT);
+    m_list->Update();
+
+    ASSERT_EQ(m_boundRows.size(), size_t(1));
+    EXPECT_EQ(m_boundRows.front(), size_t(1001 + 24));
+    EXPECT_EQ(m_list->GetStats().rowsCreated, createdBefore);
+    EXPECT_EQ(m_list->GetStats().rowsMoved, uint64_t(28));
+    EXPECT_EQ(m_container->GetAllChildren(), elementsBefore);
+
+    EXPECT_EQ(m_list->GetRowElement(1001)->properties.position.y, 100);
+}
+
+TEST_F(TestVirtualList, RowSubtreesMoveWithTheirRow)
+{
+    auto list = VirtualList(
+        m_container, ROW_HEIGHT,
+        [](size_t, UiElement& element) {
+            auto* label = element.GetAllChildren().front();
+            label->properties.position = {element.properties.position.x + 5, element.properties.position.y + 2};
+        },
+        0,
+        [](ElementId id) {
+            auto row = std::make_unique<UiElement>(id, ElemType::Box);
+            row->AddChild(std::make_unique<UiElement>(std::format("{}-label", GetElementName(id)), ElemType::Text));
+            return row;
+        });
+    m_container->RemoveImmediateChildren();
+    list.SetRowCount(100);
+    list.Update();
+
+    list.ScrollBy(ROW_HEIGHT / 2);
+    list.Update();
+
+    auto* row = list.GetRowElement(1);
+    ASSERT_NE(row, nullptr);
+    EXPECT_EQ(row->properties.position.y, 110);
+    EXPECT_EQ(row->GetAllChildren().front()->properties.position.y, 112);
+}
+
+TEST_F(TestVirtualList, PoolFollowsRowCountAndViewport)
+{
+    m_list->SetRowCount(3);
+    m_list->Update();
+    EXPECT_EQ(m_list->GetMaterializedRowCount(), size_t(3));
+    EXPECT_EQ(m_list->GetMaxScrollOffset(), 0);
+
+    m_list->SetRowCount(ROW_COUNT);
+    m_list->ScrollTo(ROW_COUNT * ROW_HEIGHT);
+    m_list->Update();
+    EXPECT_EQ(m_list->GetScrollOffset(), ROW_COUNT * ROW_HEIGHT - 400);
+    EXPECT_NE(m_list->GetRowElement(ROW_COUNT - 1), nullptr);
+
+    m_container->properties.height = 200;
+    m_list->Update();
+    EXPECT_EQ(m_list->GetMaterializedRowCount(), size_t(19));
+    EXPECT_EQ(m_container->GetAllChildren().size(), size_t(19));
+    EXPECT_NE(m_list->GetRowElement(m_list->GetFirstVisibleRow()), nullptr);
+
+    m_container->properties.height = 2000;
+    EXPECT_THROW(m_list->Update(), std::runtime_error);
+}
@@ -0,0 +1,92 @@
+#include "block_pool.h"
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+
+BlockPool::BlockPool(size_t blockSize, size_t blocksPerSlab)
+    : m_blockSize(std::max(blockSize, sizeof(FreeBlock)))
+    , m_blocksPerSlab(blocksPerSlab)
+    , m_usedBlocks(0)
+    , m_freeList(nullptr)
+{
+    // every block has to be usable for any type, round size up to the max alignment
+    constexpr auto alignment = alignof(std::max_align_t);
+    m_blockSize = (m_blockSize + alignment - 1) / alignment * alignment;
+}
+
+auto BlockPool::Allocate() -> void*
+{
+    const auto lock = std::scoped_lock(m_mutex);
+
+    if (m_freeList == nullptr) {
+        AddSlab();
+    }
+
+    auto* block = m_freeList;
+    m_freeList = block->next;
+    m_usedBlocks++;
+
+    return block;
+}
+
+void BlockPool::Deallocate(void* block)
+{
+    if (block == nullptr) {
+        return;
+    }
+
+    const auto lock = std::scoped_lock(m_mutex);
+    assert(m_usedBlocks > 0);
+
+    auto* freeBlock = static_cast<FreeBlock*>(block);
+    freeBlock->next = m_freeList;
+    m_freeList = freeBlock;
+    m_usedBlocks--;
+}
+
+void BlockPool::Reserve(size_t blockCount)
+{
+    const auto lock = std::scoped_lock(m_mutex);
+
+    auto freeBlocks = m_slabs.size() * m_blocksPerSlab - m_usedBlocks;
+    while (freeBlocks < blockCount) {
+        AddSlab();
+        freeBlocks += m_blocksPerSlab;
+    }
+}
+
+auto BlockPool::GetUsedBlocks() const -> size_t
+{
+    const auto lock = std::scoped_lock(m_mutex);
+    return m_usedBlocks;
+}
+
+auto BlockPool::GetSlabCount() const -> size_t
+{
+    const auto lock = std::scoped_lock(m_mutex);
+    return m_slabs.size();
+}
+
+auto BlockPool::GetBlockSize() const -> size_t
+{
+    return m_blockSize;
+}
+
+auto BlockPool::GetReservedBytes() const -> size_t
+{
+    const auto lock = std::scoped_lock(m_mutex);
+    return m_slabs.size() * m_blocksPerSlab * m_blockSize;
+}
+
+void BlockPool::AddSlab()
+{
+    // operator new[] of std::byte is aligned to __STDCPP_DEFAULT_NEW_ALIGNMENT__
+    auto& slab = m_slabs.emplace_back(std::make_unique_for_overwrite<std::byte[]>(m_blockSize * m_blocksPerSlab));
+
+    // blocks are linked in address order so fresh allocations walk the slab forward
+    for (size_t i = m_blocksPerSlab; i > 0; i--) {
+        auto* block = reinterpret_cast<FreeBlock*>(slab.get() + (i - 1) * m_blockSize);
+        block->next = m_freeList;
+        m_freeList = block;
+    }
+}
@@ -0,0 +1,228 @@
+#include "bui_binary.h"
+#include "mapped_file.h"
+#include "types.h"
+#include "uielement.h"
+#include <cstring>
+#include <deque>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+auto ToBinaryProperties(const Properties& properties) -> BuiBinaryProperties
+{
+    auto binary = BuiBinaryProperties{};
+    binary.width = properties.width;
+    binary.height = properties.height;
+    binary.border_radius_px = properties.border_radius_px;
+    binary.border_width = properties.border_width;
+    binary.position_x = properties.position.x;
+    binary.position_y = properties.position.y;
+    binary.color[0] = properties.color.red;
+    binary.color[1] = properties.color.green;
+    binary.color[2] = properties.color.blue;
+    binary.color[3] = properties.color.alpha;
+    binary.border = properties.border;
+    binary.hidden = properties.hidden;
+    binary.layout_children = static_cast<uint8_t>(properties.layout_children);
+    binary.clip_children = properties.clip_children;
+
+    return binary;
+}
+
+auto FromBinaryProperties(const BuiBinaryProperties& binary) -> Properties
+{
+    auto properties = Properties{};
+    properties.width = binary.width;
+    properties.height = binary.height;
+    properties.border_radius_px = binary.border_radius_px;
+    properties.border_width = binary.border_width;
+    properties.position = {binary.position_x, binary.position_y};
+    properties.color = {binary.color[0], binary.color[1], binary.color[2], binary.color[3]};
+    properties.border = binary.border != 0;
+    properties.hidden = binary.hidden != 0;
+    properties.layout_children = static_cast<LayoutDirection>(binary.layout_children);
+    properties.clip_children = binary.clip_children != 0;
+
+    return properties;
+}
+
+template <typename T> void Append(std::vector<std::byte>& out, const T& value)
+{
+    const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T> auto ReadAt(std::span<const std::byte> data, size_t offset) -> T
+{
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+auto CompileBui(const BuiDocument& document) -> std::vector<std::byte>
+{
+    auto elements = std::vector<BuiBinaryElement>{};
+    elements.reserve(document.elements.size());
+
+    auto strings = std::string{};
+    auto stringOffsets = std::unordered_map<std::string_view, uint32_t>{};
+    auto generatedNames = std::deque<std::string>{};
+    auto nameBuffer = std::string{};
+
+    auto propertyBlob = std::vector<std::byte>{};
+    auto propertyOffsets = std::unordered_map<std::string, uint32_t>{};
+
+    for (const auto& source : document.elements) {
+        auto element = BuiBinaryElement{};
+        element.parent = source.parent;
+        element.type = static_cast<uint8_t>(source.type);
+        element.sizeFlags = source.sizeFlags;
+
+        // generated names are owned by the table itself, document names are views into its source
+        const auto index = static_cast<uint32_t>(elements.size());
+        auto name = GetBuiElementName(document, index, nameBuffer);
+        if (source.name.empty()) {
+            name = generatedNames.emplace_back(name);
+        }
+        const auto [nameIt, newName] = stringOffsets.try_emplace(name, static_cast<uint32_t>(strings.size()));
+        if (newName) {
+            strings.append(name);
+        }
+        element.nameOffset = nameIt->second;
+        element.nameLength = static_cast<uint32_t>(name.size());
+
+        // identical property records are stored only once
+        const auto binaryProperties = ToBinaryProperties(source.properties);
+        const auto recordKey =
+            std::string(reinterpret_cast<const char*>(&binaryProperties), sizeof(BuiBinaryProperties));
+        const auto [propertyIt, newRecord] =
+            propertyOffsets.try_emplace(recordKey, static_cast<uint32_t>(propertyBlob.size()));
+        if (newRecord) {
+            Append(propertyBlob, binaryProperties);
+        }
+
+        const auto propertyOffset = propertyIt->second;
+        element.propertyOffset = propertyOffset;
+        elements.push_back(element);
+    }
+
+    auto header = BuiBinaryHeader{};
+    header.magic = BUI_BINARY_MAGIC;
+    header.version = BUI_BINARY_VERSION;
+    header.elementCount = static_cast<uint32_t>(elements.size());
+    header.elementTableOffset = sizeof(BuiBinaryHeader);
+    header.stringTableOffset = header.elementTableOffset + header.elementCount * sizeof(BuiBinaryElement);
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+    header.propertyBlobOffset = (header.stringTableOffset + header.stringTableSize + 3) & ~uint32_t(3);
+    header.propertyBlobSize = static_cast<uint32_t>(propertyBlob.size());
+
+    auto out = std::vector<std::byte>{};
+    out.reserve(header.propertyBlobOffset + header.propertyBlobSize);
+
+    Append(out, header);
+    for (const auto& element : elements) {
+        Append(out, element);
+    }
+
+    const auto* stringBytes = reinterpret_cast<const std::byte*>(strings.data());
+    out.insert(out.end(), stringBytes, stringBytes + strings.size());
+    out.resize(header.propertyBlobOffset);
+    out.insert(out.end(), propertyBlob.begin(), propertyBlob.end());
+
+    return out;
+}
+
+void WriteCompiledBui(const BuiDocument& document, const std::filesystem::path& path)
+{
+    const auto compiled = CompileBui(document);
+
+    auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("Could not open {} for writing", path.string()));
+    }
+
+    file.write(reinterpret_cast<const char*>(compiled.data()), static_cast<std::streamsize>(compiled.size()));
+    if (!file) {
+        throw std::runtime_error(std::format("Could not write compiled layout to {}", path.string()));
+    }
+}
+
+void LoadCompiledBui(std::span<const std::byte> data, UiTree& uiTree)
+{
+    if (data.size() < sizeof(BuiBinaryHeader)) {
+        throw std::runtime_error("Compiled layout - file too small for header");
+    }
+
+    const auto header = ReadAt<BuiBinaryHeader>(data, 0);
+    if (header.magic != BUI_BINARY_MAGIC) {
+        throw std::runtime_error("Compiled layout - invalid magic");
+    }
+
+    if (header.version != BUI_BINARY_VERSION) {
+        throw std::runtime_error(std::format("Compiled layout - unsupported version, expected - {}, real - {}",
+                                             BUI_BINARY_VERSION, header.version));
+    }
+
+    const auto elementTableEnd =
+        size_t(header.elementTableOffset) + size_t(header.elementCount) * sizeof(BuiBinaryElement);
+    if (elementTableEnd > data.size() ||
+        size_t(header.stringTableOffset) + header.stringTableSize > data.size() ||
+        size_t(header.propertyBlobOffset) + header.propertyBlobSize > data.size()) {
+        throw std::runtime_error("Compiled layout - section out of file bounds");
+    }
+
+    const auto strings = std::string_view(reinterpret_cast<const char*>(data.data()) + header.stringTableOffset,
+                                          header.stringTableSize);
+
+    auto elements = std::vector<std::unique_ptr<UiElement>>{};
+    auto parents = std::vector<uint32_t>{};
+    elements.reserve(header.elementCount);
+    parents.reserve(header.elementCount);
+
+    for (uint32_t i = 0; i < header.elementCount; i++) {
+        const auto element =
+            ReadAt<BuiBinaryElement>(data, header.elementTableOffset + size_t(i) * sizeof(BuiBinaryElement));
+
+        if (element.parent != BUI_NO_PARENT && element.parent >= i) {
+            throw std::runtime_error(std::format("Compiled layout - element {} has invalid parent", i));
+        }
+
+        if (size_t(element.nameOffset) + element.nameLength > strings.size() ||
+            size_t(element.propertyOffset) + sizeof(BuiBinaryProperties) > header.propertyBlobSize) {
+            throw std::runtime_error(std::format("Compiled layout - element {} points out of bounds", i));
+        }
+
+        const auto* parent = element.parent == BUI_NO_PARENT ? uiTree.GetRoot() : elements[element.parent].get();
+
+        auto uiElement = std::make_unique<UiElement>(strings.substr(element.nameOffset, element.nameLength),
+                                                     static_cast<ElemType>(element.type));
+        uiElement->properties = FromBinaryProperties(
+            ReadAt<BuiBinaryProperties>(data, size_t(header.propertyBlobOffset) + element.propertyOffset));
+
+        if (element.sizeFlags & BUI_WIDTH_MAX) {
+            uiElement->properties.width = parent->properties.width;
+        }
+        if (element.sizeFlags & BUI_HEIGHT_MAX) {
+            uiElement->properties.height = parent->properties.height;
+        }
+
+        elements.emplace_back(std::move(uiElement));
+        parents.push_back(element.parent);
+    }
+
+    AttachBuiElements(elements, parents, uiTree.GetRoot());
+}
+
+void LoadCompiledBuiFile(const std::filesystem::path& path, UiTree& uiTree)
+{
+    const auto file = MappedFile(path);
+    LoadCompiledBui(file.GetData(), uiTree);
+}
@@ -0,0 +1,235 @@
+#include "bui_diff.h"
+#include "uielement.h"
+#include "uitree_transaction.h"
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+auto ResolveProperties(const BuiElement& element, const Properties& parentProperties) -> Properties
+{
+    auto properties = element.properties;
+    if (element.sizeFlags & BUI_WIDTH_MAX) {
+        properties.width = parentProperties.width;
+    }
+    if (element.sizeFlags & BUI_HEIGHT_MAX) {
+        properties.height = parentProperties.height;
+    }
+
+    return properties;
+}
+
+} // namespace
+
+auto ApplyLayoutDiff(const BuiDocument& previous, const BuiDocument& next, UiTree& uiTree) -> LayoutDiffStats
+{
+    auto stats = LayoutDiffStats{};
+    auto* root = uiTree.GetRoot();
+    const auto count = static_cast<uint32_t>(next.elements.size());
+
+    // elements the previous layout created, found by following its structure down from the root,
+    // so elements created from code are never taken for layout ones even when they share a name
+    const auto previousCount = static_cast<uint32_t>(previous.elements.size());
+    auto previousChildren = std::vector<std::vector<uint32_t>>(previousCount + 1);
+    for (uint32_t i = 0; i < previousCount; i++) {
+        const auto parent = previous.elements[i].parent;
+        previousChildren[parent == BUI_NO_PARENT ? previousCount : parent].push_back(i);
+    }
+
+    // sizes taken from the parent are resolved for both layouts, so a max sized child follows its parent
+    auto previousResolved = std::vector<Properties>(previousCount);
+    for (uint32_t i = 0; i < previousCount; i++) {
+        const auto parent = previous.elements[i].parent;
+        previousResolved[i] = ResolveProperties(
+            previous.elements[i], parent == BUI_NO_PARENT ? root->properties : previousResolved[parent]);
+    }
+
+    auto previousLive = std::vector<UiElement*>(previousCount, nullptr);
+    auto nameBuffer = std::string{};
+    auto liveChildren = std::vector<UiElement*>{};
+    auto taken = std::vector<bool>{};
+
+    // parents come before their children in pre-order, the root slot is the last one
+    for (uint32_t step = 0; step <= previousCount; step++) {
+        const auto slot = step == 0 ? previousCount : step - 1;
+        auto* parent = slot == previousCount ? root : previousLive[slot];
+        if (parent == nullptr || previousChildren[slot].empty()) {
+            continue;
+        }
+
+        liveChildren = parent->GetAllChildren();
+        taken.assign(liveChildren.size(), false);
+
+        // declared order holds unless code reordered the children, the search wraps around then
+        size_t cursor = 0;
+        for (const auto index : previousChildren[slot]) {
+            const auto id = FindElementId(GetBuiElementName(previous, index, nameBuffer));
+            if (!id.has_value()) {
+                continue;
+            }
+
+            for (size_t offset = 0; offset < liveChildren.size(); offset++) {
+                const auto candidate = (cursor + offset) % liveChildren.size();
+                auto* child = liveChildren[candidate];
+                if (!taken[candidate] && child->GetId() == *id &&
+                    child->GetElementType() == previous.elements[index].type) {
+                    taken[candidate] = true;
+                    previousLive[index] = child;
+                    cursor = candidate + 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    // keys are views into the previous source, only generated names are stored
+    auto previousByName = std::unordered_map<std::string_view, uint32_t>{};
+    auto generatedNames = std::deque<std::string>{};
+    previousByName.reserve(previousCount);
+    for (uint32_t i = 0; i < previousCount; i++) {
+        if (previousLive[i] == nullptr) {
+            continue;
+        }
+
+        const auto name = GetBuiElementName(previous, i, nameBuffer);
+        previousByName.try_emplace(previous.elements[i].name.empty() ? generatedNames.emplace_back(name) : name, i);
+    }
+
+    auto transaction = uiTree.BeginTransaction();
+
+    // element in the tree (matched or newly created) for every element of next layout
+    auto targets = std::vector<UiElement*>(count, nullptr);
+    auto resolved = std::vector<Properties>(count);
+    auto matched = std::unordered_set<UiElement*>{};
+    auto movedAway = std::unordered_set<UiElement*>{};
+
+    // children lists of next layout, last slot is the tree root
+    auto docChildren = std::vector<std::vector<uint32_t>>(count + 1);
+
+    for (uint32_t i = 0; i < count; i++) {
+        const auto& element = next.elements[i];
+        const auto name = GetBuiElementName(next, i, nameBuffer);
+
+        const auto parentSlot = element.parent == BUI_NO_PARENT ? count : element.parent;
+        auto* parent = element.parent == BUI_NO_PARENT ? root : targets[element.parent];
+        const auto& parentProperties = element.parent == BUI_NO_PARENT ? root->properties : resolved[element.parent];
+        docChildren[parentSlot].push_back(i);
+
+        resolved[i] = ResolveProperties(element, parentProperties);
+
+        // duplicate names in the layout match only once, the rest is created
+        const auto declared = previousByName.find(name);
+        auto* live = declared != previousByName.end() ? previousLive[declared->second] : nullptr;
+        if (live == nullptr || live->GetElementType() != element.type || matched.contains(live)) {
+            auto created = std::make_unique<UiElement>(name, element.type);
+            created->properties = resolved[i];
+            targets[i] = created.get();
+
+            transaction.AddChild(parent, std::move(created));
+            stats.inserted++;
+            continue;
+        }
+
+        auto* target = live;
+        targets[i] = target;
+        matched.insert(target);
+
+        bool changed = false;
+        if (resolved[i] != previousResolved[declared->second]) {
+            transaction.SetProperties(target, resolved[i]);
+            stats.updated++;
+            changed = true;
+        }
+
+        if (target->GetParent() != parent) {
+            transaction.MoveChild(target, parent);
+            movedAway.insert(target);
+            stats.moved++;
+            changed = true;
+        }
+
+        if (!changed) {
+            stats.unchanged++;
+        }
+    }
+
+    // elements declared before but gone now, descendants of a removed element go with it. Matched
+    // descendants were given a new parent above, moves are applied before removals
+    auto removed = std::unordered_set<UiElement*>{};
+    auto insideRemoved = std::vector<bool>(previousCount, false);
+    for (uint32_t i = 0; i < previousCount; i++) {
+        const auto parent = previous.elements[i].parent;
+        const auto hasRemovedAncestor = parent != BUI_NO_PARENT && insideRemoved[parent];
+
+        auto* live = previousLive[i];
+        const auto gone = live != nullptr && !matched.contains(live);
+        insideRemoved[i] = hasRemovedAncestor || gone;
+
+        if (gone) {
+            removed.insert(live);
+            if (!hasRemovedAncestor) {
+                transaction.RemoveChild(live);
+                stats.removed++;
+            }
+        }
+    }
+
+    // compare order the parent ends up with after the transaction to the declared one,
+    // children not coming from the layout stay behind the declared ones
+    auto predicted = std::vector<UiElement*>{};
+    auto desired = std::vector<UiElement*>{};
+    for (uint32_t slot = 0; slot <= count; slot++) {
+        auto* parent = slot == count ? root : targets[slot];
+        if (docChildren[slot].empty() && !matched.contains(parent)) {
+            continue;
+        }
+
+        predicted.clear();
+        desired.clear();
+
+        for (const auto& index : docChildren[slot]) {
+            desired.push_back(targets[index]);
+        }
+
+        if (parent == root || matched.contains(parent)) {
+            for (auto* child : parent->GetAllChildren()) {
+                if (removed.contains(child) || (movedAway.contains(child) && child->GetParent() == parent)) {
+                    continue;
+                }
+
+                predicted.push_back(child);
+                if (!matched.contains(child)) {
+                    desired.push_back(child);
+                }
+            }
+        }
+
+        // moved in children are appended first, newly created ones after them
+        for (const auto& index : docChildren[slot]) {
+            auto* child = targets[index];
+            if (movedAway.contains(child)) {
+                predicted.push_back(child);
+            }
+        }
+
+        for (const auto& index : docChildren[slot]) {
+            auto* child = targets[index];
+            if (!matched.contains(child)) {
+                predicted.push_back(child);
+            }
+        }
+
+        if (predicted != desired) {
+            transaction.ReorderChildren(parent, desired);
+            stats.reordered++;
+        }
+    }
+
+    transaction.Commit();
+    return stats;
+}
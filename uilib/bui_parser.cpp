@@ -0,0 +1,392 @@
+#include "bui_parser.h"
+#include "mapped_file.h"
+#include "types.h"
+#include "uielement.h"
+#include <cassert>
+#include <charconv>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct OpenElement {
+    size_t indent;
+    uint32_t index;
+    size_t children;
+};
+
+// Position in the source, the whole file is walked exactly once
+class BuiCursor {
+  public:
+    explicit BuiCursor(std::string_view source)
+        : m_pos(source.data())
+        , m_end(source.data() + source.size())
+        , m_lineStart(source.data())
+        , m_line(1)
+    {
+    }
+
+    bool AtEnd() const { return m_pos == m_end; }
+
+    auto Peek() const -> char { return *m_pos; }
+
+    auto Column(const char* at) const -> size_t { return static_cast<size_t>(at - m_lineStart) + 1; }
+
+    auto Position() const -> const char* { return m_pos; }
+
+    auto Line() const -> size_t { return m_line; }
+
+    // Skips spaces and tabs, returns the number of skipped characters
+    auto SkipBlanks() -> size_t
+    {
+        const auto* start = m_pos;
+        while (m_pos != m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r')) {
+            m_pos++;
+        }
+
+        return static_cast<size_t>(m_pos - start);
+    }
+
+    bool AtLineEnd() const { return m_pos == m_end || *m_pos == '\n' || IsComment(); }
+
+    bool IsComment() const { return m_end - m_pos >= 2 && m_pos[0] == '/' && m_pos[1] == '/'; }
+
+    // Moves to the beginning of the next line, skipping anything left on this one
+    void NextLine()
+    {
+        while (m_pos != m_end && *m_pos != '\n') {
+            m_pos++;
+        }
+
+        if (m_pos != m_end) {
+            m_pos++;
+            m_line++;
+            m_lineStart = m_pos;
+        }
+    }
+
+    // Reads characters until one of the stop characters, blanks or comment, returns view into source
+    auto ReadToken(char stop) -> std::string_view
+    {
+        const auto* start = m_pos;
+        while (m_pos != m_end && *m_pos != stop && *m_pos != '\n' && *m_pos != ' ' && *m_pos != '\t' &&
+               *m_pos != '\r' && !IsComment()) {
+            m_pos++;
+        }
+
+        return {start, static_cast<size_t>(m_pos - start)};
+    }
+
+    void Advance() { m_pos++; }
+
+    auto Error(const char* at, std::string_view message) const -> BuiParseError
+    {
+        return BuiParseError(m_line, Column(at), message);
+    }
+
+  private:
+    const char* m_pos;
+    const char* m_end;
+    const char* m_lineStart;
+    size_t m_line;
+};
+
+auto ParseNumber(const BuiCursor& cursor, std::string_view value) -> float
+{
+    const auto full = value;
+    if (value.ends_with("px")) {
+        value.remove_suffix(2);
+    }
+
+    float number = 0;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (value.empty() || error != std::errc{} || end != value.data() + value.size()) {
+        throw cursor.Error(full.data(), std::format("expected a number, got '{}'", full));
+    }
+
+    return number;
+}
+
+auto ParseBool(const BuiCursor& cursor, std::string_view value) -> bool
+{
+    if (value == "true") {
+        return true;
+    }
+
+    if (value == "false") {
+        return false;
+    }
+
+    throw cursor.Error(value.data(), std::format("expected true or false, got '{}'", value));
+}
+
+auto ParseHexByte(const BuiCursor& cursor, std::string_view value) -> uint8_t
+{
+    uint8_t byte = 0;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), byte, 16);
+    if (error != std::errc{} || end != value.data() + value.size()) {
+        throw cursor.Error(value.data(), std::format("invalid color component '{}'", value));
+    }
+
+    return byte;
+}
+
+auto ParseColor(const BuiCursor& cursor, std::string_view value) -> Color
+{
+    if (!value.starts_with('#') || (value.size() != 7 && value.size() != 9)) {
+        throw cursor.Error(value.data(), std::format("expected color as #rrggbb or #rrggbbaa, got '{}'", value));
+    }
+
+    Color color;
+    color.red = ParseHexByte(cursor, value.substr(1, 2));
+    color.green = ParseHexByte(cursor, value.substr(3, 2));
+    color.blue = ParseHexByte(cursor, value.substr(5, 2));
+    if (value.size() == 9) {
+        color.alpha = ParseHexByte(cursor, value.substr(7, 2));
+    }
+
+    return color;
+}
+
+void ParseProperty(const BuiCursor& cursor, BuiElement& element, std::string_view key, std::string_view value)
+{
+    auto& properties = element.properties;
+
+    if (key == "width") {
+        if (value == "max") {
+            element.sizeFlags |= BUI_WIDTH_MAX;
+        }
+        else {
+            properties.width = ParseNumber(cursor, value);
+        }
+    }
+    else if (key == "height") {
+        if (value == "max") {
+            element.sizeFlags |= BUI_HEIGHT_MAX;
+        }
+        else {
+            properties.height = ParseNumber(cursor, value);
+        }
+    }
+    else if (key == "layout") {
+        if (value == "horizontal") {
+            properties.layout_children = LayoutDirection::Horizontal;
+        }
+        else if (value == "vertical") {
+            properties.layout_children = LayoutDirection::Vertical;
+        }
+        else {
+            throw cursor.Error(value.data(), std::format("layout can be vertical or horizontal, got '{}'", value));
+        }
+    }
+    else if (key == "border") {
+        properties.border_width = ParseNumber(cursor, value);
+        properties.border = properties.border_width > 0;
+    }
+    else if (key == "radius") {
+        properties.border_radius_px = ParseNumber(cursor, value);
+    }
+    else if (key == "visible") {
+        properties.hidden = !ParseBool(cursor, value);
+    }
+    else if (key == "clip") {
+        properties.clip_children = ParseBool(cursor, value);
+    }
+    else if (key == "bg-color") {
+        properties.color = ParseColor(cursor, value);
+    }
+    else {
+        throw cursor.Error(key.data(), std::format("unknown property '{}'", key));
+    }
+}
+
+} // namespace
+
+BuiParseError::BuiParseError(size_t line, size_t column, std::string_view message)
+    : std::runtime_error(std::format("bui: line {}, column {}: {}", line, column, message))
+    , m_line(line)
+    , m_column(column)
+{
+}
+
+auto BuiParseError::GetLine() const -> size_t
+{
+    return m_line;
+}
+
+auto BuiParseError::GetColumn() const -> size_t
+{
+    return m_column;
+}
+
+auto ParseBui(std::string_view source) -> BuiDocument
+{
+    BuiDocument document;
+    std::vector<OpenElement> openElements;
+    auto cursor = BuiCursor(source);
+
+    // rough guess of one element per 64 bytes of source, avoids most regrowth on big files
+    document.elements.reserve(source.size() / 64);
+
+    for (; !cursor.AtEnd(); cursor.NextLine()) {
+        const auto indent = cursor.SkipBlanks();
+        if (cursor.AtLineEnd()) {
+            continue;
+        }
+
+        const auto* keyStart = cursor.Position();
+        const auto key = cursor.ReadToken(':');
+        cursor.SkipBlanks();
+
+        if (cursor.AtEnd() || cursor.Peek() != ':') {
+            throw cursor.Error(keyStart, std::format("expected 'key: value' after '{}'", key));
+        }
+
+        cursor.Advance();
+        cursor.SkipBlanks();
+        const auto value = cursor.ReadToken('\n');
+        cursor.SkipBlanks();
+
+        if (!cursor.AtLineEnd()) {
+            throw cursor.Error(cursor.Position(), std::format("unexpected text after value '{}'", value));
+        }
+
+        while (!openElements.empty() && openElements.back().indent >= indent) {
+            openElements.pop_back();
+        }
+
+        if (key == "Element" || key == "Text") {
+            if (openElements.empty() && !document.elements.empty()) {
+                throw cursor.Error(keyStart, "only one top level element is allowed");
+            }
+
+            if (!openElements.empty() && ++openElements.back().children > MAX_CHILDREN) {
+                auto nameBuffer = std::string();
+                const auto parentName = GetBuiElementName(document, openElements.back().index, nameBuffer);
+                throw cursor.Error(keyStart,
+                                   std::format("too many children for {}, max - {}", parentName, MAX_CHILDREN));
+            }
+
+            const auto index = static_cast<uint32_t>(document.elements.size());
+
+            auto& element = document.elements.emplace_back();
+            element.parent = openElements.empty() ? BUI_NO_PARENT : openElements.back().index;
+            element.type = key == "Text" ? ElemType::Text : ElemType::Box;
+            element.name = value;
+
+            openElements.push_back({indent, index, 0});
+            continue;
+        }
+
+        if (openElements.empty()) {
+            throw cursor.Error(keyStart, std::format("property '{}' outside of an element", key));
+        }
+
+        if (value.empty()) {
+            throw cursor.Error(cursor.Position(), std::format("property '{}' has no value", key));
+        }
+
+        ParseProperty(cursor, document.elements[openElements.back().index], key, value);
+    }
+
+    return document;
+}
+
+auto LoadBuiFile(const std::filesystem::path& path) -> BuiDocument
+{
+    auto file = MappedFile(path);
+    auto document = ParseBui(file.GetView());
+
+    // moving the mapping keeps the mapped address, so parsed views stay valid
+    document.source.emplace(std::move(file));
+    return document;
+}
+
+auto GetBuiElementName(const BuiDocument& document, uint32_t index, std::string& buffer) -> std::string_view
+{
+    const auto name = document.elements[index].name;
+    if (!name.empty()) {
+        return name;
+    }
+
+    // reuses the capacity of buffer, names are generated for every unnamed element of big layouts
+    char digits[16];
+    const auto [digitsEnd, error] = std::to_chars(std::begin(digits), std::end(digits), index);
+    buffer.assign("element-");
+    buffer.append(digits, digitsEnd);
+    return buffer;
+}
+
+void AttachBuiElements(std::vector<std::unique_ptr<UiElement>>& elements, std::span<const uint32_t> parents,
+                       UiElement* root)
+{
+    assert(elements.size() == parents.size());
+
+    // group children by parent first, so every parent is rearranged only once
+    auto created = std::vector<UiElement*>(elements.size(), nullptr);
+    auto children = std::vector<std::vector<std::unique_ptr<UiElement>>>(elements.size() + 1);
+    const auto rootSlot = elements.size();
+
+    for (size_t i = 0; i < elements.size(); i++) {
+        assert(parents[i] == BUI_NO_PARENT || parents[i] < i);
+
+        created[i] = elements[i].get();
+        const auto slot = parents[i] == BUI_NO_PARENT ? rootSlot : parents[i];
+        children[slot].emplace_back(std::move(elements[i]));
+    }
+
+    // checked before anything is attached, compiled layouts are not validated by the parser
+    for (size_t i = 0; i <= rootSlot; i++) {
+        const auto* parent = i == rootSlot ? root : created[i];
+        const auto count = children[i].size() + (i == rootSlot ? root->GetAllChildren().size() : 0);
+        if (count > MAX_CHILDREN) {
+            throw std::runtime_error(std::format("Bui layout - too many children for {}, max - {}, real - {}",
+                                                 parent->GetName(), MAX_CHILDREN, count));
+        }
+    }
+
+    // pre-order makes parents positioned before their own children are laid out
+    root->AddChildren(std::move(children[rootSlot]));
+    for (size_t i = 0; i < rootSlot; i++) {
+        if (!children[i].empty()) {
+            created[i]->AddChildren(std::move(children[i]));
+        }
+    }
+
+    elements.clear();
+}
+
+void BuildUiTree(const BuiDocument& document, UiTree& uiTree)
+{
+    const auto count = document.elements.size();
+
+    auto elements = std::vector<std::unique_ptr<UiElement>>{};
+    auto parents = std::vector<uint32_t>{};
+    auto nameBuffer = std::string{};
+    elements.reserve(count);
+    parents.reserve(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        const auto& source = document.elements[i];
+        const auto* parent = source.parent == BUI_NO_PARENT ? uiTree.GetRoot() : elements[source.parent].get();
+
+        auto element = std::make_unique<UiElement>(GetBuiElementName(document, i, nameBuffer), source.type);
+        element->properties = source.properties;
+        if (source.sizeFlags & BUI_WIDTH_MAX) {
+            element->properties.width = parent->properties.width;
+        }
+        if (source.sizeFlags & BUI_HEIGHT_MAX) {
+            element->properties.height = parent->properties.height;
+        }
+
+        elements.emplace_back(std::move(element));
+        parents.push_back(source.parent);
+    }
+
+    AttachBuiElements(elements, parents, uiTree.GetRoot());
+}
@@ -0,0 +1,111 @@
+#include "bui_watcher.h"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+BuiHotReload::BuiHotReload(const std::filesystem::path& path, UiTree& uiTree)
+    : m_path(std::filesystem::absolute(path))
+    , m_uiTree(&uiTree)
+    , m_inotifyFd(-1)
+{
+    m_source = ReadSource();
+    m_document = ParseBui(*m_source);
+    BuildUiTree(m_document, *m_uiTree);
+
+    m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+        throw std::runtime_error(std::format("Could not initialize inotify - {}", std::strerror(errno)));
+    }
+
+    // the directory is watched, since saving through a temporary file replaces the watched inode,
+    // creating or truncating the file is not a finished write and is ignored
+    const auto directory = m_path.parent_path();
+    if (::inotify_add_watch(m_inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        ::close(m_inotifyFd);
+        throw std::runtime_error(std::format("Could not watch {} - {}", directory.string(), std::strerror(errno)));
+    }
+}
+
+BuiHotReload::~BuiHotReload()
+{
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+    }
+}
+
+auto BuiHotReload::Poll() -> std::optional<LayoutDiffStats>
+{
+    m_lastError.clear();
+
+    alignas(inotify_event) std::array<char, 4096> buffer;
+    const auto fileName = m_path.filename().string();
+
+    bool changed = false;
+    while (true) {
+        const auto length = ::read(m_inotifyFd, buffer.data(), buffer.size());
+        if (length <= 0) {
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+            if (event->len > 0 && fileName == event->name) {
+                changed = true;
+            }
+
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+
+    if (!changed) {
+        return std::nullopt;
+    }
+
+    return Reload();
+}
+
+auto BuiHotReload::Reload() -> std::optional<LayoutDiffStats>
+{
+    try {
+        auto source = ReadSource();
+        auto document = ParseBui(*source);
+
+        // a file caught while an editor rewrites it would remove every layout element
+        if (document.elements.empty()) {
+            throw std::runtime_error(std::format("Layout {} is empty, keeping the current tree", m_path.string()));
+        }
+        const auto stats = ApplyLayoutDiff(m_document, document, *m_uiTree);
+
+        // heap buffer of the source does not move, so views in the document stay valid
+        m_source = std::move(source);
+        m_document = std::move(document);
+        m_lastError.clear();
+
+        return stats;
+    }
+    catch (const std::runtime_error& error) {
+        m_lastError = error.what();
+        return std::nullopt;
+    }
+}
+
+auto BuiHotReload::GetLastError() const -> const std::string&
+{
+    return m_lastError;
+}
+
+auto BuiHotReload::ReadSource() const -> std::unique_ptr<const std::string>
+{
+    auto file = std::ifstream(m_path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error(std::format("Could not open {}", m_path.string()));
+    }
+
+    return std::make_unique<const std::string>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
@@ -0,0 +1,317 @@
+#include "compressed_series.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <format>
+#include <stdexcept>
+
+namespace {
+
+// Timestamp delta of delta classes after the leading 0 bit of an unchanged delta, the zigzag
+// encoded value has to fit the payload
+struct DeltaCode {
+    uint64_t prefix;
+    uint32_t prefixBits;
+    uint32_t payloadBits;
+};
+
+constexpr auto DELTA_CODES = std::array<DeltaCode, 4>{
+    DeltaCode{0b10, 2, 7},
+    DeltaCode{0b110, 3, 9},
+    DeltaCode{0b1110, 4, 12},
+    DeltaCode{0b1111, 4, 64},
+};
+
+// Bits are appended most significant first
+void WriteBits(std::vector<uint64_t>& words, uint64_t& bitCount, uint64_t value, uint32_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    if (count < 64) {
+        value &= (uint64_t(1) << count) - 1;
+    }
+
+    const auto used = static_cast<uint32_t>(bitCount % 64);
+    if (used == 0) {
+        words.push_back(0);
+    }
+
+    const auto available = 64 - used;
+    if (count <= available) {
+        words.back() |= value << (available - count);
+    }
+    else {
+        const auto rest = count - available;
+        words.back() |= value >> rest;
+        words.push_back(value << (64 - rest));
+    }
+    bitCount += count;
+}
+
+class BitReader {
+  public:
+    explicit BitReader(std::span<const uint64_t> words)
+        : m_words(words)
+        , m_position(0)
+    {
+    }
+
+    auto Read(uint32_t count) -> uint64_t
+    {
+        if (count == 0) {
+            return 0;
+        }
+
+        const auto word = m_position / 64;
+        const auto used = static_cast<uint32_t>(m_position % 64);
+        const auto available = 64 - used;
+        m_position += count;
+
+        const auto high = (m_words[word] << used) >> (64 - count);
+        if (count <= available) {
+            return high;
+        }
+        return high | (m_words[word + 1] >> (64 - (count - available)));
+    }
+
+  private:
+    std::span<const uint64_t> m_words;
+    uint64_t m_position;
+};
+
+// Wrapping arithmetic, deltas of timestamps far apart must not overflow
+auto WrappingSub(int64_t a, int64_t b) -> int64_t
+{
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+
+auto WrappingAdd(int64_t a, int64_t b) -> int64_t
+{
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+auto ZigZag(int64_t value) -> uint64_t
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+auto UnZigZag(uint64_t value) -> int64_t
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace
+
+CompressedSeries::CompressedSeries(uint32_t samplesPerBlock, size_t cachedBlocks)
+    : m_samplesPerBlock(samplesPerBlock)
+    , m_blocks()
+    , m_sampleCount(0)
+    , m_encoder()
+    , m_cache(cachedBlocks)
+    , m_useCounter(0)
+    , m_stats()
+{
+    if (samplesPerBlock == 0 || cachedBlocks == 0) {
+        throw std::runtime_error(std::format("Compressed series needs blocks and cache, block size - {}, cached - {}",
+                                             samplesPerBlock, cachedBlocks));
+    }
+}
+
+void CompressedSeries::Append(int64_t timestamp, double value)
+{
+    if (m_sampleCount > 0 && timestamp < m_encoder.timestamp) {
+        throw std::runtime_error(std::format("Compressed series - timestamp {} is lower than the last one - {}",
+                                             timestamp, m_encoder.timestamp));
+    }
+
+    const auto bits = std::bit_cast<uint64_t>(value);
+
+    if (m_blocks.empty() || m_blocks.back().sampleCount == m_samplesPerBlock) {
+        if (!m_blocks.empty()) {
+            m_blocks.back().words.shrink_to_fit();
+        }
+
+        // first sample of a block is stored raw, blocks are decoded without their predecessors
+        auto& block = m_blocks.emplace_back();
+        block.firstTimestamp = timestamp;
+        WriteBits(block.words, block.bitCount, static_cast<uint64_t>(timestamp), 64);
+        WriteBits(block.words, block.bitCount, bits, 64);
+        m_encoder = {timestamp, 0, bits};
+    }
+    else {
+        auto& block = m_blocks.back();
+
+        const auto delta = WrappingSub(timestamp, m_encoder.timestamp);
+        const auto deltaOfDelta = WrappingSub(delta, m_encoder.delta);
+        if (deltaOfDelta == 0) {
+            WriteBits(block.words, block.bitCount, 0, 1);
+        }
+        else {
+            const auto encoded = ZigZag(deltaOfDelta);
+            const auto fits = [encoded](const DeltaCode& code) {
+                return code.payloadBits == 64 || encoded >> code.payloadBits == 0;
+            };
+            const auto& code = *std::ranges::find_if(DELTA_CODES, fits);
+            WriteBits(block.words, block.bitCount, code.prefix, code.prefixBits);
+            WriteBits(block.words, block.bitCount, encoded, code.payloadBits);
+        }
+
+        const auto xored = bits ^ m_encoder.value;
+        if (xored == 0) {
+            WriteBits(block.words, block.bitCount, 0, 1);
+        }
+        else {
+            const auto leading = static_cast<uint32_t>(std::countl_zero(xored));
+            const auto trailing = static_cast<uint32_t>(std::countr_zero(xored));
+
+            // changed bits inside the previous window only need the window contents
+            if (leading >= m_encoder.leadingZeros && trailing >= m_encoder.trailingZeros) {
+                WriteBits(block.words, block.bitCount, 0b10, 2);
+                WriteBits(block.words, block.bitCount, xored >> m_encoder.trailingZeros,
+                          64 - m_encoder.leadingZeros - m_encoder.trailingZeros);
+            }
+            else {
+                const auto meaningful = 64 - leading - trailing;
+                WriteBits(block.words, block.bitCount, 0b11, 2);
+                WriteBits(block.words, block.bitCount, leading, 6);
+                WriteBits(block.words, block.bitCount, meaningful - 1, 6);
+                WriteBits(block.words, block.bitCount, xored >> trailing, meaningful);
+                m_encoder.leadingZeros = leading;
+                m_encoder.trailingZeros = trailing;
+            }
+        }
+
+        m_encoder.timestamp = timestamp;
+        m_encoder.delta = delta;
+        m_encoder.value = bits;
+    }
+
+    auto& block = m_blocks.back();
+    block.lastTimestamp = timestamp;
+    block.sampleCount++;
+    m_sampleCount++;
+}
+
+void CompressedSeries::Append(std::span<const int64_t> timestamps, std::span<const double> values)
+{
+    if (timestamps.size() != values.size()) {
+        throw std::runtime_error(std::format("Compressed series - size mismatch, timestamps - {}, values - {}",
+                                             timestamps.size(), values.size()));
+    }
+
+    for (size_t i = 0; i < values.size(); i++) {
+        Append(timestamps[i], values[i]);
+    }
+}
+
+void CompressedSeries::Read(TimeRange range, std::vector<int64_t>& timestamps, std::vector<double>& values)
+{
+    timestamps.clear();
+    values.clear();
+
+    // blocks are sorted by time, only the ones overlapping the range are decoded
+    const auto first = std::ranges::lower_bound(m_blocks, range.start, {}, &Block::lastTimestamp) - m_blocks.begin();
+    for (auto block = size_t(first); block < m_blocks.size() && m_blocks[block].firstTimestamp <= range.end; block++) {
+        const auto& decoded = Decode(block);
+
+        const auto begin = std::ranges::lower_bound(decoded.timestamps, range.start) - decoded.timestamps.begin();
+        const auto end = std::ranges::upper_bound(decoded.timestamps, range.end) - decoded.timestamps.begin();
+        timestamps.insert(timestamps.end(), decoded.timestamps.begin() + begin, decoded.timestamps.begin() + end);
+        values.insert(values.end(), decoded.values.begin() + begin, decoded.values.begin() + end);
+    }
+}
+
+void CompressedSeries::Clear()
+{
+    m_blocks.clear();
+    m_sampleCount = 0;
+    m_encoder = {};
+
+    for (auto& entry : m_cache) {
+        entry.block = SIZE_MAX;
+    }
+}
+
+auto CompressedSeries::GetSampleCount() const -> uint64_t { return m_sampleCount; }
+
+auto CompressedSeries::GetBlockCount() const -> size_t { return m_blocks.size(); }
+
+auto CompressedSeries::GetCompressedBytes() const -> size_t
+{
+    auto bytes = size_t(0);
+    for (const auto& block : m_blocks) {
+        bytes += sizeof(Block) + block.words.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+auto CompressedSeries::GetCompressionRatio() const -> double
+{
+    const auto compressed = GetCompressedBytes();
+    if (compressed == 0) {
+        return 0;
+    }
+    return static_cast<double>(m_sampleCount * (sizeof(int64_t) + sizeof(double))) / static_cast<double>(compressed);
+}
+
+auto CompressedSeries::GetStats() const -> const CompressedSeriesStats& { return m_stats; }
+
+auto CompressedSeries::Decode(size_t block) -> const DecodedBlock&
+{
+    const auto& source = m_blocks[block];
+    m_useCounter++;
+
+    const auto cached = std::ranges::find(m_cache, block, &DecodedBlock::block);
+    if (cached != m_cache.end() && cached->sampleCount == source.sampleCount) {
+        cached->lastUse = m_useCounter;
+        m_stats.cacheHits++;
+        return *cached;
+    }
+
+    m_stats.cacheMisses++;
+    m_stats.decodedSamples += source.sampleCount;
+
+    // a decode of the last block from before it grew is stale and replaced in place
+    auto& entry = cached != m_cache.end() ? *cached : *std::ranges::min_element(m_cache, {}, &DecodedBlock::lastUse);
+    entry.block = block;
+    entry.sampleCount = source.sampleCount;
+    entry.lastUse = m_useCounter;
+    entry.timestamps.resize(source.sampleCount);
+    entry.values.resize(source.sampleCount);
+
+    auto reader = BitReader(source.words);
+    auto state = CodecState{};
+    state.timestamp = static_cast<int64_t>(reader.Read(64));
+    state.value = reader.Read(64);
+    entry.timestamps[0] = state.timestamp;
+    entry.values[0] = std::bit_cast<double>(state.value);
+
+    for (uint32_t i = 1; i < source.sampleCount; i++) {
+        if (reader.Read(1) != 0) {
+            // one more 1 bit for every longer class, the last one has no terminating 0
+            size_t code = 0;
+            while (code < DELTA_CODES.size() - 1 && reader.Read(1) != 0) {
+                code++;
+            }
+            state.delta = WrappingAdd(state.delta, UnZigZag(reader.Read(DELTA_CODES[code].payloadBits)));
+        }
+        state.timestamp = WrappingAdd(state.timestamp, state.delta);
+
+        if (reader.Read(1) != 0) {
+            if (reader.Read(1) != 0) {
+                state.leadingZeros = static_cast<uint32_t>(reader.Read(6));
+                const auto meaningful = static_cast<uint32_t>(reader.Read(6)) + 1;
+                state.trailingZeros = 64 - state.leadingZeros - meaningful;
+            }
+            const auto meaningful = 64 - state.leadingZeros - state.trailingZeros;
+            state.value ^= reader.Read(meaningful) << state.trailingZeros;
+        }
+
+        entry.timestamps[i] = state.timestamp;
+        entry.values[i] = std::bit_cast<double>(state.value);
+    }
+
+    return entry;
+}
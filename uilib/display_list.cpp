@@ -0,0 +1,137 @@
+#include "display_list.h"
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <algorithm>
+
+namespace {
+
+// View of the target with the scissor set to rect, rect is in target pixels and the scissor in
+// fractions of the target
+auto GetScissorView(const sf::View& view, const sf::RenderTarget& target, const sf::FloatRect& rect) -> sf::View
+{
+    const auto size = sf::Vector2f(target.getSize());
+    const auto left = std::clamp(rect.position.x / size.x, 0.f, 1.f);
+    const auto top = std::clamp(rect.position.y / size.y, 0.f, 1.f);
+    const auto right = std::clamp((rect.position.x + rect.size.x) / size.x, left, 1.f);
+    const auto bottom = std::clamp((rect.position.y + rect.size.y) / size.y, top, 1.f);
+
+    auto scissored = view;
+    scissored.setScissor({{left, top}, {right - left, bottom - top}});
+    return scissored;
+}
+
+} // namespace
+
+void DisplayList::Clear()
+{
+    m_vertices.clear();
+    m_batches.clear();
+    m_clipRects.clear();
+    m_clip = NO_CLIP;
+    m_frame = 0;
+}
+
+void DisplayList::AddVertices(sf::PrimitiveType type, std::span<const sf::Vertex> vertices,
+                              const sf::Texture* texture)
+{
+    if (vertices.empty()) {
+        return;
+    }
+
+    auto& batch = GetBatch(type, texture);
+    m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+    batch.count += vertices.size();
+}
+
+void DisplayList::AddVertices(const sf::VertexArray& vertices)
+{
+    if (vertices.getVertexCount() == 0) {
+        return;
+    }
+
+    auto& batch = GetBatch(vertices.getPrimitiveType());
+    for (size_t i = 0; i < vertices.getVertexCount(); i++) {
+        m_vertices.push_back(vertices[i]);
+    }
+    batch.count += vertices.getVertexCount();
+}
+
+void DisplayList::SetClipRect(std::optional<sf::FloatRect> rect)
+{
+    if (!rect.has_value()) {
+        m_clip = NO_CLIP;
+        return;
+    }
+
+    // elements clipped by the same container come one after another, only the last rect is reused
+    if (m_clipRects.empty() || m_clipRects.back() != *rect) {
+        m_clipRects.push_back(*rect);
+    }
+    m_clip = static_cast<uint32_t>(m_clipRects.size() - 1);
+}
+
+auto DisplayList::GetClipRectCount() const -> size_t
+{
+    return m_clipRects.size();
+}
+
+void DisplayList::SetFrame(uint64_t frame)
+{
+    m_frame = frame;
+}
+
+auto DisplayList::GetFrame() const -> uint64_t
+{
+    return m_frame;
+}
+
+auto DisplayList::GetVertexCount() const -> size_t
+{
+    return m_vertices.size();
+}
+
+auto DisplayList::GetVertices() const -> std::span<const sf::Vertex>
+{
+    return m_vertices;
+}
+
+auto DisplayList::GetBatchCount() const -> size_t
+{
+    return m_batches.size();
+}
+
+void DisplayList::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    const auto view = target.getView();
+    auto clip = NO_CLIP;
+
+    for (const auto& batch : m_batches) {
+        if (batch.clip != clip) {
+            clip = batch.clip;
+            target.setView(clip == NO_CLIP ? view : GetScissorView(view, target, m_clipRects[clip]));
+        }
+        states.texture = batch.texture;
+        target.draw(m_vertices.data() + batch.first, batch.count, batch.type, states);
+    }
+
+    if (clip != NO_CLIP) {
+        target.setView(view);
+    }
+}
+
+auto DisplayList::GetBatch(sf::PrimitiveType type, const sf::Texture* texture) -> Batch&
+{
+    // only independent primitives can be appended to the previous batch, strips and fans
+    // would connect to its last vertices
+    const auto mergeable = type == sf::PrimitiveType::Triangles || type == sf::PrimitiveType::Lines ||
+                           type == sf::PrimitiveType::Points;
+
+    const auto sameState = !m_batches.empty() && m_batches.back().type == type && m_batches.back().clip == m_clip &&
+                           m_batches.back().texture == texture;
+    if (!mergeable || !sameState) {
+        m_batches.push_back({type, m_clip, texture, m_vertices.size(), 0});
+    }
+
+    return m_batches.back();
+}
@@ -0,0 +1,115 @@
+#include "element_id.h"
+
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+// Names are stored in a deque, so views into them stay valid while it grows
+class ElementIdInterner {
+  public:
+    ElementIdInterner()
+    {
+        // id 0 is reserved for the invalid id
+        m_names.emplace_back();
+    }
+
+    auto Intern(std::string_view name) -> ElementId
+    {
+        const auto lock = std::lock_guard(m_mutex);
+
+        if (const auto found = m_ids.find(name); found != m_ids.end()) {
+            return found->second;
+        }
+
+        const auto id = ElementId{static_cast<uint32_t>(m_names.size())};
+        const auto& stored = m_names.emplace_back(name);
+        m_ids.emplace(stored, id);
+
+        return id;
+    }
+
+    auto Find(std::string_view name) -> std::optional<ElementId>
+    {
+        const auto lock = std::lock_guard(m_mutex);
+
+        if (const auto found = m_ids.find(name); found != m_ids.end()) {
+            return found->second;
+        }
+
+        return std::nullopt;
+    }
+
+    auto GetName(ElementId id) -> std::string_view
+    {
+        const auto lock = std::lock_guard(m_mutex);
+
+        assert(id.value < m_names.size());
+        return m_names[id.value];
+    }
+
+    auto GetCount() -> size_t
+    {
+        const auto lock = std::lock_guard(m_mutex);
+        return m_names.size() - 1;
+    }
+
+    auto GetBytes() -> size_t
+    {
+        const auto lock = std::lock_guard(m_mutex);
+
+        // heap of long names, the string objects and a hash map node with bucket per name
+        auto bytes = m_names.size() * sizeof(std::string);
+        for (const auto& name : m_names) {
+            if (name.capacity() > std::string().capacity()) {
+                bytes += name.capacity() + 1;
+            }
+        }
+        bytes += m_ids.size() * (sizeof(std::string_view) + sizeof(ElementId) + 2 * sizeof(void*));
+        bytes += m_ids.bucket_count() * sizeof(void*);
+
+        return bytes;
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::deque<std::string> m_names;
+    std::unordered_map<std::string_view, ElementId> m_ids;
+};
+
+auto GetInterner() -> ElementIdInterner&
+{
+    // intentionally never destroyed, names are used by elements owned by static objects
+    static auto* interner = new ElementIdInterner();
+    return *interner;
+}
+
+} // namespace
+
+auto InternElementId(std::string_view name) -> ElementId
+{
+    return GetInterner().Intern(name);
+}
+
+auto FindElementId(std::string_view name) -> std::optional<ElementId>
+{
+    return GetInterner().Find(name);
+}
+
+auto GetElementName(ElementId id) -> std::string_view
+{
+    return GetInterner().GetName(id);
+}
+
+auto GetInternedElementCount() -> size_t
+{
+    return GetInterner().GetCount();
+}
+
+auto GetInternedNameBytes() -> size_t
+{
+    return GetInterner().GetBytes();
+}
@@ -0,0 +1,57 @@
+#include "frame_arena.h"
+#include <memory_resource>
+
+FrameArena::FrameArena(size_t initialCapacity)
+    : m_buffer(initialCapacity)
+{
+    m_resource.emplace(m_buffer.data(), m_buffer.size(), &m_overflow);
+}
+
+auto FrameArena::GetResource() -> std::pmr::memory_resource*
+{
+    return &*m_resource;
+}
+
+void FrameArena::Reset()
+{
+    if (m_overflow.bytes == 0) {
+        m_resource->release();
+        return;
+    }
+
+    // last frame did not fit, grow so the same frame fits next time
+    const auto needed = m_buffer.size() + m_overflow.bytes;
+    m_resource.reset();
+
+    m_buffer = std::vector<std::byte>(needed * 2);
+    m_overflow.allocations = 0;
+    m_overflow.bytes = 0;
+    m_resource.emplace(m_buffer.data(), m_buffer.size(), &m_overflow);
+}
+
+auto FrameArena::GetCapacity() const -> size_t
+{
+    return m_buffer.size();
+}
+
+auto FrameArena::GetOverflowAllocations() const -> size_t
+{
+    return m_overflow.allocations;
+}
+
+auto FrameArena::OverflowResource::do_allocate(size_t bytes, size_t alignment) -> void*
+{
+    allocations++;
+    this->bytes += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void FrameArena::OverflowResource::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+{
+    std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+}
+
+bool FrameArena::OverflowResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
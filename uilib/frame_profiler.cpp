@@ -0,0 +1,265 @@
+#include "frame_profiler.h"
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+constexpr std::array<sf::Color, FRAME_STAGE_COUNT> STAGE_COLORS = {
+    sf::Color(80, 160, 255),  // traversal
+    sf::Color(255, 140, 60),  // tessellation
+    sf::Color(170, 90, 220),  // drawables
+    sf::Color(90, 200, 120),  // submission
+};
+
+constexpr float BAR_WIDTH = 2;
+
+} // namespace
+
+void FrameTimeHistogram::Add(double microseconds)
+{
+    m_buckets[GetBucket(microseconds)]++;
+    m_count++;
+}
+
+void FrameTimeHistogram::Clear()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+}
+
+auto FrameTimeHistogram::GetPercentile(double percentile) const -> double
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    const auto rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * double(m_count)));
+    const auto target = std::clamp<uint64_t>(rank, 1, m_count);
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+        seen += m_buckets[bucket];
+        if (seen >= target) {
+            return GetBucketMiddle(bucket);
+        }
+    }
+
+    return GetBucketMiddle(BUCKET_COUNT - 1);
+}
+
+auto FrameTimeHistogram::GetCount() const -> uint64_t
+{
+    return m_count;
+}
+
+auto FrameTimeHistogram::GetBucket(double microseconds) -> size_t
+{
+    if (!(microseconds >= 1)) {
+        return 0;
+    }
+
+    // microseconds = mantissa * 2^exponent, mantissa in [0.5, 1)
+    int exponent = 0;
+    const auto mantissa = std::frexp(microseconds, &exponent);
+    const auto octave = static_cast<size_t>(exponent - 1);
+    if (octave >= OCTAVES) {
+        return BUCKET_COUNT - 1;
+    }
+
+    const auto sub = static_cast<size_t>((mantissa * 2 - 1) * SUB_BUCKETS);
+    return 1 + octave * SUB_BUCKETS + std::min(sub, SUB_BUCKETS - 1);
+}
+
+auto FrameTimeHistogram::GetBucketMiddle(size_t bucket) -> double
+{
+    if (bucket == 0) {
+        return 0.5;
+    }
+
+    const auto octave = (bucket - 1) / SUB_BUCKETS;
+    const auto sub = (bucket - 1) % SUB_BUCKETS;
+    const auto octaveStart = std::ldexp(1.0, static_cast<int>(octave));
+
+    return octaveStart * (1 + (double(sub) + 0.5) / SUB_BUCKETS);
+}
+
+void FrameProfiler::BeginFrame()
+{
+    m_current = FrameStats{};
+    m_openStageCount = 0;
+    m_frameStart = Clock::now();
+}
+
+void FrameProfiler::EndFrame()
+{
+    assert(m_openStageCount == 0 && "All stages need to be closed before the frame ends");
+
+    const auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - m_frameStart);
+    m_current.frameMicroseconds = elapsed.count();
+
+    m_history[m_next] = m_current;
+    m_next = (m_next + 1) % HISTORY_SIZE;
+    m_count = std::min(m_count + 1, HISTORY_SIZE);
+
+    m_histogram.Add(m_current.frameMicroseconds);
+}
+
+void FrameProfiler::BeginStage(FrameStage stage)
+{
+    assert(m_openStageCount < MAX_STAGE_DEPTH);
+    m_openStages[m_openStageCount++] = {stage, Clock::now()};
+}
+
+void FrameProfiler::EndStage(FrameStage stage)
+{
+    assert(m_openStageCount > 0 && m_openStages[m_openStageCount - 1].stage == stage);
+
+    const auto& open = m_openStages[--m_openStageCount];
+    const auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - open.start).count();
+
+    m_current.stageMicroseconds[static_cast<size_t>(stage)] += elapsed;
+
+    // enclosing stage keeps only its own time
+    if (m_openStageCount > 0) {
+        const auto parent = m_openStages[m_openStageCount - 1].stage;
+        m_current.stageMicroseconds[static_cast<size_t>(parent)] -= elapsed;
+    }
+}
+
+void FrameProfiler::AddStageTime(FrameStage stage, double microseconds)
+{
+    m_current.stageMicroseconds[static_cast<size_t>(stage)] += microseconds;
+}
+
+void FrameProfiler::AddElementsVisited(uint32_t count)
+{
+    m_current.elementsVisited += count;
+}
+
+void FrameProfiler::AddVerticesGenerated(uint32_t count)
+{
+    m_current.verticesGenerated += count;
+}
+
+void FrameProfiler::AddDrawCalls(uint32_t count)
+{
+    m_current.drawCalls += count;
+}
+
+void FrameProfiler::AddAllocations(uint32_t count)
+{
+    m_current.allocations += count;
+}
+
+auto FrameProfiler::GetFrame(size_t age) const -> const FrameStats&
+{
+    assert(age < m_count);
+    return m_history[(m_next + HISTORY_SIZE - 1 - age) % HISTORY_SIZE];
+}
+
+auto FrameProfiler::GetFrameCount() const -> size_t
+{
+    return m_count;
+}
+
+auto FrameProfiler::GetHistogram() const -> const FrameTimeHistogram&
+{
+    return m_histogram;
+}
+
+FrameProfiler::ScopedStage::ScopedStage(FrameProfiler* profiler, FrameStage stage)
+    : m_profiler(profiler)
+    , m_stage(stage)
+{
+    if (m_profiler != nullptr) {
+        m_profiler->BeginStage(m_stage);
+    }
+}
+
+FrameProfiler::ScopedStage::~ScopedStage()
+{
+    if (m_profiler != nullptr) {
+        m_profiler->EndStage(m_stage);
+    }
+}
+
+ProfilerOverlay::ProfilerOverlay(const FrameProfiler& profiler, Pos position, float height, double scaleMicroseconds)
+    : m_profiler(&profiler)
+    , m_position(position)
+    , m_height(height)
+    , m_scale(scaleMicroseconds)
+    , m_vertices(sf::PrimitiveType::Triangles)
+{
+}
+
+void ProfilerOverlay::Update()
+{
+    m_vertices.clear();
+
+    const auto graphWidth = BAR_WIDTH * FrameProfiler::HISTORY_SIZE;
+    AddQuad(m_position.left, m_position.top, graphWidth, m_height, sf::Color(0, 0, 0, 160));
+
+    const auto toPixels = [this](double microseconds) {
+        return static_cast<float>(std::min(microseconds / m_scale, 1.0) * m_height);
+    };
+
+    // newest frame on the right
+    const auto bottom = m_position.top + m_height;
+    for (size_t age = 0; age < m_profiler->GetFrameCount(); age++) {
+        const auto& frame = m_profiler->GetFrame(age);
+        const auto left = m_position.left + graphWidth - BAR_WIDTH * float(age + 1);
+
+        float stackTop = bottom;
+        for (size_t stage = 0; stage < FRAME_STAGE_COUNT; stage++) {
+            const auto stageHeight = toPixels(std::max(frame.stageMicroseconds[stage], 0.0));
+            stackTop -= stageHeight;
+            AddQuad(left, stackTop, BAR_WIDTH, stageHeight, STAGE_COLORS[stage]);
+        }
+
+        // time outside of any stage
+        const auto restHeight = std::max(toPixels(frame.frameMicroseconds) - (bottom - stackTop), 0.0f);
+        AddQuad(left, stackTop - restHeight, BAR_WIDTH, restHeight, sf::Color(120, 120, 120));
+    }
+
+    const auto& histogram = m_profiler->GetHistogram();
+    const std::array<std::pair<double, sf::Color>, 3> percentiles = {{
+        {50, sf::Color::Green},
+        {95, sf::Color::Yellow},
+        {99, sf::Color::Red},
+    }};
+
+    for (const auto& [percentile, color] : percentiles) {
+        const auto top = bottom - toPixels(histogram.GetPercentile(percentile));
+        AddQuad(m_position.left, top, graphWidth, 1, color);
+    }
+}
+
+auto ProfilerOverlay::GetVertices() const -> const sf::VertexArray&
+{
+    return m_vertices;
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    target.draw(m_vertices, states);
+}
+
+void ProfilerOverlay::AddQuad(float left, float top, float width, float height, sf::Color color)
+{
+    const auto topLeft = sf::Vector2f(left, top);
+    const auto topRight = sf::Vector2f(left + width, top);
+    const auto bottomLeft = sf::Vector2f(left, top + height);
+    const auto bottomRight = sf::Vector2f(left + width, top + height);
+
+    m_vertices.append({topLeft, color});
+    m_vertices.append({topRight, color});
+    m_vertices.append({bottomRight, color});
+    m_vertices.append({topLeft, color});
+    m_vertices.append({bottomRight, color});
+    m_vertices.append({bottomLeft, color});
+}
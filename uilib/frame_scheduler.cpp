@@ -0,0 +1,122 @@
+#include "frame_scheduler.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+FrameScheduler::FrameScheduler(UiTree& uiTree, Clock::duration frameInterval)
+    : m_uiTree(&uiTree)
+    , m_frameInterval(frameInterval)
+    , m_animationInterval(frameInterval)
+    , m_lastFrame()
+    , m_renderedVersion(0)
+    , m_invalidated(true)
+    , m_requested()
+    , m_firstFrame(true)
+    , m_notified(false)
+    , m_stats()
+{
+    if (frameInterval <= Clock::duration::zero()) {
+        throw std::runtime_error(std::format("Frame scheduler - frame interval has to be positive, real - {}",
+                                             frameInterval.count()));
+    }
+}
+
+void FrameScheduler::SetAnimationInterval(Clock::duration interval)
+{
+    m_animationInterval = std::max(interval, m_frameInterval);
+}
+
+void FrameScheduler::Notify()
+{
+    {
+        const auto lock = std::scoped_lock(m_mutex);
+        m_notified = true;
+    }
+
+    m_wakeup.notify_one();
+}
+
+void FrameScheduler::Invalidate() { m_invalidated = true; }
+
+void FrameScheduler::RequestAnimationFrame() { RequestFrameAt(m_lastFrame + m_animationInterval); }
+
+void FrameScheduler::RequestFrameAt(Clock::time_point time)
+{
+    m_requested = m_requested ? std::min(*m_requested, time) : time;
+}
+
+auto FrameScheduler::GetWaitTimeout(Clock::time_point now) const -> Clock::duration
+{
+    const auto next = GetNextFrameTime();
+    if (!next) {
+        return MAX_WAIT;
+    }
+
+    return std::clamp<Clock::duration>(*next - now, Clock::duration::zero(), MAX_WAIT);
+}
+
+void FrameScheduler::Wait()
+{
+    const auto next = GetNextFrameTime();
+
+    auto lock = std::unique_lock(m_mutex);
+    if (!next) {
+        m_wakeup.wait(lock, [this] { return m_notified; });
+    }
+    else {
+        m_wakeup.wait_until(lock, *next, [this] { return m_notified; });
+    }
+}
+
+auto FrameScheduler::BeginFrame(Clock::time_point now) -> bool
+{
+    const auto next = GetNextFrameTime();
+    if (!next || *next > now) {
+        return false;
+    }
+
+    {
+        const auto lock = std::scoped_lock(m_mutex);
+        m_notified = false;
+    }
+
+    if (!m_firstFrame) {
+        const auto intervals = static_cast<uint64_t>((now - m_lastFrame) / m_frameInterval);
+        m_stats.skippedFrames += intervals > 1 ? intervals - 1 : 0;
+    }
+
+    m_firstFrame = false;
+    m_lastFrame = now;
+    m_invalidated = false;
+    m_requested.reset();
+    return true;
+}
+
+void FrameScheduler::EndFrame()
+{
+    m_renderedVersion = m_uiTree->GetRoot()->GetSubtreeVersion();
+    m_stats.renderedFrames++;
+}
+
+auto FrameScheduler::GetStats() const -> const FrameSchedulerStats& { return m_stats; }
+
+auto FrameScheduler::GetNextFrameTime() const -> std::optional<Clock::time_point>
+{
+    const auto earliest = m_lastFrame + m_frameInterval;
+
+    const auto notified = [this] {
+        const auto lock = std::scoped_lock(m_mutex);
+        return m_notified;
+    }();
+
+    if (m_invalidated || notified || m_uiTree->GetRoot()->GetSubtreeVersion() != m_renderedVersion) {
+        return earliest;
+    }
+
+    if (m_requested) {
+        return std::max(*m_requested, earliest);
+    }
+
+    return std::nullopt;
+}
@@ -0,0 +1,82 @@
+#include "image_decoder.h"
+
+#include <cassert>
+#include <utility>
+
+ImageDecoder::ImageDecoder(size_t threadCount, DecodeImageCallback decode)
+    : m_decode(std::move(decode))
+    , m_mutex()
+    , m_submitted()
+    , m_queue()
+    , m_decoded()
+    , m_pending(0)
+    , m_threads()
+{
+    assert(threadCount > 0);
+
+    if (!m_decode) {
+        m_decode = [](const std::string& source) -> std::optional<sf::Image> {
+            auto image = sf::Image();
+            if (!image.loadFromFile(source)) {
+                return std::nullopt;
+            }
+            return image;
+        };
+    }
+
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        m_threads.emplace_back([this](std::stop_token stopToken) { Run(stopToken); });
+    }
+}
+
+ImageDecoder::~ImageDecoder()
+{
+    // jthread requests stop on destruction, which also wakes the waiting threads
+    m_threads.clear();
+}
+
+void ImageDecoder::Submit(std::string source)
+{
+    {
+        const auto lock = std::scoped_lock(m_mutex);
+        m_queue.push_back(std::move(source));
+        m_pending++;
+    }
+    m_submitted.notify_one();
+}
+
+auto ImageDecoder::TakeDecoded() -> std::vector<DecodedImage>
+{
+    const auto lock = std::scoped_lock(m_mutex);
+    m_pending -= m_decoded.size();
+    return std::exchange(m_decoded, {});
+}
+
+auto ImageDecoder::GetPendingCount() const -> size_t
+{
+    const auto lock = std::scoped_lock(m_mutex);
+    return m_pending;
+}
+
+void ImageDecoder::Run(std::stop_token stopToken)
+{
+    while (true) {
+        auto source = std::string();
+        {
+            auto lock = std::unique_lock(m_mutex);
+            if (!m_submitted.wait(lock, stopToken, [this] { return !m_queue.empty(); })) {
+                return;
+            }
+
+            source = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        // outside of the lock, this is the slow part
+        auto image = m_decode(source);
+
+        const auto lock = std::scoped_lock(m_mutex);
+        m_decoded.push_back({std::move(source), std::move(image)});
+    }
+}
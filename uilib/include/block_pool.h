@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Fixed size block allocator. Blocks are carved out of big slabs and recycled
+// through an intrusive free list, so allocating and freeing a block is a couple
+// of pointer operations and nodes of the same kind end up close in memory.
+//
+// Slabs are only returned when the pool is destroyed.
+class BlockPool {
+  public:
+    BlockPool(size_t blockSize, size_t blocksPerSlab);
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    auto Allocate() -> void*;
+    void Deallocate(void* block);
+
+    // Adds slabs up front so blockCount more blocks can be allocated without growing
+    void Reserve(size_t blockCount);
+
+    // Number of blocks currently handed out
+    auto GetUsedBlocks() const -> size_t;
+
+    auto GetSlabCount() const -> size_t;
+
+    auto GetBlockSize() const -> size_t;
+
+    // Bytes reserved by the pool in total
+    auto GetReservedBytes() const -> size_t;
+
+  private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    void AddSlab();
+
+    size_t m_blockSize;
+    size_t m_blocksPerSlab;
+    size_t m_usedBlocks;
+    FreeBlock* m_freeList;
+    std::vector<std::unique_ptr<std::byte[]>> m_slabs;
+
+    // elements can be created on any thread, lock is uncontended in practice
+    mutable std::mutex m_mutex;
+};
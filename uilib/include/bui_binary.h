@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "bui_parser.h"
+#include "uitree.h"
+
+// Compiled form of a .bui layout. Everything is fixed size and little endian so
+// a mapped file can be read in place without any parsing:
+//
+// [BuiBinaryHeader]
+// [BuiBinaryElement x elementCount]  flat pre-order element table
+// [string table]                     interned element names, not null terminated
+// [property blob]                    deduplicated BuiBinaryProperties records
+
+constexpr uint32_t BUI_BINARY_MAGIC = 0x43495542; // "BUIC"
+constexpr uint32_t BUI_BINARY_VERSION = 1;
+
+struct BuiBinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t elementCount;
+    uint32_t elementTableOffset;
+    uint32_t stringTableOffset;
+    uint32_t stringTableSize;
+    uint32_t propertyBlobOffset;
+    uint32_t propertyBlobSize;
+};
+
+struct BuiBinaryElement {
+    uint32_t parent;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t propertyOffset;
+    uint8_t type;
+    uint8_t sizeFlags;
+    uint8_t padding[2];
+};
+
+// clang-format off
+struct BuiBinaryProperties {
+    float               width;
+    float               height;
+    float               border_radius_px;
+    float               border_width;
+    float               position_x;
+    float               position_y;
+    uint8_t             color[4];
+    uint8_t             border;
+    uint8_t             hidden;
+    uint8_t             layout_children;
+    // was padding, files written before are read as not clipping
+    uint8_t             clip_children;
+};
+// clang-format on
+
+static_assert(sizeof(BuiBinaryHeader) == 32);
+static_assert(sizeof(BuiBinaryElement) == 20);
+static_assert(sizeof(BuiBinaryProperties) == 32);
+
+// Compiles parsed layout into the binary representation
+auto CompileBui(const BuiDocument& document) -> std::vector<std::byte>;
+
+// Compiles parsed layout and writes it to a file
+void WriteCompiledBui(const BuiDocument& document, const std::filesystem::path& path);
+
+// Builds ui tree from compiled layout bytes, throws std::runtime_error if the data is malformed
+void LoadCompiledBui(std::span<const std::byte> data, UiTree& uiTree);
+
+// Maps compiled layout file and builds ui tree from it
+void LoadCompiledBuiFile(const std::filesystem::path& path, UiTree& uiTree);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+#include "bui_parser.h"
+#include "uitree.h"
+
+struct LayoutDiffStats {
+    size_t inserted = 0;
+    size_t removed = 0;
+    size_t moved = 0;
+    size_t updated = 0;
+    size_t reordered = 0;
+    size_t unchanged = 0;
+};
+
+// Brings a tree built from previous layout to the state described by next layout
+// with the smallest set of changes, applied as one transaction.
+//
+// Elements of previous layout are located by following its structure from the tree root,
+// elements of next layout are matched to them by name. Matched elements are kept as they are
+// (together with anything attached to them), only their properties, parent or position among
+// siblings is changed when the layout says so. Elements which are not part of previous layout,
+// for example ones created from code, are never matched or removed, even if they share a name.
+//
+// Properties are compared against previous layout and not against the tree, since layout
+// rewrites sizes and positions of the elements. Both are compared resolved, so max sized
+// elements are updated when the size of their parent changes.
+//
+// Runs in time linear in the size of both layouts and the number of children of the elements
+// they declare, the rest of the tree is not visited. Locating children is quadratic per parent only when code reordered them.
+auto ApplyLayoutDiff(const BuiDocument& previous, const BuiDocument& next, UiTree& uiTree) -> LayoutDiffStats;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mapped_file.h"
+#include "types.h"
+#include "uielement.h"
+#include "uitree.h"
+
+// Parser for the declarative .bui layout format (see example.bui)
+//
+// Element:                  <- starts an element, optional name after the colon
+//     width: max            <- number of pixels or max (parent size)
+//     height: 100
+//     layout: vertical      <- vertical / horizontal
+//     border: 1px
+//     radius: 4px
+//     visible: true
+//     clip: true            <- children are cut to the element bounds
+//     bg-color: #14a0ff     <- #rrggbb or #rrggbbaa
+//     Element: child        <- nesting is defined by indentation
+//
+// Everything after // is a comment. There can be only one top level element.
+//
+// Parsing is a single pass over the whole source, names are kept as views
+// into the source and copied only when the ui tree is built.
+
+constexpr uint32_t BUI_NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+// Size values which are resolved only when the tree is built
+enum BuiSizeFlags : uint8_t {
+    BUI_SIZE_FIXED = 0,
+    BUI_WIDTH_MAX = 1 << 0,
+    BUI_HEIGHT_MAX = 1 << 1,
+};
+
+struct BuiElement {
+    uint32_t parent = BUI_NO_PARENT;
+    // view into the parsed source, empty for unnamed elements
+    std::string_view name;
+    ElemType type = ElemType::Box;
+    uint8_t sizeFlags = BUI_SIZE_FIXED;
+    Properties properties;
+};
+
+// Parsed layout, elements are stored in pre-order so parent
+// always comes before its children
+struct BuiDocument {
+    std::vector<BuiElement> elements;
+
+    // Keeps the mapped file alive for documents created by LoadBuiFile,
+    // documents created by ParseBui point into the caller's buffer
+    std::optional<MappedFile> source;
+};
+
+// Thrown on invalid input, line and column are 1 based
+class BuiParseError : public std::runtime_error {
+  public:
+    BuiParseError(size_t line, size_t column, std::string_view message);
+
+    auto GetLine() const -> size_t;
+    auto GetColumn() const -> size_t;
+
+  private:
+    size_t m_line;
+    size_t m_column;
+};
+
+// Parses .bui source text, returned document refers to the source buffer
+auto ParseBui(std::string_view source) -> BuiDocument;
+
+// Maps and parses a .bui file
+auto LoadBuiFile(const std::filesystem::path& path) -> BuiDocument;
+
+// Name used for an element, a view into the layout source. Names of elements the layout does not
+// name are generated from their index into buffer, the view is valid until buffer changes
+auto GetBuiElementName(const BuiDocument& document, uint32_t index, std::string& buffer) -> std::string_view;
+
+// Attaches pre-order elements to their parents with a single insertion per parent,
+// elements without a parent are attached to root. Throws std::runtime_error without attaching
+// anything if a parent would end up with more than MAX_CHILDREN children
+void AttachBuiElements(std::vector<std::unique_ptr<UiElement>>& elements, std::span<const uint32_t> parents,
+                       UiElement* root);
+
+// Creates ui elements for the document and attaches the top level element to the tree root
+void BuildUiTree(const BuiDocument& document, UiTree& uiTree);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "bui_diff.h"
+#include "bui_parser.h"
+#include "uitree.h"
+
+// Hot reload of a .bui layout file.
+//
+// Builds the tree from the file on construction, then watches the file with inotify.
+// Poll is cheap and non blocking so it can be called every frame, when the file was
+// written the new layout is diffed into the live tree, so elements that did not change
+// keep their state.
+class BuiHotReload {
+  public:
+    BuiHotReload(const std::filesystem::path& path, UiTree& uiTree);
+    ~BuiHotReload();
+
+    // Parsed views point into the owned source, so the object can not be copied or moved
+    BuiHotReload(const BuiHotReload&) = delete;
+    BuiHotReload& operator=(const BuiHotReload&) = delete;
+
+    // Applies the layout if the file changed since the last call and returns what changed.
+    // Invalid or empty layout leaves the tree untouched and is reported through GetLastError
+    auto Poll() -> std::optional<LayoutDiffStats>;
+
+    // Reloads the layout without waiting for a file change
+    auto Reload() -> std::optional<LayoutDiffStats>;
+
+    // Error of the last Poll or Reload call, empty if it succeeded
+    auto GetLastError() const -> const std::string&;
+
+  private:
+    auto ReadSource() const -> std::unique_ptr<const std::string>;
+
+    std::filesystem::path m_path;
+    UiTree* m_uiTree;
+    int m_inotifyFd;
+
+    // Source is read into memory instead of mapped, editors often rewrite the file in place
+    // which would change the mapped bytes under the previous document
+    std::unique_ptr<const std::string> m_source;
+    BuiDocument m_document;
+    std::string m_lastError;
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Range of integer timestamps, both ends inclusive
+struct TimeRange {
+    int64_t start;
+    int64_t end;
+};
+
+struct CompressedSeriesStats {
+    // blocks found in the decoded block cache and blocks decoded by Read
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t decodedSamples = 0;
+};
+
+// Long history of one plot series kept compressed in memory, Gorilla style.
+//
+// Samples are split into blocks of a fixed number of samples. Every block is a bit stream
+// starting with a raw timestamp and value, followed by delta of delta encoded timestamps
+// (regular sampling costs one bit) and values XOR-ed with the previous one (an unchanged value
+// costs one bit, a slowly changing one only its differing middle bits). Blocks are independent,
+// Read decodes only the blocks overlapping the requested range and keeps the last few decoded
+// blocks, so scrolling a visible window does not decode the same blocks every frame.
+//
+// Timestamps are integer ticks (for example milliseconds) and have to be non decreasing.
+// Not thread safe, meant to be owned by the ui thread like PlotSeries.
+class CompressedSeries {
+  public:
+    explicit CompressedSeries(uint32_t samplesPerBlock = 1024, size_t cachedBlocks = 8);
+
+    // Throws std::runtime_error if the timestamp is lower than the last one
+    void Append(int64_t timestamp, double value);
+    void Append(std::span<const int64_t> timestamps, std::span<const double> values);
+
+    // Replaces timestamps and values with the samples in the range, values are bit exact
+    void Read(TimeRange range, std::vector<int64_t>& timestamps, std::vector<double>& values);
+
+    void Clear();
+
+    auto GetSampleCount() const -> uint64_t;
+    auto GetBlockCount() const -> size_t;
+
+    // Bit streams and block records, what the history costs in memory
+    auto GetCompressedBytes() const -> size_t;
+
+    // Raw size of timestamp and value of every sample divided by the compressed size
+    auto GetCompressionRatio() const -> double;
+
+    auto GetStats() const -> const CompressedSeriesStats&;
+
+  private:
+    struct Block {
+        int64_t firstTimestamp = 0;
+        int64_t lastTimestamp = 0;
+        uint32_t sampleCount = 0;
+        uint64_t bitCount = 0;
+        std::vector<uint64_t> words;
+    };
+
+    // Previous sample as the encoder and decoder of one block see it
+    struct CodecState {
+        int64_t timestamp = 0;
+        int64_t delta = 0;
+        uint64_t value = 0;
+        // bits of the last XOR written in full, 64 leading zeros while there was none
+        uint32_t leadingZeros = 64;
+        uint32_t trailingZeros = 0;
+    };
+
+    struct DecodedBlock {
+        size_t block = SIZE_MAX;
+        // the last block still grows, it is decoded again once it has more samples
+        uint32_t sampleCount = 0;
+        uint64_t lastUse = 0;
+        std::vector<int64_t> timestamps;
+        std::vector<double> values;
+    };
+
+    auto Decode(size_t block) -> const DecodedBlock&;
+
+    uint32_t m_samplesPerBlock;
+    std::vector<Block> m_blocks;
+    uint64_t m_sampleCount;
+    // state after the last appended sample
+    CodecState m_encoder;
+
+    // least recently used entry is replaced
+    std::vector<DecodedBlock> m_cache;
+    uint64_t m_useCounter;
+
+    CompressedSeriesStats m_stats;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+// Snapshot of everything drawn in a frame. The update thread builds it from the ui tree,
+// after that it is only read, so the render thread can draw it while the next frame is built.
+//
+// Vertices are stored in one buffer, consecutive triangle lists are merged into a single
+// batch so each batch is one draw call. A batch has one clip rect and one texture, changing
+// either starts a new batch, so callers should add everything with the same state together.
+class DisplayList : public sf::Drawable {
+  public:
+    // Keeps the capacity, so a reused list does not allocate in steady state
+    void Clear();
+
+    // Texture is not owned, it has to outlive every draw of the list
+    void AddVertices(sf::PrimitiveType type, std::span<const sf::Vertex> vertices,
+                     const sf::Texture* texture = nullptr);
+    void AddVertices(const sf::VertexArray& vertices);
+
+    // Vertices added afterwards are scissored to rect in target pixels, nullopt draws them unclipped
+    void SetClipRect(std::optional<sf::FloatRect> rect);
+
+    // Number of distinct clip rects used by the list
+    auto GetClipRectCount() const -> size_t;
+
+    void SetFrame(uint64_t frame);
+    auto GetFrame() const -> uint64_t;
+
+    auto GetVertexCount() const -> size_t;
+
+    // Vertices of all batches in draw order
+    auto GetVertices() const -> std::span<const sf::Vertex>;
+
+    // Number of draw calls needed to render the list
+    auto GetBatchCount() const -> size_t;
+
+  private:
+    static constexpr uint32_t NO_CLIP = UINT32_MAX;
+
+    struct Batch {
+        sf::PrimitiveType type;
+        uint32_t clip;
+        const sf::Texture* texture;
+        size_t first;
+        size_t count;
+    };
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    auto GetBatch(sf::PrimitiveType type, const sf::Texture* texture = nullptr) -> Batch&;
+
+    std::vector<sf::Vertex> m_vertices;
+    std::vector<Batch> m_batches;
+    std::vector<sf::FloatRect> m_clipRects;
+    uint32_t m_clip = NO_CLIP;
+    uint64_t m_frame = 0;
+};
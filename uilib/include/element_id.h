@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+
+// Compact identity of a ui element. Names are interned once, after that elements are
+// compared, hashed and looked up by a 32-bit value. The same name always maps to the
+// same id, so ids of elements with equal names are equal.
+struct ElementId {
+    uint32_t value = 0;
+
+    bool operator==(const ElementId&) const = default;
+
+    // Default constructed id does not belong to any name
+    auto IsValid() const -> bool
+    {
+        return value != 0;
+    }
+};
+
+template <> struct std::hash<ElementId> {
+    auto operator()(const ElementId& id) const noexcept -> size_t
+    {
+        return std::hash<uint32_t>{}(id.value);
+    }
+};
+
+// Returns id of the name, adding it to the interner if it is new. Thread safe.
+auto InternElementId(std::string_view name) -> ElementId;
+
+// Returns id of the name only if it was interned before, lookups by unknown names
+// do not grow the interner
+auto FindElementId(std::string_view name) -> std::optional<ElementId>;
+
+// Name the id was interned from, for debugging and serialization. The view stays
+// valid for the lifetime of the program.
+auto GetElementName(ElementId id) -> std::string_view;
+
+// Number of interned names
+auto GetInternedElementCount() -> size_t;
+
+// Approximate memory held by the interner, names are shared by all trees
+auto GetInternedNameBytes() -> size_t;
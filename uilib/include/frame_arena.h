@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+// Bump allocator for scratch memory which lives for one frame.
+//
+// Allocations are served from a preallocated buffer and are all freed at once by
+// Reset. If a frame needs more than the buffer, the rest is taken from the heap and
+// the buffer grows on the next Reset, so after a few frames a steady state frame does
+// not touch the global heap at all.
+class FrameArena {
+  public:
+    explicit FrameArena(size_t initialCapacity = 64 * 1024);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Memory resource for pmr containers, valid until the next Reset
+    auto GetResource() -> std::pmr::memory_resource*;
+
+    // Frees everything allocated since the last reset, called once per frame
+    void Reset();
+
+    auto GetCapacity() const -> size_t;
+
+    // Heap allocations made because the buffer was too small, since the last reset
+    auto GetOverflowAllocations() const -> size_t;
+
+  private:
+    // Passes allocations to the heap and counts them
+    class OverflowResource : public std::pmr::memory_resource {
+      public:
+        size_t allocations = 0;
+        size_t bytes = 0;
+
+      private:
+        auto do_allocate(size_t bytes, size_t alignment) -> void* override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    std::vector<std::byte> m_buffer;
+    OverflowResource m_overflow;
+    std::optional<std::pmr::monotonic_buffer_resource> m_resource;
+};
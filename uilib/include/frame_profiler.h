@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+#include "types.h"
+
+enum class FrameStage : uint8_t { Traversal, Tessellation, Drawables, Submission, Count };
+
+constexpr size_t FRAME_STAGE_COUNT = static_cast<size_t>(FrameStage::Count);
+
+// Measurements of a single frame, stage times are exclusive so nested stages
+// are not counted twice
+struct FrameStats {
+    std::array<double, FRAME_STAGE_COUNT> stageMicroseconds{};
+    double frameMicroseconds = 0;
+    uint32_t elementsVisited = 0;
+    uint32_t verticesGenerated = 0;
+    uint32_t drawCalls = 0;
+    uint32_t allocations = 0;
+};
+
+// Log-linear histogram of frame times, percentiles are computed without keeping
+// the samples. Every power of two is split into 16 buckets, so a reported
+// percentile is within ~3% of the real value.
+class FrameTimeHistogram {
+  public:
+    void Add(double microseconds);
+    void Clear();
+
+    // Returns value at percentile in range (0, 100], 0 if there are no samples
+    auto GetPercentile(double percentile) const -> double;
+
+    auto GetCount() const -> uint64_t;
+
+  private:
+    static constexpr size_t SUB_BUCKETS = 16;
+    static constexpr size_t OCTAVES = 32;
+    static constexpr size_t BUCKET_COUNT = 1 + OCTAVES * SUB_BUCKETS;
+
+    static auto GetBucket(double microseconds) -> size_t;
+    static auto GetBucketMiddle(size_t bucket) -> double;
+
+    std::array<uint64_t, BUCKET_COUNT> m_buckets{};
+    uint64_t m_count = 0;
+};
+
+// Collects per frame timings of the rendering pipeline and keeps a fixed size history.
+//
+// Usage: BeginFrame, any number of stages and counters, EndFrame. Stages can nest,
+// time of a nested stage is subtracted from the enclosing one.
+class FrameProfiler {
+  public:
+    static constexpr size_t HISTORY_SIZE = 240;
+
+    void BeginFrame();
+    void EndFrame();
+
+    void BeginStage(FrameStage stage);
+    void EndStage(FrameStage stage);
+
+    // Adds time of a stage that ran outside of this profiler, for example on another thread
+    void AddStageTime(FrameStage stage, double microseconds);
+
+    void AddElementsVisited(uint32_t count);
+    void AddVerticesGenerated(uint32_t count);
+    void AddDrawCalls(uint32_t count);
+    void AddAllocations(uint32_t count);
+
+    // Frame recorded age frames ago, 0 is the last finished frame
+    auto GetFrame(size_t age) const -> const FrameStats&;
+
+    // Number of frames in history
+    auto GetFrameCount() const -> size_t;
+
+    auto GetHistogram() const -> const FrameTimeHistogram&;
+
+    // Measures a stage for the lifetime of the object, profiler can be null
+    class ScopedStage {
+      public:
+        ScopedStage(FrameProfiler* profiler, FrameStage stage);
+        ~ScopedStage();
+
+        ScopedStage(const ScopedStage&) = delete;
+        ScopedStage& operator=(const ScopedStage&) = delete;
+
+      private:
+        FrameProfiler* m_profiler;
+        FrameStage m_stage;
+    };
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct OpenStage {
+        FrameStage stage;
+        Clock::time_point start;
+    };
+
+    static constexpr size_t MAX_STAGE_DEPTH = 8;
+
+    std::array<FrameStats, HISTORY_SIZE> m_history{};
+    size_t m_next = 0;
+    size_t m_count = 0;
+
+    FrameStats m_current;
+    Clock::time_point m_frameStart;
+    std::array<OpenStage, MAX_STAGE_DEPTH> m_openStages{};
+    size_t m_openStageCount = 0;
+
+    FrameTimeHistogram m_histogram;
+};
+
+// On screen graph of the profiler history. Every frame is a bar split into stage
+// colors, with horizontal lines at p50 (green), p95 (yellow) and p99 (red).
+// Height of the graph corresponds to scaleMicroseconds.
+class ProfilerOverlay : public sf::Drawable {
+  public:
+    ProfilerOverlay(const FrameProfiler& profiler, Pos position, float height, double scaleMicroseconds);
+
+    // Rebuilds the graph from the current profiler state
+    void Update();
+
+    auto GetVertices() const -> const sf::VertexArray&;
+
+  private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    void AddQuad(float left, float top, float width, float height, sf::Color color);
+
+    const FrameProfiler* m_profiler;
+    Pos m_position;
+    float m_height;
+    double m_scale;
+    sf::VertexArray m_vertices;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+#include "uitree.h"
+
+struct FrameSchedulerStats {
+    uint64_t renderedFrames = 0;
+    // frame intervals that passed without a frame, counted when the next frame starts
+    uint64_t skippedFrames = 0;
+};
+
+// Decides when the ui thread builds a frame instead of redrawing at a fixed rate.
+//
+// A frame is due when the tree changed since the last frame, another thread called Notify,
+// or a requested time was reached. Frames are never closer than frameInterval, frames
+// requested by animations are additionally capped by the animation interval.
+//
+// Usage on the ui thread: wait for at most GetWaitTimeout (or call Wait), apply changes,
+// then build a frame between BeginFrame returning true and EndFrame.
+class FrameScheduler {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // Longest wait without a frame due, window event waits can not be interrupted by
+    // Notify so notifications from other threads are picked up at the latest after this
+    static constexpr auto MAX_WAIT = std::chrono::milliseconds(16);
+
+    FrameScheduler(UiTree& uiTree, Clock::duration frameInterval);
+
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+    // Minimum time between frames requested through RequestAnimationFrame, frameInterval by default
+    void SetAnimationInterval(Clock::duration interval);
+
+    // Any thread, for example when new plot data arrived
+    void Notify();
+
+    // Ui thread, for changes not visible in the tree version
+    void Invalidate();
+
+    // Ui thread, next frame of a running animation, called every frame while it runs
+    void RequestAnimationFrame();
+
+    // Ui thread, frame at or after time, the earliest request wins
+    void RequestFrameAt(Clock::time_point time);
+
+    // Time until the next frame is due, capped at MAX_WAIT, zero if it is already due
+    auto GetWaitTimeout(Clock::time_point now) const -> Clock::duration;
+
+    // Blocks until a frame is due or Notify is called, for loops without a window to wait on
+    void Wait();
+
+    // Returns true and starts a frame if one is due at now
+    auto BeginFrame(Clock::time_point now) -> bool;
+
+    // Called after the frame was built, changes made while building it do not cause another frame
+    void EndFrame();
+
+    auto GetStats() const -> const FrameSchedulerStats&;
+
+  private:
+    auto GetNextFrameTime() const -> std::optional<Clock::time_point>;
+
+    UiTree* m_uiTree;
+    Clock::duration m_frameInterval;
+    Clock::duration m_animationInterval;
+
+    Clock::time_point m_lastFrame;
+    uint64_t m_renderedVersion;
+    bool m_invalidated;
+    std::optional<Clock::time_point> m_requested;
+    bool m_firstFrame;
+
+    // set by other threads
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    bool m_notified;
+
+    FrameSchedulerStats m_stats;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SFML/Graphics/Image.hpp>
+
+// Turns an image source into pixels, nullopt if it can not be decoded. Runs on decoder
+// threads, so it must not touch the ui tree or any gl resources
+using DecodeImageCallback = std::function<std::optional<sf::Image>(const std::string& source)>;
+
+struct DecodedImage {
+    std::string source;
+    // nullopt if decoding failed
+    std::optional<sf::Image> image;
+};
+
+// Pool of background threads decoding images.
+//
+// The ui thread submits sources and collects finished images once per frame, decoding
+// a png never blocks a frame. Images come back in the order they finished.
+class ImageDecoder {
+  public:
+    // Decodes files from disk unless decode is given
+    explicit ImageDecoder(size_t threadCount = 2, DecodeImageCallback decode = nullptr);
+
+    // Stops the threads, images which were not decoded yet are dropped
+    ~ImageDecoder();
+
+    ImageDecoder(const ImageDecoder&) = delete;
+    ImageDecoder& operator=(const ImageDecoder&) = delete;
+
+    void Submit(std::string source);
+
+    // Takes every image decoded since the last call
+    auto TakeDecoded() -> std::vector<DecodedImage>;
+
+    // Submitted images which were not taken yet
+    auto GetPendingCount() const -> size_t;
+
+  private:
+    void Run(std::stop_token stopToken);
+
+    DecodeImageCallback m_decode;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable_any m_submitted;
+    std::deque<std::string> m_queue;
+    std::vector<DecodedImage> m_decoded;
+    size_t m_pending;
+
+    // last, threads have to stop before the members they use are destroyed
+    std::vector<std::jthread> m_threads;
+};
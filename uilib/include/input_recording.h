@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include <SFML/Window/Event.hpp>
+
+// Recorded input session, replayed to reproduce performance problems that depend on
+// the exact interaction sequence. Fixed size little endian records:
+//
+// [InputRecordingHeader]
+// [RecordedEvent x eventCount]  ordered by time
+
+constexpr uint32_t INPUT_RECORDING_MAGIC = 0x52494955; // "UIIR"
+constexpr uint32_t INPUT_RECORDING_VERSION = 1;
+
+struct InputRecordingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t eventCount;
+    uint32_t padding;
+};
+
+enum class RecordedEventType : uint8_t {
+    Closed,
+    Resized,
+    KeyPressed,
+    KeyReleased,
+    MouseMoved,
+    MouseButtonPressed,
+    MouseButtonReleased,
+    MouseWheelScrolled,
+};
+
+enum RecordedModifiers : uint8_t {
+    RECORDED_ALT = 1,
+    RECORDED_CONTROL = 2,
+    RECORDED_SHIFT = 4,
+    RECORDED_SYSTEM = 8,
+};
+
+struct RecordedEvent {
+    // since the start of the recording
+    uint64_t timeMicroseconds;
+    RecordedEventType type;
+    // RecordedModifiers of key events
+    uint8_t modifiers;
+    // key code, mouse button or wheel
+    int16_t code;
+    // mouse position or new window size
+    int32_t x;
+    int32_t y;
+    float wheelDelta;
+
+    bool operator==(const RecordedEvent&) const = default;
+};
+
+static_assert(sizeof(InputRecordingHeader) == 16);
+static_assert(sizeof(RecordedEvent) == 24);
+
+// Converts window event into a record, returns nullopt for events that are not recorded
+auto ToRecordedEvent(const sf::Event& event, uint64_t timeMicroseconds) -> std::optional<RecordedEvent>;
+
+// Converts record back into the window event it was made from
+auto ToSfEvent(const RecordedEvent& event) -> sf::Event;
+
+// Collects events with the time since construction
+class InputRecorder {
+  public:
+    InputRecorder();
+
+    // Returns false if the event type is not recorded
+    auto Record(const sf::Event& event) -> bool;
+    auto Record(const sf::Event& event, uint64_t timeMicroseconds) -> bool;
+
+    auto GetEvents() const -> std::span<const RecordedEvent>;
+
+    // Throws std::runtime_error if writing fails
+    void Write(std::ostream& out) const;
+    void Save(const std::filesystem::path& path) const;
+
+  private:
+    std::chrono::steady_clock::time_point m_start;
+    std::vector<RecordedEvent> m_events;
+};
+
+// Throws std::runtime_error if the data is malformed or events are not ordered by time
+auto LoadInputRecording(std::span<const std::byte> data) -> std::vector<RecordedEvent>;
+auto LoadInputRecordingFile(const std::filesystem::path& path) -> std::vector<RecordedEvent>;
+
+// Plays recorded events against a virtual clock advanced by a fixed interval every frame,
+// so a replay produces the same frames independent of how long each frame took.
+//
+// Usage: every frame PollEvent until nullopt, then AdvanceFrame.
+class InputReplay {
+  public:
+    InputReplay(std::vector<RecordedEvent> events, std::chrono::microseconds frameInterval);
+
+    // Next event recorded before the end of the current frame, same contract as sf::Window::pollEvent
+    auto PollEvent() -> std::optional<sf::Event>;
+
+    void AdvanceFrame();
+
+    // True when every event was polled
+    auto IsFinished() const -> bool;
+
+    auto GetFrame() const -> uint64_t;
+    auto GetVirtualTime() const -> std::chrono::microseconds;
+
+  private:
+    std::vector<RecordedEvent> m_events;
+    size_t m_next;
+    std::chrono::microseconds m_frameInterval;
+    uint64_t m_frame;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/Graphics/Vertex.hpp>
+
+#include "uielement.h"
+
+struct LayerStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // misses caused by a changed subtree, part of misses
+    uint64_t invalidations = 0;
+    uint64_t evictions = 0;
+    // layers which did not fit into the budget on their own and were drawn uncached
+    uint64_t oversized = 0;
+    size_t layerCount = 0;
+    size_t usedBytes = 0;
+
+    auto GetHitRate() const -> double;
+};
+
+// Pre-tessellated subtrees of elements cached as layers.
+//
+// A layer is the triangle list of the whole subtree, drawing it is one append instead of
+// traversing and tessellating every element. Layers are keyed by their root element and
+// valid for one subtree version. When the cache grows over the memory budget, least
+// recently used layers are evicted.
+class LayerCache {
+  public:
+    explicit LayerCache(size_t budgetBytes = 16 * 1024 * 1024);
+
+    LayerCache(const LayerCache&) = delete;
+    LayerCache& operator=(const LayerCache&) = delete;
+
+    // Returns cached layer if it was built for the same version, nullptr otherwise
+    auto Find(UiElement* root, uint64_t version) -> const std::vector<sf::Vertex>*;
+
+    // Stores a freshly built layer. Returns the stored vertices, valid until the next Store or
+    // SetBudget, or nullptr if the layer alone is over the budget and was not stored
+    auto Store(UiElement* root, uint64_t version, std::vector<sf::Vertex> vertices, size_t elementCount)
+        -> const std::vector<sf::Vertex>*;
+
+    // Number of elements inside layers returned by Find or Store since the last call
+    auto TakeLayeredElementCount() -> size_t;
+
+    // Evicts layers until the cache fits
+    void SetBudget(size_t budgetBytes);
+
+    auto GetStats() const -> const LayerStats&;
+
+    void Clear();
+
+  private:
+    struct Layer {
+        UiElement* root;
+        uint64_t version;
+        size_t elementCount;
+        std::vector<sf::Vertex> vertices;
+    };
+
+    static auto GetBytes(const Layer& layer) -> size_t;
+
+    void Erase(std::list<Layer>::iterator layer);
+    void EvictUntil(size_t budgetBytes);
+
+    size_t m_budgetBytes;
+    size_t m_layeredElements;
+
+    // most recently used in front
+    std::list<Layer> m_layers;
+    std::unordered_map<UiElement*, std::list<Layer>::iterator> m_index;
+
+    LayerStats m_stats;
+};
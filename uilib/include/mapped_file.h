@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+// Read only memory mapping of a whole file, unmapped on destruction.
+// Used for loading layouts and data files without copying them into
+// heap buffers first.
+class MappedFile {
+  public:
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Mapped bytes, empty span for empty files
+    auto GetData() const -> std::span<const std::byte>;
+
+    // Mapped bytes viewed as text
+    auto GetView() const -> std::string_view;
+
+    auto GetSize() const -> size_t;
+
+  private:
+    void Unmap();
+
+    const std::byte* m_data;
+    size_t m_size;
+};
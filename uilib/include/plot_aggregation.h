@@ -0,0 +1,158 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "types.h"
+
+// Count, min, max and sum of a run of samples, samples are expected to be finite
+struct SampleAggregate {
+    uint64_t count = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double sum = 0;
+
+    // 0 if there are no samples
+    auto GetMean() const -> double;
+
+    void Merge(const SampleAggregate& other);
+};
+
+// Aggregate of samples, four independent accumulators per value so the loop is vectorized
+auto AggregateSamples(std::span<const double> samples) -> SampleAggregate;
+
+// Histogram with equal width bins over [range.start, range.end). Samples below the range
+// (and NaN) are counted as underflow, samples at or above the end as overflow.
+class SampleHistogram {
+  public:
+    SampleHistogram(Range range, size_t binCount);
+
+    void Add(std::span<const double> samples);
+
+    // Other histogram has to have the same range and bin count
+    void Merge(const SampleHistogram& other);
+
+    void Clear();
+
+    auto GetBins() const -> std::span<const uint64_t>;
+    auto GetUnderflow() const -> uint64_t;
+    auto GetOverflow() const -> uint64_t;
+    auto GetBinRange(size_t bin) const -> Range;
+
+    // Aggregate of every added sample, including the ones outside of the range
+    auto GetTotal() const -> const SampleAggregate&;
+
+    // Value at percentile in range (0, 100], interpolated inside the bin and clamped to the
+    // observed min and max. 0 if there are no samples
+    auto GetPercentile(double percentile) const -> double;
+
+  private:
+    Range m_range;
+    double m_scale;
+    // underflow first, overflow last
+    std::vector<uint64_t> m_counts;
+    SampleAggregate m_total;
+};
+
+// Fixed threads splitting one range of work into contiguous parts.
+//
+// Run gives every thread one part and the calling thread works on the first one, so
+// with n threads the work is split into at most n + 1 parts. Small inputs are not split,
+// waking the threads would cost more than the work.
+class AggregationPool {
+  public:
+    // Part of [0, size) processed by one thread, tasks must not throw
+    using Task = std::function<void(size_t part, size_t begin, size_t end)>;
+
+    // Smallest number of samples worth a separate part
+    static constexpr size_t MIN_PART_SIZE = 64 * 1024;
+
+    // Uses one thread per core besides the caller if threadCount is 0
+    explicit AggregationPool(size_t threadCount = 0);
+
+    // Stops the threads
+    ~AggregationPool();
+
+    AggregationPool(const AggregationPool&) = delete;
+    AggregationPool& operator=(const AggregationPool&) = delete;
+
+    // Number of parts Run splits size into
+    auto GetPartCount(size_t size) const -> size_t;
+
+    // Calls task for every part and blocks until all of them finished
+    void Run(size_t size, const Task& task);
+
+  private:
+    void Work(std::stop_token stopToken, size_t part);
+
+    static auto GetPartBegin(size_t size, size_t parts, size_t part) -> size_t;
+
+    // one Run at a time
+    std::mutex m_runMutex;
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_started;
+    std::condition_variable m_finished;
+    const Task* m_task;
+    size_t m_size;
+    size_t m_parts;
+    size_t m_remaining;
+    uint64_t m_generation;
+
+    // last, threads have to stop before the members they use are destroyed
+    std::vector<std::jthread> m_threads;
+};
+
+// Histogram and per interval aggregates of a growing series of samples.
+//
+// Only samples appended since the last call are aggregated, history is never scanned
+// again. Every interval covers samplesPerInterval consecutive samples, the last one is
+// extended by the next Append until it is full. Appends are split across the pool, every
+// part fills its own partial results which are merged on the calling thread.
+class SampleAggregator {
+  public:
+    // Pool is optional, without it everything runs on the calling thread
+    SampleAggregator(Range histogramRange, size_t binCount, size_t samplesPerInterval,
+                     AggregationPool* pool = nullptr);
+
+    // Aggregates samples following the ones seen so far
+    void Append(std::span<const double> samples);
+
+    // Aggregates the tail of a series not seen yet, for example PlotSeries::GetSamples. A
+    // series shorter than what was seen was replaced and is aggregated from the start
+    void Update(std::span<const double> series);
+
+    void Clear();
+
+    auto GetHistogram() const -> const SampleHistogram&;
+    auto GetIntervals() const -> std::span<const SampleAggregate>;
+    auto GetSampleCount() const -> uint64_t;
+
+  private:
+    struct Partial {
+        SampleHistogram histogram;
+        uint64_t firstInterval = 0;
+        std::vector<SampleAggregate> intervals;
+    };
+
+    void AggregatePart(std::span<const double> samples, uint64_t firstIndex, Partial& partial) const;
+
+    Range m_histogramRange;
+    size_t m_binCount;
+    size_t m_samplesPerInterval;
+    AggregationPool* m_pool;
+
+    SampleHistogram m_histogram;
+    std::vector<SampleAggregate> m_intervals;
+    uint64_t m_sampleCount;
+
+    // kept to reuse their capacity
+    std::vector<Partial> m_partials;
+};
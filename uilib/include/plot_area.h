@@ -2,14 +2,17 @@
 
 #include "types.h"
 
+#include <span>
+
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/VertexArray.hpp>
 
 // This is a class that represents area on the plot
 class PlotArea {
   public:
-    // Axis scale represents how much pixels 1000 units of data represent
-    explicit PlotArea(Pos startAxisPos, float axisWidth, const std::vector<double>& data, float axisScale,
+    // Axis scale represents how much pixels 1000 units of data represent. Data is only read while
+    // constructing, it can be a view into a mapped series file
+    explicit PlotArea(Pos startAxisPos, float axisWidth, std::span<const double> data, float axisScale,
                       uint32_t interpolationRate);
 
     auto GetVertexArray() -> sf::VertexArray;
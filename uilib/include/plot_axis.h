@@ -9,6 +9,13 @@ class PlotAxis {
   public:
     explicit PlotAxis(Pos startPosition, uint32_t length, AxisType type);
     void SetRange(double start, double end);
+    auto GetRange() const -> Range;
+
+    // Fits the range to the data range, for example RollingStats::GetRange. Data leaving the
+    // range grows it with margin (a fraction of the data span) on both sides, it shrinks only
+    // once the padded data covers less than shrinkBelow of it. Small changes of a live series
+    // leave the axis alone instead of rescaling it every frame. Returns true if it changed
+    auto AutoScale(Range data, double margin = 0.1, double shrinkBelow = 0.5) -> bool;
 
   private:
     void Recalculate();
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include "types.h"
+
+// Maps values to colors through a 256 entry table
+class Colormap {
+  public:
+    // Stops are spread evenly over the range and interpolated, at least two are needed
+    explicit Colormap(std::span<const sf::Color> stops);
+
+    // Perceptually uniform dark blue to yellow
+    static auto Viridis() -> Colormap;
+
+    // Writes RGBA pixel of every value, values outside of range are clamped and NaN maps
+    // to the lowest color. Indices are computed in a separate branch free pass so the
+    // compiler can vectorize it, the table lookup is a plain gather
+    void Map(std::span<const float> values, Range range, std::span<uint32_t> pixels) const;
+
+    auto GetColor(uint8_t index) const -> sf::Color;
+
+  private:
+    std::array<uint32_t, 256> m_table;
+};
+
+struct PlotHeatmapStats {
+    uint64_t columnsPushed = 0;
+    // texture lines written, one line holds columnFactor pushed columns
+    uint64_t linesUploaded = 0;
+    // texture update calls
+    uint64_t uploads = 0;
+};
+
+// Scrolling 2-D plot, for example latency buckets over time or a spectrogram. Every pushed
+// column is one point in time with a value per row, the newest column is drawn on the right.
+//
+// Columns are kept in a ring buffer texture with time along the texture y axis, so a column
+// is one contiguous texture line and new columns are uploaded with at most two updates per
+// frame. Scrolling only moves texture coordinates, nothing already uploaded is written again.
+//
+// When there are more rows or columns than pixels the data is downsampled by taking the
+// maximum of neighbouring cells, so short spikes stay visible.
+class PlotHeatmap : public sf::Drawable {
+  public:
+    // rows is the number of values per column, columns the number of columns shown
+    PlotHeatmap(Pos position, sf::Vector2u sizePx, uint32_t rows, uint32_t columns, Range valueRange,
+                Colormap colormap = Colormap::Viridis());
+
+    PlotHeatmap(const PlotHeatmap&) = delete;
+    PlotHeatmap& operator=(const PlotHeatmap&) = delete;
+
+    // Appends one column, the values have to contain a value for every row
+    void PushColumn(std::span<const float> values);
+
+    // Uploads columns pushed since the last call, ui thread once per frame
+    void Update();
+
+    // Size of the ring texture after downsampling, x is rows and y is columns
+    auto GetTextureSize() const -> sf::Vector2u;
+
+    // Two textured quads, valid until the next Update
+    auto GetVertices() const -> std::span<const sf::Vertex>;
+    auto GetTexture() const -> const sf::Texture&;
+
+    auto GetStats() const -> const PlotHeatmapStats&;
+
+  private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    void RebuildVertices();
+
+    Pos m_position;
+    sf::Vector2f m_size;
+    uint32_t m_rows;
+    Range m_valueRange;
+    Colormap m_colormap;
+
+    // input cells per texture cell
+    uint32_t m_rowFactor;
+    uint32_t m_columnFactor;
+    uint32_t m_textureRows;
+    uint32_t m_textureColumns;
+
+    // column being downsampled and number of input columns in it
+    std::vector<float> m_pending;
+    uint32_t m_pendingColumns;
+
+    // copy of the texture, one line per texture column
+    std::vector<uint32_t> m_pixels;
+    uint32_t m_head;
+    uint32_t m_filled;
+    uint32_t m_notUploaded;
+
+    sf::Texture m_texture;
+    std::vector<sf::Vertex> m_vertices;
+    PlotHeatmapStats m_stats;
+};
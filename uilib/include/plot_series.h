@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "rolling_stats.h"
+#include "sample_queue.h"
+
+// Samples of one plotted series. Producer threads push into GetQueue, the ui thread calls
+// Ingest once per frame to move everything pushed so far into the series storage.
+class PlotSeries {
+  public:
+    explicit PlotSeries(size_t capacityPerProducer = 64 * 1024);
+
+    // Producer threads register here, see MpscSampleQueue
+    auto GetQueue() -> MpscSampleQueue&;
+
+    // Ui thread, appends pending samples, one bulk copy per producer batch, returns sample count
+    auto Ingest() -> size_t;
+
+    auto GetSamples() const -> const std::vector<double>&;
+
+    // Replaces stored samples with one bulk copy, used when restoring a snapshot
+    void SetSamples(std::span<const double> samples);
+
+    // Keeps rolling statistics of the last window samples, updated as samples are stored so
+    // an auto scaled axis does not scan them. 0 turns them off
+    void SetRollingWindow(size_t window);
+
+    // nullptr without a rolling window
+    auto GetRollingStats() const -> const RollingStats*;
+
+  private:
+    // pushes the samples of the window at the end of the storage
+    void FillRollingStats();
+
+    MpscSampleQueue m_queue;
+    std::vector<double> m_samples;
+    std::optional<RollingStats> m_rollingStats;
+};
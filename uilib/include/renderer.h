@@ -1,14 +1,21 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <queue>
+#include <unordered_map>
 #include <vector>
 
 #include "SFML/Graphics/Drawable.hpp"
 #include "SFML/Graphics/RectangleShape.hpp"
 #include "SFML/Graphics/Text.hpp"
 
+#include "display_list.h"
+#include "frame_arena.h"
+#include "frame_profiler.h"
+#include "layer_cache.h"
 #include "rect.h"
+#include "texture_cache.h"
 #include "uielement.h"
 #include "uitree.h"
 
@@ -26,25 +33,87 @@
 class Renderer {
 
   public:
+    // Drawables of elements not drawn for this many frames are dropped, elements which are only
+    // culled or clipped for a while keep theirs
+    static constexpr uint64_t CACHE_RETAIN_FRAMES = 120;
+
     Renderer(std::queue<UiElement*>& traversalBuffer);
 
     // Main api point of this class, it returns vector of drawables that
-    // can be used to render sfml on the screen, idealy it should be
-    // very efficient and not recreate elements when not necessary
-    auto GetDrawables(UiTree* uiTree) -> std::vector<std::pair<std::string, sf::Drawable*>>;
+    // can be used to render sfml on the screen. Drawables are kept between
+    // frames and recreated only for elements whose properties changed, returned
+    // vector is owned by the renderer and valid until the next call
+    auto GetDrawables(UiTree* uiTree) -> const std::vector<std::pair<ElementId, sf::Drawable*>>&;
+
+    // Same as GetDrawables, but copies the tessellated elements into displayList so it stays
+    // valid after the tree or the renderer change. Elements keep their paint order, consecutive boxes
+    // with the same clip rect end up in one batch.
+    // Subtrees of elements cached as layers are copied from the layer cache without traversal,
+    // they are scissored to the clip of the layer root only.
+    void BuildDisplayList(UiTree* uiTree, DisplayList& displayList);
+
+    // Elements skipped in the last frame because they were fully outside the clip rect of an
+    // ancestor with clip_children. Display lists scissor partially clipped elements, drawables
+    // returned by GetDrawables are not scissored
+    auto GetCulledElementCount() const -> size_t;
+
+    // Elements with a cached drawable, including ones not drawn recently
+    auto GetCachedElementCount() const -> size_t;
+
+    // Cached layers, budget and hit rate
+    auto GetLayerCache() -> LayerCache&;
+
+    // Scratch memory for the current frame, reset at the start of every GetDrawables call
+    auto GetFrameArena() -> FrameArena&;
+
+    // Records traversal, tessellation and drawable stages into profiler, null disables it
+    void SetProfiler(FrameProfiler* profiler);
+
+    // Images of image elements in display lists, without a cache or while an image is decoding
+    // the element is drawn as a box
+    void SetTextureCache(TextureCache* textureCache);
 
   private:
-    auto CreateNewDrawable(UiElement* element) -> std::pair<std::string, sf::Drawable*>;
+    // Drawable of an element together with the state it was created from
+    struct CachedDrawable {
+        ElemType type = ElemType::Box;
+        Properties properties;
+        std::unique_ptr<Components::Rect> rect;
+        std::vector<sf::Vertex> triangles;
+        uint64_t lastFrame = 0;
+    };
+
+    // Traverses the tree and refreshes the cache, fills displayList if given, m_drawables otherwise
+    void Update(UiTree* uiTree, DisplayList* displayList);
+
+    // Appends subtree of a layer root, rebuilding the layer if it changed
+    void AppendLayer(UiElement* root, DisplayList& displayList);
+
+    // Appends element as a quad textured with the image, returns false if it is not ready
+    auto AppendImage(UiElement* element, DisplayList& displayList) -> bool;
 
-    // Currently only sync position, size and color !
-    void SyncProperties(UiElement* element, sf::Drawable* drawable);
+    // Returns cached drawable, recreating it if the element changed since the last frame
+    auto GetDrawable(UiElement* element) -> const CachedDrawable&;
+
+    // Splits the shape of a cached drawable into a triangle list
+    static void Tessellate(CachedDrawable& cached);
+
+    auto CreateNewDrawable(UiElement* element) -> std::unique_ptr<Components::Rect>;
 
     // Cleared on each iteration since it is cheap
     // and no extra allocation / deallocation is needed to do so
-    std::vector<std::pair<std::string, sf::Drawable*>> m_drawables;
+    std::vector<std::pair<ElementId, sf::Drawable*>> m_drawables;
 
     // Owned ui elements which should not be re-allocated on each
     // render pass
-    std::vector<std::unique_ptr<Components::Rect>> m_rectangles;
+    std::unordered_map<UiElement*, CachedDrawable> m_cache;
     std::vector<std::unique_ptr<sf::Text>> m_textElements;
+
+    LayerCache m_layers;
+    FrameArena m_frameArena;
+    FrameProfiler* m_profiler;
+    TextureCache* m_textureCache;
+    uint64_t m_frame;
+    size_t m_lastElementCount;
+    size_t m_culledElements;
 };
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <vector>
+
+#include "types.h"
+
+// Min, max, mean and variance of the last window samples of a series, updated in amortised
+// O(1) per pushed sample so a live axis never rescans the visible data.
+//
+// Min and max are kept in monotonic deques, every sample enters and leaves each deque at most
+// once. Mean and variance are updated with Welford's algorithm, adding the new sample and
+// removing the one leaving the window. Samples are expected to be finite.
+class RollingStats {
+  public:
+    explicit RollingStats(size_t window);
+
+    void Push(double sample);
+    void Push(std::span<const double> samples);
+
+    void Clear();
+
+    auto GetWindow() const -> size_t;
+
+    // Samples currently in the window, at most window
+    auto GetCount() const -> size_t;
+
+    // Statistics of the window, 0 if it is empty
+    auto GetMin() const -> double;
+    auto GetMax() const -> double;
+    auto GetMean() const -> double;
+    // Population variance
+    auto GetVariance() const -> double;
+
+    // Min to max, what an auto scaled axis has to show
+    auto GetRange() const -> Range;
+
+  private:
+    struct Extreme {
+        uint64_t index;
+        double value;
+    };
+
+    size_t m_window;
+    // ring of the samples in the window, the oldest one is removed from the mean
+    std::vector<double> m_samples;
+    uint64_t m_pushed;
+
+    // candidates for the minimum ascending and for the maximum descending, oldest first
+    std::deque<Extreme> m_minimums;
+    std::deque<Extreme> m_maximums;
+
+    double m_mean;
+    // sum of squared differences from the mean
+    double m_squares;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+
+// Bounded lock-free ring of plot samples with one producer and one consumer thread.
+//
+// Push copies a whole batch with at most two memcpy calls and publishes it with a single
+// release store. Drain hands the pending samples to the consumer as at most two
+// contiguous spans. Samples keep their order.
+class SpscSampleQueue {
+  public:
+    // Capacity is rounded up to a power of two
+    explicit SpscSampleQueue(size_t capacity);
+
+    SpscSampleQueue(const SpscSampleQueue&) = delete;
+    SpscSampleQueue& operator=(const SpscSampleQueue&) = delete;
+
+    // Producer side, returns number of samples pushed, less than the batch size when the queue is full
+    auto Push(std::span<const double> samples) -> size_t;
+
+    // Consumer side, passes every pending sample to append and frees the space, returns sample count
+    auto Drain(const std::function<void(std::span<const double>)>& append) -> size_t;
+
+    auto GetCapacity() const -> size_t;
+
+  private:
+    size_t m_mask;
+    std::unique_ptr<double[]> m_samples;
+
+    // written by the consumer
+    alignas(64) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+
+    // written by the producer
+    alignas(64) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+};
+
+// Queue with many producer threads and one consumer thread.
+//
+// Every producer gets its own SPSC ring, so pushing never contends with other producers
+// and samples of one producer stay in order. Registering a producer takes a lock, it is
+// done once per producer thread.
+class MpscSampleQueue {
+  public:
+    static constexpr size_t MAX_PRODUCERS = 32;
+
+    explicit MpscSampleQueue(size_t capacityPerProducer = 64 * 1024);
+
+    MpscSampleQueue(const MpscSampleQueue&) = delete;
+    MpscSampleQueue& operator=(const MpscSampleQueue&) = delete;
+
+    // Returns queue owned by the calling producer, valid for the lifetime of this object
+    auto RegisterProducer() -> SpscSampleQueue&;
+
+    // Consumer side, drains producers one after another, returns sample count
+    auto Drain(const std::function<void(std::span<const double>)>& append) -> size_t;
+
+    auto GetProducerCount() const -> size_t;
+
+  private:
+    size_t m_capacityPerProducer;
+    std::array<std::unique_ptr<SpscSampleQueue>, MAX_PRODUCERS> m_producers;
+    std::atomic<size_t> m_producerCount;
+    std::mutex m_registerMutex;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "mapped_file.h"
+#include "types.h"
+
+// Columnar time series stored on disk and plotted straight from a mapped file, without
+// parsing or copying it into heap buffers. Fixed size little endian records:
+//
+// [SeriesFileHeader]
+// [SeriesFileChunk x chunkCount]  one per chunkSize consecutive samples
+// [timestamps]                    raw doubles, ascending, 64 byte aligned
+// [values]                        raw doubles, 64 byte aligned
+//
+// Chunk records hold the time and value range of their samples, so a visible time range
+// is found from the chunk table alone and the data of other chunks is never paged in.
+
+constexpr uint32_t SERIES_FILE_MAGIC = 0x46534955; // "UISF"
+constexpr uint32_t SERIES_FILE_VERSION = 1;
+constexpr uint32_t SERIES_FILE_DEFAULT_CHUNK_SIZE = 4096;
+
+struct SeriesFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t chunkSize;
+    uint32_t chunkCount;
+    uint64_t sampleCount;
+    uint64_t chunkTableOffset;
+    uint64_t timestampOffset;
+    uint64_t valueOffset;
+    uint64_t fileSize;
+};
+
+struct SeriesFileChunk {
+    double firstTimestamp;
+    double lastTimestamp;
+    double minValue;
+    double maxValue;
+};
+
+static_assert(std::is_trivially_copyable_v<SeriesFileChunk>);
+static_assert(sizeof(SeriesFileHeader) == 56);
+static_assert(sizeof(SeriesFileChunk) == 32);
+
+// Samples of a series file, views into the mapped data
+struct SeriesSlice {
+    std::span<const double> timestamps;
+    std::span<const double> values;
+};
+
+// Writes both columns straight from the spans. Timestamps have to be ascending and there has
+// to be one for every value, throws std::runtime_error otherwise or if the stream fails
+void WriteSeries(std::span<const double> timestamps, std::span<const double> values, std::ostream& out,
+                 uint32_t chunkSize = SERIES_FILE_DEFAULT_CHUNK_SIZE);
+void WriteSeriesFile(std::span<const double> timestamps, std::span<const double> values,
+                     const std::filesystem::path& path, uint32_t chunkSize = SERIES_FILE_DEFAULT_CHUNK_SIZE);
+
+// Converts "timestamp,value" lines, the first line is skipped if it is not numeric (a column
+// header). Returns number of samples, throws std::runtime_error naming the first bad line
+auto ConvertCsvToSeries(std::string_view csv, std::ostream& out, uint32_t chunkSize = SERIES_FILE_DEFAULT_CHUNK_SIZE)
+    -> uint64_t;
+auto ConvertCsvToSeriesFile(const std::filesystem::path& csvPath, const std::filesystem::path& seriesPath,
+                            uint32_t chunkSize = SERIES_FILE_DEFAULT_CHUNK_SIZE) -> uint64_t;
+
+// Read only series file. Only the header and chunk table are validated when opening, the
+// columns are paged in by the system as they are read.
+class SeriesFile {
+  public:
+    // Maps the file, throws std::runtime_error if it can not be mapped or is malformed
+    explicit SeriesFile(const std::filesystem::path& path);
+
+    // View of series file bytes which have to outlive it, throws std::runtime_error if malformed
+    explicit SeriesFile(std::span<const std::byte> data);
+
+    auto GetSampleCount() const -> uint64_t;
+    auto GetChunkSize() const -> uint32_t;
+    auto GetChunks() const -> std::span<const SeriesFileChunk>;
+
+    // Whole series
+    auto GetSamples() const -> SeriesSlice;
+
+    // Samples with timestamps in [timeRange.start, timeRange.end]. Chunks outside of the range
+    // are skipped using the chunk table, only the boundary chunks are searched
+    auto GetSlice(Range timeRange) const -> SeriesSlice;
+
+    // Value range of the chunks overlapping the time range, from the chunk table only. May be
+    // wider than the exact range of GetSlice, start > end if no chunk overlaps
+    auto GetValueRange(Range timeRange) const -> Range;
+
+  private:
+    void Parse(std::span<const std::byte> data);
+
+    // first and one past the last chunk overlapping the time range
+    auto FindChunks(Range timeRange) const -> std::pair<size_t, size_t>;
+
+    std::optional<MappedFile> m_file;
+    uint32_t m_chunkSize;
+    std::span<const SeriesFileChunk> m_chunks;
+    std::span<const double> m_timestamps;
+    std::span<const double> m_values;
+};
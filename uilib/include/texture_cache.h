@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include "element_id.h"
+#include "image_decoder.h"
+
+// Part of a texture an image was uploaded to, rect is in texels
+struct TextureRegion {
+    const sf::Texture* texture = nullptr;
+    sf::FloatRect rect;
+};
+
+struct TextureCacheStats {
+    uint64_t hits = 0;
+    // lookups which started decoding, lookups while the image is still decoding are not counted
+    uint64_t misses = 0;
+    // images dropped to stay in the budget, every image of an evicted atlas counts
+    uint64_t evictions = 0;
+    uint64_t decodeFailures = 0;
+    // images which did not fit into the budget on their own and stay placeholders
+    uint64_t oversized = 0;
+    // atlas pages copied because new images had to be packed while the render thread could still draw them
+    uint64_t atlasCopies = 0;
+    size_t textureCount = 0;
+    size_t atlasCount = 0;
+    // evicted or replaced textures kept until the render thread is done with every frame drawing them
+    size_t retiredCount = 0;
+    size_t usedBytes = 0;
+
+    auto GetHitRate() const -> double;
+};
+
+// Decoded images of image elements, uploaded as textures.
+//
+// Sources are decoded by a background ImageDecoder, until then lookups return nullptr and
+// the element is drawn as a placeholder. Small images are packed into shared atlas pages so
+// icons from one page are drawn in one batch, bigger images get their own texture. When the
+// textures grow over the memory budget, least recently used ones are evicted, an atlas page
+// is evicted as a whole.
+//
+// Everything except the decoding runs on the ui thread. Display lists are drawn by the render thread
+// while the next frame is built, so a texture is destroyed only after the render thread acquired a
+// list built after the texture was last drawn, and images are never packed into an atlas page
+// such a list may still draw, the page is copied first.
+class TextureCache {
+  public:
+    // Images up to this size in both dimensions go into atlas pages
+    static constexpr unsigned MAX_ATLAS_IMAGE_SIZE = 64;
+    static constexpr unsigned ATLAS_SIZE = 1024;
+
+    explicit TextureCache(size_t budgetBytes = 64 * 1024 * 1024, size_t decodeThreads = 2,
+                          DecodeImageCallback decode = nullptr);
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // Image shown by an image element, decoding starts when the element is first drawn
+    void SetImage(ElementId element, std::string source);
+
+    // Image of an element, nullptr if none is set or it is not ready
+    auto GetImage(ElementId element) -> const TextureRegion*;
+
+    // Uploaded image, nullptr if it is not ready, the first lookup starts decoding. Returned
+    // region is valid until the next Update, the texture until the frame it was drawn in is released
+    auto Find(const std::string& source) -> const TextureRegion*;
+
+    // Uploads images decoded since the last call, evicts over the budget and destroys retired
+    // textures, called by the ui thread once per frame before building the display list. frame is
+    // the sequence number the list is published with, readFrame the number of the oldest list the
+    // render thread may still draw, see TripleBuffer::GetReadSequence
+    void Update(uint64_t frame, uint64_t readFrame);
+
+    // Update for display lists which are drawn before the next one is built
+    void Update();
+
+    // Evicts textures until the cache fits
+    void SetBudget(size_t budgetBytes);
+
+    // Images submitted for decoding which were not uploaded yet
+    auto GetPendingCount() const -> size_t;
+
+    auto GetStats() const -> const TextureCacheStats&;
+
+  private:
+    // Row of images of similar height inside an atlas page
+    struct Shelf {
+        unsigned top;
+        unsigned height;
+        unsigned used;
+    };
+
+    // Own texture of one big image or an atlas page shared by small images
+    struct Allocation {
+        std::unique_ptr<sf::Texture> texture;
+        size_t bytes;
+        std::vector<std::string> sources;
+        // empty for standalone textures
+        std::vector<Shelf> shelves;
+        bool atlas;
+        // last frame whose display list may draw the texture, 0 if none did
+        uint64_t lastFrame = 0;
+    };
+
+    enum class State : uint8_t { Decoding, Ready, Failed };
+
+    struct Entry {
+        State state = State::Decoding;
+        TextureRegion region;
+        std::list<Allocation>::iterator allocation;
+    };
+
+    void Upload(const std::string& source, Entry& entry, const sf::Image& image);
+    auto UploadToAtlas(const std::string& source, Entry& entry, const sf::Image& image) -> bool;
+
+    // Reserves space for size in the page, nullopt if it is full
+    static auto Pack(Allocation& page, sf::Vector2u size) -> std::optional<sf::Vector2u>;
+
+    // True while a display list the render thread may still draw was built in lastFrame
+    auto IsInFlight(uint64_t lastFrame) const -> bool;
+
+    // Replaces the texture of an atlas page with a copy only the ui thread uses, the old one is retired
+    void CopyPage(Allocation& page);
+
+    void Evict(std::list<Allocation>::iterator allocation);
+    void EvictUntil(size_t budgetBytes);
+
+    size_t m_budgetBytes;
+    uint64_t m_frame;
+    uint64_t m_readFrame;
+
+    // most recently used in front
+    std::list<Allocation> m_allocations;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::unordered_map<ElementId, std::string> m_elementImages;
+
+    // evicted and copied textures with the last frame they were drawn in
+    std::vector<std::pair<uint64_t, std::unique_ptr<sf::Texture>>> m_retired;
+
+    TextureCacheStats m_stats;
+    ImageDecoder m_decoder;
+};
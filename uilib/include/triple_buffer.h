@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer / single consumer hand-off of the latest value.
+//
+// Producer fills GetWriteBuffer and calls Publish, consumer calls Acquire and reads
+// GetReadBuffer. Neither side ever waits: the producer always has a free slot to
+// write into and the consumer keeps reading its slot until a newer one is published.
+// Values that were published but never acquired are skipped. A consumer that has nothing
+// to do without a new value can block in WaitForPublish.
+//
+// Published values are numbered from 1. Once the consumer acquired value n it never reads a value
+// published before n again, so the producer can free resources only those values referenced.
+template <typename T> class TripleBuffer {
+  public:
+    TripleBuffer()
+        : m_slots{}
+        , m_back(BACK_INITIAL)
+        , m_write(0)
+        , m_read(2)
+        , m_sequences{}
+        , m_published(0)
+        , m_readSequence(0)
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer side, slot is owned by the producer until Publish
+    auto GetWriteBuffer() -> T&
+    {
+        return m_slots[m_write];
+    }
+
+    // Producer side, makes the write buffer the latest value and takes over the old back slot
+    void Publish()
+    {
+        m_sequences[m_write] = ++m_published;
+        const auto previous = m_back.exchange(m_write | FRESH, std::memory_order_acq_rel);
+        m_write = previous & INDEX_MASK;
+        m_back.notify_one();
+    }
+
+    // Consumer side, blocks until there is a published value which was not acquired yet
+    void WaitForPublish() const
+    {
+        auto back = m_back.load(std::memory_order_acquire);
+        while ((back & FRESH) == 0) {
+            m_back.wait(back, std::memory_order_acquire);
+            back = m_back.load(std::memory_order_acquire);
+        }
+    }
+
+    // Consumer side, swaps in the latest published value, returns false if nothing new was published
+    auto Acquire() -> bool
+    {
+        if ((m_back.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+
+        const auto previous = m_back.exchange(m_read, std::memory_order_acq_rel);
+        m_read = previous & INDEX_MASK;
+        m_readSequence.store(m_sequences[m_read], std::memory_order_release);
+        return true;
+    }
+
+    // Producer side, number the write buffer is published with
+    auto GetWriteSequence() const -> uint64_t
+    {
+        return m_published + 1;
+    }
+
+    // Either side, number of the value the consumer reads, 0 before the first Acquire
+    auto GetReadSequence() const -> uint64_t
+    {
+        return m_readSequence.load(std::memory_order_acquire);
+    }
+
+    // Consumer side, valid until the next Acquire
+    auto GetReadBuffer() const -> const T&
+    {
+        return m_slots[m_read];
+    }
+
+  private:
+    static constexpr uint8_t INDEX_MASK = 0b11;
+    static constexpr uint8_t FRESH = 0b100;
+    static constexpr uint8_t BACK_INITIAL = 1;
+
+    std::array<T, 3> m_slots;
+
+    // slot index shared between the threads, FRESH bit is set when it holds an unread value
+    alignas(64) std::atomic<uint8_t> m_back;
+
+    // only touched by the producer
+    alignas(64) uint8_t m_write;
+
+    // only touched by the consumer
+    alignas(64) uint8_t m_read;
+
+    // number of the value in each slot, written by the producer before the slot is published
+    std::array<uint64_t, 3> m_sequences;
+    uint64_t m_published;
+
+    // written by the consumer, read by the producer
+    alignas(64) std::atomic<uint64_t> m_readSequence;
+};
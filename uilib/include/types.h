@@ -1,6 +1,8 @@
 #pragma once
 
-enum ElemType { Text, Box, Window };
+#include <cstdint>
+
+enum ElemType : uint8_t { Text, Box, Window, Image };
 
 enum CircleSide { Top, Bottom };
 
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "plot_series.h"
+#include "uitree.h"
+
+// Snapshot of a whole ui tree and plot series, written when the process stops and
+// restored on the next start instead of rebuilding the tree and replaying the data.
+// Fixed size little endian records, a mapped file is read without parsing:
+//
+// [UiSnapshotHeader]
+// [UiSnapshotElement x elementCount]  pre-order, the root first
+// [string table]                      element and series names, not null terminated
+// [UiSnapshotSeries x seriesCount]
+// [samples]                           raw doubles of every series, 64 byte aligned
+//
+// Properties are stored as they are in memory, the version has to change with their layout.
+
+constexpr uint32_t UI_SNAPSHOT_MAGIC = 0x4e534955; // "UISN"
+constexpr uint32_t UI_SNAPSHOT_VERSION = 1;
+constexpr uint32_t UI_SNAPSHOT_NO_PARENT = UINT32_MAX;
+
+struct UiSnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t elementCount;
+    uint32_t elementTableOffset;
+    uint32_t stringTableOffset;
+    uint32_t stringTableSize;
+    uint32_t seriesCount;
+    uint32_t seriesTableOffset;
+    uint64_t fileSize;
+};
+
+enum UiSnapshotElementFlags : uint8_t {
+    UI_SNAPSHOT_CACHED_AS_LAYER = 1,
+};
+
+struct UiSnapshotElement {
+    uint32_t parent;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint8_t type;
+    uint8_t flags;
+    uint8_t padding[2];
+    Properties properties;
+};
+
+struct UiSnapshotSeries {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint64_t sampleCount;
+    uint64_t dataOffset;
+};
+
+static_assert(std::is_trivially_copyable_v<Properties>);
+static_assert(sizeof(UiSnapshotHeader) == 40);
+static_assert(sizeof(UiSnapshotElement) == 48);
+static_assert(sizeof(UiSnapshotSeries) == 24);
+
+// Plot series stored in a snapshot under a name, names have to be unique
+struct NamedPlotSeries {
+    std::string_view name;
+    PlotSeries* series;
+};
+
+// Writes the tree and the series in one pass, samples are streamed from the series storage
+// without copying. Throws std::runtime_error if the stream fails
+void WriteUiSnapshot(UiTree& uiTree, std::span<const NamedPlotSeries> series, std::ostream& out);
+void WriteUiSnapshotFile(UiTree& uiTree, std::span<const NamedPlotSeries> series, const std::filesystem::path& path);
+
+// Replaces the children and properties of the tree root and the samples of series stored under
+// the same name, series missing in the snapshot are left untouched. Returns number of restored
+// series, throws std::runtime_error without touching the tree if the data is malformed
+auto LoadUiSnapshot(std::span<const std::byte> data, UiTree& uiTree, std::span<const NamedPlotSeries> series)
+    -> size_t;
+auto LoadUiSnapshotFile(const std::filesystem::path& path, UiTree& uiTree, std::span<const NamedPlotSeries> series)
+    -> size_t;
@@ -2,27 +2,42 @@
 
 #include <cstdint>
 #include <memory>
+#include <memory_resource>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "block_pool.h"
+#include "element_id.h"
 #include "types.h"
 
 constexpr size_t MAX_CHILDREN = 100;
 constexpr size_t MAX_ALL_CHILDREN = 10000;
 
-enum LayoutDirection { Horizontal, Vertical };
+enum LayoutDirection : uint8_t { Horizontal, Vertical };
 
 struct BoundingBox {
     float left = 0;
     float top = 0;
     float right = 0;
     float bottom = 0;
+
+    // Area covered by both boxes, empty if they do not overlap
+    auto Intersect(const BoundingBox& other) const -> BoundingBox;
+    bool IsEmpty() const;
+
+    // False only if the box lies fully outside, touching and zero sized boxes count as inside
+    bool Overlaps(const BoundingBox& other) const;
+
+    bool operator==(const BoundingBox&) const = default;
 };
 
 struct Position {
     float x;
     float y;
+
+    bool operator==(const Position&) const = default;
 };
 
 struct Color {
@@ -30,35 +45,76 @@ struct Color {
     uint8_t green = 0;
     uint8_t blue = 0;
     uint8_t alpha = 255;
+
+    bool operator==(const Color&) const = default;
 };
 
+// Ordered by size, the one byte fields share the last word, 32 bytes in total
 // clang-format off
 struct Properties {
     float               width = 0;
     float               height = 0;
     float               border_radius_px = 0;
     float               border_width = 0;
+    Position            position = {0, 0};
+    Color               color = {0, 0, 0};
     bool                border = false;
     bool                hidden = false;
     LayoutDirection     layout_children = LayoutDirection::Horizontal;
-    Position            position = {0, 0};
-    Color               color = {0, 0, 0};
+    // descendants are cut to the bounds of the element
+    bool                clip_children = false;
+
+    bool operator==(const Properties&) const = default;
 };
 // clang-format on
 
+static_assert(sizeof(Properties) == 32);
+
 // TO ADD: background color,  border, etc ...
 class UiElement {
   public:
-    explicit UiElement(const std::string& name, ElemType isText);
+    // Name is interned, elements keep only its id
+    explicit UiElement(std::string_view name, ElemType isText);
+    explicit UiElement(ElementId id, ElemType isText);
 
     ~UiElement() {}
 
-    // Get the name of the ui element
-    auto GetName() const -> const std::string&;
+    // Elements are allocated from a shared node pool instead of the global heap
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
+
+    // Pool all ui elements are allocated from
+    static auto GetNodePool() -> BlockPool&;
+
+    auto GetId() const -> ElementId;
+
+    // Get the name of the ui element, meant for debugging, use the id for lookups
+    auto GetName() const -> std::string_view;
 
     // Adds a child to this element
     void AddChild(std::unique_ptr<UiElement> child);
 
+    // Adds multiple children at once, children are rearranged only once
+    void AddChildren(std::vector<std::unique_ptr<UiElement>> children);
+
+    // Adds children without rearranging them, caller is responsible for
+    // calling RearrangeChildren once all changes are done
+    void AttachChildren(std::vector<std::unique_ptr<UiElement>> children);
+
+    // Removes listed immediate children with their descendants without rearranging,
+    // returns number of removed children
+    auto DetachChildren(const std::vector<UiElement*>& children) -> size_t;
+
+    // Removes immediate child from this element without destroying it,
+    // returns nullptr if the element is not an immediate child
+    auto ReleaseChild(UiElement* child) -> std::unique_ptr<UiElement>;
+
+    // Changes order of immediate children, order has to contain every child exactly once
+    void ReorderChildren(const std::vector<UiElement*>& order);
+
+    // Positions and sizes immediate children based on layout direction
+    void RearrangeChildren();
+
     // Sets parent of the element
     void SetParent(UiElement* parent);
 
@@ -67,11 +123,11 @@ class UiElement {
 
     // removes a child and all of its descendants from the tree
     // returns false if child not found
-    bool RemoveChild(std::vector<UiElement*>& traversalBuffer, const std::string& childName);
+    bool RemoveChild(std::vector<UiElement*>& traversalBuffer, ElementId id);
 
     // removes immediate child from the element
     // returns false if immediate child not found
-    bool RemoveImmediateChild(const std::string& childName);
+    bool RemoveImmediateChild(ElementId id);
 
     // remove immediate children of the ui element, immediate children need to
     // have 0 children, otherwise it throws
@@ -80,6 +136,9 @@ class UiElement {
     // Get all children, returns empty vector if none present
     auto GetAllChildren() const -> std::vector<UiElement*>;
 
+    // Number of children the element has memory reserved for
+    auto GetChildrenCapacity() const -> size_t;
+
     // travese the whole tree with calling element being a root
     // return an empty vector if there are no children
     auto GetAllDescendants(std::vector<UiElement*>& traversalBuffer) -> std::vector<UiElement*>;
@@ -89,23 +148,53 @@ class UiElement {
     // if no children are found returns an empty vector
     auto GetAllDescendantsBreathFirst(std::queue<UiElement*>& traversalBuffer) -> std::vector<UiElement*>;
 
-    // Returns true if element has a child with a name
-    bool HasChild(std::vector<UiElement*>& traversalBuffer, const std::string name);
+    // Same order as above, but written into elements which works as the queue itself,
+    // with elements backed by a frame arena the traversal does not touch the heap.
+    // With skipLayerSubtrees descendants of elements cached as layers are left out.
+    void GetAllDescendantsBreathFirst(std::pmr::vector<UiElement*>& elements, bool skipLayerSubtrees = false);
+
+    // Same traversal keeping the clip rects of elements with clip_children. clipRects works as the
+    // stack of active clips, it has to hold one rect the root is clipped to, every clipping element
+    // pushes the intersection of its bounds with its own clip. elementClips[i] is the index of the rect
+    // elements[i] is clipped to. Children of an element whose clip rect is empty are not visited.
+    void GetAllDescendantsBreathFirst(std::pmr::vector<UiElement*>& elements,
+                                      std::pmr::vector<uint32_t>& elementClips,
+                                      std::pmr::vector<BoundingBox>& clipRects, bool skipLayerSubtrees = false);
 
-    // Get child with specific name, returns nullptr if not found
-    auto GetChild(std::vector<UiElement*>& traversalBuffer, const std::string name) -> UiElement*;
+    // Returns true if element has a child with an id
+    bool HasChild(std::vector<UiElement*>& traversalBuffer, ElementId id);
+    bool HasChild(std::vector<UiElement*>& traversalBuffer, std::string_view name);
+
+    // Get child with specific id, returns nullptr if not found
+    auto GetChild(std::vector<UiElement*>& traversalBuffer, ElementId id) -> UiElement*;
+    auto GetChild(std::vector<UiElement*>& traversalBuffer, std::string_view name) -> UiElement*;
 
     auto GetElementType() -> ElemType;
 
+    // Rectangle covered by the element on screen
+    auto GetBounds() const -> BoundingBox;
+
+    // Marks element and its ancestors as changed. Structural changes, layout and transactions
+    // call it, direct writes to properties inside a cached layer have to call it too
+    void Invalidate();
+
+    // Changes whenever anything in the subtree is invalidated, values are never reused
+    // between elements, so a cached version stays unique even if the element memory is reused
+    auto GetSubtreeVersion() const -> uint64_t;
+
+    // Subtree of the element is rendered once and reused until it is invalidated
+    void SetCachedAsLayer(bool cached);
+    auto IsCachedAsLayer() const -> bool;
+
     Properties properties;
 
   private:
-    void RearrangeChildren();
-
     bool IsText();
-    ElemType m_elementType;
-
+    // children grow on demand, most elements are leaves
     std::vector<std::unique_ptr<UiElement>> m_children;
     UiElement* m_parent;
-    std::string m_name;
+    uint64_t m_subtreeVersion;
+    ElementId m_id;
+    ElemType m_elementType;
+    bool m_cachedAsLayer;
 };
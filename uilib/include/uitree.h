@@ -1,6 +1,7 @@
 #pragma once
 
 #include "uielement.h"
+#include "uitree_transaction.h"
 #include <X11/extensions/randr.h>
 #include <memory>
 #include <queue>
@@ -10,6 +11,24 @@ struct Size {
     uint16_t height;
 };
 
+// Memory held by a tree, in bytes
+struct UiTreeMemoryUsage {
+    size_t elementCount = 0;
+    // element objects themselves
+    size_t elements = 0;
+    // children vectors, allocated separately from the elements
+    size_t children = 0;
+    // traversal buffers owned by the tree
+    size_t traversalBuffers = 0;
+    // shared by all trees, reported but not counted per element
+    size_t nodePoolReserved = 0;
+    size_t internedNames = 0;
+
+    // Memory owned by this tree
+    auto GetTotal() const -> size_t;
+    auto GetBytesPerElement() const -> double;
+};
+
 // Convenience class for working with ui tree elements, provides a cleaner api
 class UiTree {
   public:
@@ -19,20 +38,37 @@ class UiTree {
     auto GetRoot() -> UiElement*;
 
     // removes a child and all of its descendants from the tree
-    void RemoveChild(const std::string& elementName);
+    void RemoveChild(ElementId id);
+    void RemoveChild(std::string_view elementName);
 
     // Get all children, returns empty vector if none present
-    auto GetImmediateChildren(const std::string& elementName) -> std::vector<UiElement*>;
+    auto GetImmediateChildren(std::string_view elementName) -> std::vector<UiElement*>;
 
     auto GetAllDescendantsDepthFirst() -> std::vector<UiElement*>;
 
     auto GetAllDescendantsBreathFirst() -> std::vector<UiElement*>;
 
-    // Returns true if element has a child with a name
-    bool HasChild(const std::string& name);
+    // Breadth first traversal into a caller provided buffer, see UiElement
+    void GetAllDescendantsBreathFirst(std::pmr::vector<UiElement*>& elements, bool skipLayerSubtrees = false);
+
+    // Breadth first traversal keeping clip rects, see UiElement
+    void GetAllDescendantsBreathFirst(std::pmr::vector<UiElement*>& elements,
+                                      std::pmr::vector<uint32_t>& elementClips,
+                                      std::pmr::vector<BoundingBox>& clipRects, bool skipLayerSubtrees = false);
+
+    // Returns true if element has a child with an id or name
+    bool HasChild(ElementId id);
+    bool HasChild(std::string_view name);
+
+    // Get child with specific id or name, returns nullptr if not found
+    auto GetChild(ElementId id) -> UiElement*;
+    auto GetChild(std::string_view name) -> UiElement*;
+
+    // Starts collecting mutations which are applied together on commit
+    auto BeginTransaction() -> UiTreeTransaction;
 
-    // Get child with specific name, returns nullptr if not found
-    auto GetChild(const std::string& name) -> UiElement*;
+    // Walks the whole tree, meant for diagnostics
+    auto GetMemoryUsage() -> UiTreeMemoryUsage;
 
   private:
     std::unique_ptr<UiElement> m_root;
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "uielement.h"
+
+class UiTree;
+
+enum class PropertyField : uint8_t {
+    Width,
+    Height,
+    BorderRadius,
+    BorderWidth,
+    Border,
+    Hidden,
+    LayoutChildren,
+    ClipChildren,
+    Position,
+    Color,
+};
+
+// Value has to match the type of the field, mismatched commands are dropped
+using PropertyValue = std::variant<float, bool, LayoutDirection, Position, Color>;
+
+struct SetPropertyCommand {
+    ElementId element;
+    PropertyField field;
+    PropertyValue value;
+};
+
+struct AddChildCommand {
+    ElementId parent;
+    ElementId child;
+    ElemType type;
+    Properties properties;
+};
+
+struct RemoveSubtreeCommand {
+    ElementId element;
+};
+
+using UiTreeCommand = std::variant<SetPropertyCommand, AddChildCommand, RemoveSubtreeCommand>;
+
+// Result of applying one batch of commands
+struct UiTreeCommandStats {
+    size_t applied = 0;
+    // property writes overwritten by a later write to the same field in the batch
+    size_t coalesced = 0;
+    // commands addressing elements which do not exist or were removed, or with mismatched values
+    size_t dropped = 0;
+    // the tree was changed outside the queue since the last batch, so its elements were indexed again
+    bool reindexed = false;
+};
+
+// Mutations of the ui tree posted from any thread and applied by the ui thread.
+//
+// Posting only takes a short lock to append the command. The ui thread takes the whole
+// batch at the start of a frame and applies it through one UiTreeTransaction, so
+// the tree itself is never locked and layout runs once per touched subtree.
+//
+// Elements are addressed by id. Commands of one thread are applied in the order
+// they were posted, commands for elements which are gone are dropped silently since
+// the posting thread can not react to them anyway. Ids are looked up in an index the
+// queue keeps up to date with its own additions and removals, the whole tree is walked
+// again only when its subtree version shows it was changed by something else.
+class UiTreeCommandQueue {
+  public:
+    UiTreeCommandQueue() = default;
+
+    UiTreeCommandQueue(const UiTreeCommandQueue&) = delete;
+    UiTreeCommandQueue& operator=(const UiTreeCommandQueue&) = delete;
+
+    // Any thread
+    void Post(UiTreeCommand command);
+    void SetProperty(ElementId element, PropertyField field, PropertyValue value);
+    void AddChild(ElementId parent, ElementId child, ElemType type, const Properties& properties = {});
+    void RemoveSubtree(ElementId element);
+
+    // Ui thread, applies all commands posted so far, rethrows std::runtime_error of
+    // the transaction commit, in that case the batch is discarded and the tree is unchanged
+    auto Apply(UiTree& uiTree) -> UiTreeCommandStats;
+
+    // Number of commands waiting for Apply
+    auto GetPendingCount() const -> size_t;
+
+  private:
+    void Reindex(UiTree& uiTree);
+
+    mutable std::mutex m_mutex;
+    std::vector<UiTreeCommand> m_commands;
+
+    // batch being applied, kept to reuse its capacity
+    std::vector<UiTreeCommand> m_applying;
+
+    // elements of the tree the queue was last applied to, only touched by the ui thread
+    std::unordered_map<ElementId, UiElement*> m_elements;
+    const UiElement* m_indexedRoot = nullptr;
+    // subtree version of the root right after the last batch was committed
+    uint64_t m_indexedVersion = 0;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "uielement.h"
+
+class UiTree;
+
+// Collects mutations of the ui tree and applies them at once.
+//
+// UiElement::AddChild rearranges the parent on every call, so building a big
+// tree child by child repeats the same layout work over and over. Transaction
+// queues everything, checks the tree invariants once and runs layout only
+// once for every subtree that was touched on Commit.
+//
+// Elements are addressed by pointer, elements added in the same transaction
+// can be used as parents for later insertions.
+class UiTreeTransaction {
+  public:
+    explicit UiTreeTransaction(UiTree& uiTree);
+
+    // Queues insertion of child under parent
+    void AddChild(UiElement* parent, std::unique_ptr<UiElement> child);
+
+    // Queues removal of element and all of its descendants
+    void RemoveChild(UiElement* element);
+
+    // Queues moving of element with its descendants under new parent, element is appended
+    // as the last child
+    void MoveChild(UiElement* element, UiElement* newParent);
+
+    // Queues new order of parent children, order has to contain all children the parent
+    // has after the other queued operations are applied
+    void ReorderChildren(UiElement* parent, std::vector<UiElement*> order);
+
+    // Queues replacement of element properties, last write wins
+    void SetProperties(UiElement* element, const Properties& properties);
+
+    // Number of queued operations
+    auto GetSize() const -> size_t;
+
+    // Validates and applies queued operations, throws std::runtime_error without
+    // changing the tree if the result would be invalid
+    void Commit();
+
+  private:
+    struct Insertion {
+        UiElement* parent;
+        std::unique_ptr<UiElement> child;
+    };
+
+    struct Move {
+        UiElement* element;
+        UiElement* newParent;
+    };
+
+    struct Reorder {
+        UiElement* parent;
+        std::vector<UiElement*> order;
+    };
+
+    struct PropertyChange {
+        UiElement* element;
+        Properties properties;
+    };
+
+    void Validate() const;
+    void ValidateReorders(const std::unordered_map<UiElement*, UiElement*>& pendingParents,
+                          const std::unordered_set<UiElement*>& removed) const;
+
+    UiTree* m_uiTree;
+    std::vector<Insertion> m_insertions;
+    std::vector<UiElement*> m_removals;
+    std::vector<Move> m_moves;
+    std::vector<Reorder> m_reorders;
+    std::vector<PropertyChange> m_propertyChanges;
+};
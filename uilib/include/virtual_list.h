@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+#include "uielement.h"
+
+// Creates the empty subtree of one pooled row
+using CreateRowCallback = std::function<std::unique_ptr<UiElement>(ElementId id)>;
+
+// Fills a pooled row with content of a data row. Position and size of the row element are
+// already set, descendants should be laid out relative to it
+using BindRowCallback = std::function<void(size_t row, UiElement& rowElement)>;
+
+struct VirtualListStats {
+    // row subtrees ever created for the pool
+    uint64_t rowsCreated = 0;
+    // calls of the bind callback
+    uint64_t rowsBound = 0;
+    // rows moved on scroll without binding them again
+    uint64_t rowsMoved = 0;
+};
+
+// Vertical list of fixed height rows with content provided by a callback.
+//
+// Only rows in the viewport of the container plus an overscan margin on each side exist as
+// elements. Row r always lives in pool slot r % poolSize, so scrolling by a few rows binds
+// only the rows that came into view, the rest is moved. Scroll offset maps to the first
+// visible row by division, hidden rows are never touched.
+//
+// Container has to stay alive while the list is used and its children are managed by the list.
+class VirtualList {
+  public:
+    explicit VirtualList(UiElement* container, float rowHeight, BindRowCallback bindRow, size_t overscan = 4,
+                         CreateRowCallback createRow = nullptr);
+
+    VirtualList(const VirtualList&) = delete;
+    VirtualList& operator=(const VirtualList&) = delete;
+
+    // Number of data rows, scroll offset is clamped to the new content height
+    void SetRowCount(size_t rowCount);
+    auto GetRowCount() const -> size_t;
+
+    // Rows already bound are bound again on the next Update, for when the data itself changed
+    void Refresh();
+
+    // Offset of the viewport top from the first row in pixels, clamped to the content
+    void ScrollTo(double offset);
+    void ScrollBy(double delta);
+    auto GetScrollOffset() const -> double;
+    auto GetMaxScrollOffset() const -> double;
+
+    // First row at least partially inside the viewport
+    auto GetFirstVisibleRow() const -> size_t;
+
+    // Data row under vertical screen coordinate y, nullopt outside of the rows
+    auto GetRowAt(float y) const -> std::optional<size_t>;
+
+    // Pooled element showing the data row, nullptr if the row is not materialized
+    auto GetRowElement(size_t row) const -> UiElement*;
+
+    // Resizes the pool to the container height, binds rows which came into view and
+    // positions the rest, call once per frame before rendering. Throws std::runtime_error
+    // if the viewport needs more rows than an element can have children
+    void Update();
+
+    // Number of row subtrees currently in the tree
+    auto GetMaterializedRowCount() const -> size_t;
+
+    auto GetStats() const -> const VirtualListStats&;
+
+  private:
+    static constexpr size_t UNBOUND = SIZE_MAX;
+
+    struct Slot {
+        UiElement* element;
+        size_t row;
+    };
+
+    auto GetViewportHeight() const -> double;
+    void ResizePool(size_t poolSize);
+    void MoveSubtree(UiElement* element, float deltaY);
+
+    UiElement* m_container;
+    float m_rowHeight;
+    size_t m_overscan;
+    BindRowCallback m_bindRow;
+    CreateRowCallback m_createRow;
+
+    size_t m_rowCount;
+    // double, float loses whole pixels past 16M which is less than a million rows
+    double m_scrollOffset;
+
+    std::vector<Slot> m_slots;
+    std::pmr::vector<UiElement*> m_subtree;
+    VirtualListStats m_stats;
+};
@@ -0,0 +1,246 @@
+#include "input_recording.h"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#include "mapped_file.h"
+
+namespace {
+
+template <typename T> auto GetModifiers(const T& key) -> uint8_t
+{
+    return (key.alt ? RECORDED_ALT : 0) | (key.control ? RECORDED_CONTROL : 0) | (key.shift ? RECORDED_SHIFT : 0) |
+           (key.system ? RECORDED_SYSTEM : 0);
+}
+
+template <typename T> auto ToKeyEvent(const RecordedEvent& event) -> T
+{
+    auto key = T{};
+    key.code = static_cast<sf::Keyboard::Key>(event.code);
+    key.scancode = sf::Keyboard::Scancode::Unknown;
+    key.alt = event.modifiers & RECORDED_ALT;
+    key.control = event.modifiers & RECORDED_CONTROL;
+    key.shift = event.modifiers & RECORDED_SHIFT;
+    key.system = event.modifiers & RECORDED_SYSTEM;
+    return key;
+}
+
+auto MakeEvent(RecordedEventType type, uint64_t timeMicroseconds) -> RecordedEvent
+{
+    return RecordedEvent{timeMicroseconds, type, 0, 0, 0, 0, 0};
+}
+
+} // namespace
+
+auto ToRecordedEvent(const sf::Event& event, uint64_t timeMicroseconds) -> std::optional<RecordedEvent>
+{
+    if (event.is<sf::Event::Closed>()) {
+        return MakeEvent(RecordedEventType::Closed, timeMicroseconds);
+    }
+
+    if (const auto* resized = event.getIf<sf::Event::Resized>()) {
+        auto record = MakeEvent(RecordedEventType::Resized, timeMicroseconds);
+        record.x = static_cast<int32_t>(resized->size.x);
+        record.y = static_cast<int32_t>(resized->size.y);
+        return record;
+    }
+
+    if (const auto* key = event.getIf<sf::Event::KeyPressed>()) {
+        auto record = MakeEvent(RecordedEventType::KeyPressed, timeMicroseconds);
+        record.code = static_cast<int16_t>(key->code);
+        record.modifiers = GetModifiers(*key);
+        return record;
+    }
+
+    if (const auto* key = event.getIf<sf::Event::KeyReleased>()) {
+        auto record = MakeEvent(RecordedEventType::KeyReleased, timeMicroseconds);
+        record.code = static_cast<int16_t>(key->code);
+        record.modifiers = GetModifiers(*key);
+        return record;
+    }
+
+    if (const auto* moved = event.getIf<sf::Event::MouseMoved>()) {
+        auto record = MakeEvent(RecordedEventType::MouseMoved, timeMicroseconds);
+        record.x = moved->position.x;
+        record.y = moved->position.y;
+        return record;
+    }
+
+    if (const auto* pressed = event.getIf<sf::Event::MouseButtonPressed>()) {
+        auto record = MakeEvent(RecordedEventType::MouseButtonPressed, timeMicroseconds);
+        record.code = static_cast<int16_t>(pressed->button);
+        record.x = pressed->position.x;
+        record.y = pressed->position.y;
+        return record;
+    }
+
+    if (const auto* released = event.getIf<sf::Event::MouseButtonReleased>()) {
+        auto record = MakeEvent(RecordedEventType::MouseButtonReleased, timeMicroseconds);
+        record.code = static_cast<int16_t>(released->button);
+        record.x = released->position.x;
+        record.y = released->position.y;
+        return record;
+    }
+
+    if (const auto* scrolled = event.getIf<sf::Event::MouseWheelScrolled>()) {
+        auto record = MakeEvent(RecordedEventType::MouseWheelScrolled, timeMicroseconds);
+        record.code = static_cast<int16_t>(scrolled->wheel);
+        record.x = scrolled->position.x;
+        record.y = scrolled->position.y;
+        record.wheelDelta = scrolled->delta;
+        return record;
+    }
+
+    return std::nullopt;
+}
+
+auto ToSfEvent(const RecordedEvent& event) -> sf::Event
+{
+    const auto position = sf::Vector2i{event.x, event.y};
+
+    switch (event.type) {
+    case RecordedEventType::Closed:
+        return sf::Event::Closed{};
+    case RecordedEventType::Resized:
+        return sf::Event::Resized{{static_cast<unsigned>(event.x), static_cast<unsigned>(event.y)}};
+    case RecordedEventType::KeyPressed:
+        return ToKeyEvent<sf::Event::KeyPressed>(event);
+    case RecordedEventType::KeyReleased:
+        return ToKeyEvent<sf::Event::KeyReleased>(event);
+    case RecordedEventType::MouseMoved:
+        return sf::Event::MouseMoved{position};
+    case RecordedEventType::MouseButtonPressed:
+        return sf::Event::MouseButtonPressed{static_cast<sf::Mouse::Button>(event.code), position};
+    case RecordedEventType::MouseButtonReleased:
+        return sf::Event::MouseButtonReleased{static_cast<sf::Mouse::Button>(event.code), position};
+    case RecordedEventType::MouseWheelScrolled:
+        return sf::Event::MouseWheelScrolled{static_cast<sf::Mouse::Wheel>(event.code), event.wheelDelta, position};
+    }
+
+    throw std::runtime_error(std::format("Unknown recorded event type - {}", static_cast<int>(event.type)));
+}
+
+InputRecorder::InputRecorder()
+    : m_start(std::chrono::steady_clock::now())
+    , m_events()
+{
+}
+
+auto InputRecorder::Record(const sf::Event& event) -> bool
+{
+    const auto elapsed = std::chrono::steady_clock::now() - m_start;
+    return Record(event, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+auto InputRecorder::Record(const sf::Event& event, uint64_t timeMicroseconds) -> bool
+{
+    const auto record = ToRecordedEvent(event, timeMicroseconds);
+    if (!record) {
+        return false;
+    }
+
+    m_events.push_back(*record);
+    return true;
+}
+
+auto InputRecorder::GetEvents() const -> std::span<const RecordedEvent> { return m_events; }
+
+void InputRecorder::Write(std::ostream& out) const
+{
+    const auto header = InputRecordingHeader{INPUT_RECORDING_MAGIC, INPUT_RECORDING_VERSION,
+                                             static_cast<uint32_t>(m_events.size()), 0};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(m_events.data()),
+              static_cast<std::streamsize>(m_events.size() * sizeof(RecordedEvent)));
+
+    if (!out) {
+        throw std::runtime_error("Input recording - could not write to the stream");
+    }
+}
+
+void InputRecorder::Save(const std::filesystem::path& path) const
+{
+    auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("Could not open {} for writing", path.string()));
+    }
+
+    Write(file);
+}
+
+auto LoadInputRecording(std::span<const std::byte> data) -> std::vector<RecordedEvent>
+{
+    if (data.size() < sizeof(InputRecordingHeader)) {
+        throw std::runtime_error("Input recording - file too small for header");
+    }
+
+    auto header = InputRecordingHeader{};
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if (header.magic != INPUT_RECORDING_MAGIC) {
+        throw std::runtime_error("Input recording - invalid magic");
+    }
+
+    if (header.version != INPUT_RECORDING_VERSION) {
+        throw std::runtime_error(std::format("Input recording - unsupported version, expected - {}, real - {}",
+                                             INPUT_RECORDING_VERSION, header.version));
+    }
+
+    if (sizeof(InputRecordingHeader) + size_t(header.eventCount) * sizeof(RecordedEvent) > data.size()) {
+        throw std::runtime_error("Input recording - events out of file bounds");
+    }
+
+    auto events = std::vector<RecordedEvent>(header.eventCount);
+    std::memcpy(events.data(), data.data() + sizeof(InputRecordingHeader), events.size() * sizeof(RecordedEvent));
+
+    for (size_t i = 0; i < events.size(); i++) {
+        if (events[i].type > RecordedEventType::MouseWheelScrolled ||
+            (i > 0 && events[i].timeMicroseconds < events[i - 1].timeMicroseconds)) {
+            throw std::runtime_error(std::format("Input recording - event {} is invalid", i));
+        }
+    }
+
+    return events;
+}
+
+auto LoadInputRecordingFile(const std::filesystem::path& path) -> std::vector<RecordedEvent>
+{
+    const auto file = MappedFile(path);
+    return LoadInputRecording(file.GetData());
+}
+
+InputReplay::InputReplay(std::vector<RecordedEvent> events, std::chrono::microseconds frameInterval)
+    : m_events(std::move(events))
+    , m_next(0)
+    , m_frameInterval(frameInterval)
+    , m_frame(0)
+{
+    if (m_frameInterval.count() <= 0) {
+        throw std::runtime_error(std::format("Input replay - frame interval has to be positive, real - {}",
+                                             m_frameInterval.count()));
+    }
+}
+
+auto InputReplay::PollEvent() -> std::optional<sf::Event>
+{
+    // current frame covers the events recorded before its end
+    const auto frameEnd = static_cast<uint64_t>((GetVirtualTime() + m_frameInterval).count());
+    if (m_next == m_events.size() || m_events[m_next].timeMicroseconds >= frameEnd) {
+        return std::nullopt;
+    }
+
+    return ToSfEvent(m_events[m_next++]);
+}
+
+void InputReplay::AdvanceFrame() { m_frame++; }
+
+auto InputReplay::IsFinished() const -> bool { return m_next == m_events.size(); }
+
+auto InputReplay::GetFrame() const -> uint64_t { return m_frame; }
+
+auto InputReplay::GetVirtualTime() const -> std::chrono::microseconds
+{
+    return m_frameInterval * static_cast<int64_t>(m_frame);
+}
@@ -0,0 +1,112 @@
+#include "layer_cache.h"
+
+#include <utility>
+
+auto LayerStats::GetHitRate() const -> double
+{
+    const auto lookups = hits + misses;
+    if (lookups == 0) {
+        return 0;
+    }
+
+    return static_cast<double>(hits) / static_cast<double>(lookups);
+}
+
+LayerCache::LayerCache(size_t budgetBytes)
+    : m_budgetBytes(budgetBytes)
+    , m_layeredElements(0)
+{
+}
+
+auto LayerCache::Find(UiElement* root, uint64_t version) -> const std::vector<sf::Vertex>*
+{
+    const auto found = m_index.find(root);
+    if (found == m_index.end()) {
+        m_stats.misses++;
+        return nullptr;
+    }
+
+    auto layer = found->second;
+    if (layer->version != version) {
+        m_stats.misses++;
+        m_stats.invalidations++;
+        Erase(layer);
+        return nullptr;
+    }
+
+    m_stats.hits++;
+    m_layeredElements += layer->elementCount;
+    m_layers.splice(m_layers.begin(), m_layers, layer);
+    return &layer->vertices;
+}
+
+auto LayerCache::Store(UiElement* root, uint64_t version, std::vector<sf::Vertex> vertices, size_t elementCount)
+    -> const std::vector<sf::Vertex>*
+{
+    if (const auto found = m_index.find(root); found != m_index.end()) {
+        Erase(found->second);
+    }
+
+    m_layeredElements += elementCount;
+
+    auto layer = Layer{root, version, elementCount, std::move(vertices)};
+    const auto bytes = GetBytes(layer);
+    if (bytes > m_budgetBytes) {
+        m_stats.oversized++;
+        return nullptr;
+    }
+
+    EvictUntil(m_budgetBytes - bytes);
+
+    m_layers.push_front(std::move(layer));
+    m_index.emplace(root, m_layers.begin());
+    m_stats.layerCount++;
+    m_stats.usedBytes += bytes;
+
+    return &m_layers.front().vertices;
+}
+
+auto LayerCache::TakeLayeredElementCount() -> size_t
+{
+    return std::exchange(m_layeredElements, 0);
+}
+
+void LayerCache::SetBudget(size_t budgetBytes)
+{
+    m_budgetBytes = budgetBytes;
+    EvictUntil(budgetBytes);
+}
+
+auto LayerCache::GetStats() const -> const LayerStats&
+{
+    return m_stats;
+}
+
+void LayerCache::Clear()
+{
+    m_layers.clear();
+    m_index.clear();
+    m_stats.layerCount = 0;
+    m_stats.usedBytes = 0;
+}
+
+auto LayerCache::GetBytes(const Layer& layer) -> size_t
+{
+    return sizeof(Layer) + layer.vertices.capacity() * sizeof(sf::Vertex);
+}
+
+void LayerCache::Erase(std::list<Layer>::iterator layer)
+{
+    m_stats.layerCount--;
+    m_stats.usedBytes -= GetBytes(*layer);
+    m_index.erase(layer->root);
+    m_layers.erase(layer);
+}
+
+void LayerCache::EvictUntil(size_t budgetBytes)
+{
+    while (m_stats.usedBytes > budgetBytes && !m_layers.empty()) {
+        m_stats.evictions++;
+        Erase(std::prev(m_layers.end()));
+    }
+}
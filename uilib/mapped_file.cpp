@@ -0,0 +1,88 @@
+#include "mapped_file.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+    : m_data(nullptr)
+    , m_size(0)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(std::format("Could not open {} - {}", path.string(), std::strerror(errno)));
+    }
+
+    struct stat fileStat{};
+    if (::fstat(fd, &fileStat) != 0) {
+        ::close(fd);
+        throw std::runtime_error(std::format("Could not stat {} - {}", path.string(), std::strerror(errno)));
+    }
+
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    // mmap of 0 bytes fails, empty file is represented by empty span
+    if (m_size > 0) {
+        void* mapped = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error(std::format("Could not map {} - {}", path.string(), std::strerror(errno)));
+        }
+
+        ::madvise(mapped, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const std::byte*>(mapped);
+    }
+
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    Unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        Unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+
+    return *this;
+}
+
+auto MappedFile::GetData() const -> std::span<const std::byte>
+{
+    return {m_data, m_size};
+}
+
+auto MappedFile::GetView() const -> std::string_view
+{
+    return {reinterpret_cast<const char*>(m_data), m_size};
+}
+
+auto MappedFile::GetSize() const -> size_t
+{
+    return m_size;
+}
+
+void MappedFile::Unmap()
+{
+    if (m_data != nullptr) {
+        ::munmap(const_cast<std::byte*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
@@ -0,0 +1,365 @@
+#include "plot_aggregation.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+
+namespace {
+
+// independent accumulators, enough for two 128 bit or one 256 bit register of doubles
+constexpr size_t LANES = 4;
+
+// samples binned per pass, bin indices of one chunk stay on the stack
+constexpr size_t BIN_CHUNK = 256;
+
+} // namespace
+
+auto SampleAggregate::GetMean() const -> double
+{
+    return count == 0 ? 0 : sum / static_cast<double>(count);
+}
+
+void SampleAggregate::Merge(const SampleAggregate& other)
+{
+    count += other.count;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    sum += other.sum;
+}
+
+auto AggregateSamples(std::span<const double> samples) -> SampleAggregate
+{
+    auto mins = std::array<double, LANES>{};
+    auto maxs = std::array<double, LANES>{};
+    auto sums = std::array<double, LANES>{};
+    mins.fill(std::numeric_limits<double>::infinity());
+    maxs.fill(-std::numeric_limits<double>::infinity());
+
+    const auto* data = samples.data();
+    const auto vectorEnd = samples.size() / LANES * LANES;
+    for (size_t i = 0; i < vectorEnd; i += LANES) {
+        for (size_t lane = 0; lane < LANES; lane++) {
+            const auto value = data[i + lane];
+            mins[lane] = value < mins[lane] ? value : mins[lane];
+            maxs[lane] = value > maxs[lane] ? value : maxs[lane];
+            sums[lane] += value;
+        }
+    }
+
+    auto aggregate = SampleAggregate{};
+    aggregate.count = samples.size();
+    for (size_t lane = 0; lane < LANES; lane++) {
+        aggregate.min = std::min(aggregate.min, mins[lane]);
+        aggregate.max = std::max(aggregate.max, maxs[lane]);
+        aggregate.sum += sums[lane];
+    }
+
+    for (size_t i = vectorEnd; i < samples.size(); i++) {
+        aggregate.min = std::min(aggregate.min, data[i]);
+        aggregate.max = std::max(aggregate.max, data[i]);
+        aggregate.sum += data[i];
+    }
+
+    return aggregate;
+}
+
+SampleHistogram::SampleHistogram(Range range, size_t binCount)
+    : m_range(range)
+    , m_scale(0)
+    , m_counts(binCount + 2, 0)
+    , m_total()
+{
+    if (binCount == 0 || !(range.end > range.start)) {
+        throw std::runtime_error(std::format("Histogram needs bins and a non empty range, bins - {}, range - {}..{}",
+                                             binCount, range.start, range.end));
+    }
+
+    m_scale = static_cast<double>(binCount) / (range.end - range.start);
+}
+
+void SampleHistogram::Add(std::span<const double> samples)
+{
+    const auto start = m_range.start;
+    const auto last = static_cast<double>(m_counts.size() - 1);
+
+    auto indices = std::array<uint32_t, BIN_CHUNK>{};
+    for (size_t chunkStart = 0; chunkStart < samples.size(); chunkStart += BIN_CHUNK) {
+        const auto count = std::min(BIN_CHUNK, samples.size() - chunkStart);
+        const auto* chunk = samples.data() + chunkStart;
+
+        // slot 0 is underflow, min / max in this order put NaN there
+        for (size_t i = 0; i < count; i++) {
+            const auto slot = (chunk[i] - start) * m_scale + 1.0;
+            indices[i] = static_cast<uint32_t>(std::max(0.0, std::min(slot, last)));
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            m_counts[indices[i]]++;
+        }
+    }
+
+    m_total.Merge(AggregateSamples(samples));
+}
+
+void SampleHistogram::Merge(const SampleHistogram& other)
+{
+    assert(other.m_counts.size() == m_counts.size());
+
+    for (size_t i = 0; i < m_counts.size(); i++) {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_total.Merge(other.m_total);
+}
+
+void SampleHistogram::Clear()
+{
+    std::ranges::fill(m_counts, 0);
+    m_total = {};
+}
+
+auto SampleHistogram::GetBins() const -> std::span<const uint64_t>
+{
+    return std::span(m_counts).subspan(1, m_counts.size() - 2);
+}
+
+auto SampleHistogram::GetUnderflow() const -> uint64_t { return m_counts.front(); }
+
+auto SampleHistogram::GetOverflow() const -> uint64_t { return m_counts.back(); }
+
+auto SampleHistogram::GetBinRange(size_t bin) const -> Range
+{
+    const auto width = 1.0 / m_scale;
+    return {m_range.start + width * static_cast<double>(bin), m_range.start + width * static_cast<double>(bin + 1)};
+}
+
+auto SampleHistogram::GetTotal() const -> const SampleAggregate& { return m_total; }
+
+auto SampleHistogram::GetPercentile(double percentile) const -> double
+{
+    if (m_total.count == 0) {
+        return 0;
+    }
+
+    const auto rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(m_total.count)));
+    const auto target = std::clamp<uint64_t>(rank, 1, m_total.count);
+
+    uint64_t seen = 0;
+    for (size_t slot = 0; slot < m_counts.size(); slot++) {
+        const auto count = m_counts[slot];
+        if (seen + count < target) {
+            seen += count;
+            continue;
+        }
+
+        if (slot == 0) {
+            return m_total.min;
+        }
+        if (slot == m_counts.size() - 1) {
+            return m_total.max;
+        }
+
+        const auto [binStart, binEnd] = GetBinRange(slot - 1);
+        const auto fraction = static_cast<double>(target - seen) / static_cast<double>(count);
+        return std::clamp(binStart + (binEnd - binStart) * fraction, m_total.min, m_total.max);
+    }
+
+    return m_total.max;
+}
+
+AggregationPool::AggregationPool(size_t threadCount)
+    : m_runMutex()
+    , m_mutex()
+    , m_started()
+    , m_finished()
+    , m_task(nullptr)
+    , m_size(0)
+    , m_parts(0)
+    , m_remaining(0)
+    , m_generation(0)
+    , m_threads()
+{
+    if (threadCount == 0) {
+        // the calling thread works too
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+    }
+
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        m_threads.emplace_back([this, part = i + 1](std::stop_token stopToken) { Work(stopToken, part); });
+    }
+}
+
+AggregationPool::~AggregationPool()
+{
+    // jthread requests stop on destruction, which also wakes the waiting threads
+    m_threads.clear();
+}
+
+auto AggregationPool::GetPartCount(size_t size) const -> size_t
+{
+    return std::clamp<size_t>(size / MIN_PART_SIZE, 1, m_threads.size() + 1);
+}
+
+void AggregationPool::Run(size_t size, const Task& task)
+{
+    const auto parts = GetPartCount(size);
+    if (parts == 1) {
+        task(0, 0, size);
+        return;
+    }
+
+    const auto runLock = std::scoped_lock(m_runMutex);
+    {
+        const auto lock = std::scoped_lock(m_mutex);
+        m_task = &task;
+        m_size = size;
+        m_parts = parts;
+        m_remaining = parts - 1;
+        m_generation++;
+    }
+    m_started.notify_all();
+
+    task(0, 0, GetPartBegin(size, parts, 1));
+
+    auto lock = std::unique_lock(m_mutex);
+    m_finished.wait(lock, [this] { return m_remaining == 0; });
+}
+
+void AggregationPool::Work(std::stop_token stopToken, size_t part)
+{
+    uint64_t seen = 0;
+    while (true) {
+        const Task* task = nullptr;
+        size_t size = 0;
+        size_t parts = 0;
+        {
+            auto lock = std::unique_lock(m_mutex);
+            if (!m_started.wait(lock, stopToken, [this, seen] { return m_generation != seen; })) {
+                return;
+            }
+
+            seen = m_generation;
+            if (part >= m_parts) {
+                continue;
+            }
+
+            task = m_task;
+            size = m_size;
+            parts = m_parts;
+        }
+
+        (*task)(part, GetPartBegin(size, parts, part), GetPartBegin(size, parts, part + 1));
+
+        const auto lock = std::scoped_lock(m_mutex);
+        if (--m_remaining == 0) {
+            m_finished.notify_one();
+        }
+    }
+}
+
+auto AggregationPool::GetPartBegin(size_t size, size_t parts, size_t part) -> size_t
+{
+    return size / parts * part + std::min(part, size % parts);
+}
+
+SampleAggregator::SampleAggregator(Range histogramRange, size_t binCount, size_t samplesPerInterval,
+                                   AggregationPool* pool)
+    : m_histogramRange(histogramRange)
+    , m_binCount(binCount)
+    , m_samplesPerInterval(samplesPerInterval)
+    , m_pool(pool)
+    , m_histogram(histogramRange, binCount)
+    , m_intervals()
+    , m_sampleCount(0)
+    , m_partials()
+{
+    if (samplesPerInterval == 0) {
+        throw std::runtime_error("Aggregation interval has to contain at least one sample");
+    }
+}
+
+void SampleAggregator::Append(std::span<const double> samples)
+{
+    if (samples.empty()) {
+        return;
+    }
+
+    const auto parts = m_pool != nullptr ? m_pool->GetPartCount(samples.size()) : 1;
+    while (m_partials.size() < parts) {
+        m_partials.push_back({SampleHistogram(m_histogramRange, m_binCount)});
+    }
+
+    const auto task = [this, samples](size_t part, size_t begin, size_t end) {
+        AggregatePart(samples.subspan(begin, end - begin), m_sampleCount + begin, m_partials[part]);
+    };
+
+    if (m_pool != nullptr) {
+        m_pool->Run(samples.size(), task);
+    }
+    else {
+        task(0, 0, samples.size());
+    }
+
+    // parts are in sample order, an interval split between parts is merged back together
+    for (size_t part = 0; part < parts; part++) {
+        const auto& partial = m_partials[part];
+        m_histogram.Merge(partial.histogram);
+
+        for (size_t i = 0; i < partial.intervals.size(); i++) {
+            const auto interval = partial.firstInterval + i;
+            if (interval < m_intervals.size()) {
+                m_intervals[interval].Merge(partial.intervals[i]);
+            }
+            else {
+                assert(interval == m_intervals.size());
+                m_intervals.push_back(partial.intervals[i]);
+            }
+        }
+    }
+
+    m_sampleCount += samples.size();
+}
+
+void SampleAggregator::Update(std::span<const double> series)
+{
+    if (series.size() < m_sampleCount) {
+        Clear();
+    }
+
+    Append(series.subspan(m_sampleCount));
+}
+
+void SampleAggregator::Clear()
+{
+    m_histogram.Clear();
+    m_intervals.clear();
+    m_sampleCount = 0;
+}
+
+auto SampleAggregator::GetHistogram() const -> const SampleHistogram& { return m_histogram; }
+
+auto SampleAggregator::GetIntervals() const -> std::span<const SampleAggregate> { return m_intervals; }
+
+auto SampleAggregator::GetSampleCount() const -> uint64_t { return m_sampleCount; }
+
+void SampleAggregator::AggregatePart(std::span<const double> samples, uint64_t firstIndex, Partial& partial) const
+{
+    partial.histogram.Clear();
+    partial.histogram.Add(samples);
+
+    partial.firstInterval = firstIndex / m_samplesPerInterval;
+    partial.intervals.clear();
+
+    size_t position = 0;
+    while (position < samples.size()) {
+        const auto index = firstIndex + position;
+        const auto intervalEnd = (index / m_samplesPerInterval + 1) * m_samplesPerInterval;
+        const auto count = std::min<uint64_t>(intervalEnd - index, samples.size() - position);
+
+        partial.intervals.push_back(AggregateSamples(samples.subspan(position, count)));
+        position += count;
+    }
+}
@@ -31,7 +31,7 @@ static std::string PosStr(Pos ps)
     return std::format("({}, {})", ps.left, ps.top);
 }
 
-PlotArea::PlotArea(Pos startAxisPos, float axisWidth, const std::vector<double>& data, float axisScale,
+PlotArea::PlotArea(Pos startAxisPos, float axisWidth, std::span<const double> data, float axisScale,
                    uint32_t interpolationRate)
     : m_vertexArray(sf::PrimitiveType::TriangleFan, data.size() + 3)
 {
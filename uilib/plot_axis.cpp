@@ -1,4 +1,6 @@
 #include "plot_axis.h"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 
 PlotAxis::PlotAxis(Pos startPosition, uint32_t length, AxisType axisType)
@@ -13,3 +15,26 @@ void PlotAxis::SetRange(double start, double end)
 {
     m_range = {start, end};
 }
+
+auto PlotAxis::GetRange() const -> Range
+{
+    return m_range;
+}
+
+auto PlotAxis::AutoScale(Range data, double margin, double shrinkBelow) -> bool
+{
+    // flat data still gets a visible range around its value
+    const auto span = data.end - data.start;
+    const auto padding = span > 0 ? span * margin : std::max(std::abs(data.start), 1.0) * margin;
+    const auto fitted = Range{data.start - padding, data.end + padding};
+
+    const auto current = m_range.end - m_range.start;
+    const auto outside = data.start < m_range.start || data.end > m_range.end;
+    const auto tooLoose = fitted.end - fitted.start < current * shrinkBelow;
+    if (current > 0 && !outside && !tooLoose) {
+        return false;
+    }
+
+    SetRange(fitted.start, fitted.end);
+    return true;
+}
@@ -0,0 +1,243 @@
+#include "plot_heatmap.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <stdexcept>
+
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+
+namespace {
+
+// values mapped per pass, indices of one chunk stay on the stack
+constexpr size_t MAP_CHUNK = 256;
+
+auto Pack(sf::Color color) -> uint32_t
+{
+    auto packed = uint32_t{};
+    const auto bytes = std::array<uint8_t, 4>{color.r, color.g, color.b, color.a};
+    std::memcpy(&packed, bytes.data(), sizeof(packed));
+    return packed;
+}
+
+auto Lerp(uint8_t from, uint8_t to, float t) -> uint8_t
+{
+    return static_cast<uint8_t>(from + (to - from) * t + 0.5f);
+}
+
+auto CeilDiv(uint32_t value, uint32_t divisor) -> uint32_t
+{
+    return (value + divisor - 1) / divisor;
+}
+
+} // namespace
+
+Colormap::Colormap(std::span<const sf::Color> stops)
+    : m_table()
+{
+    if (stops.size() < 2) {
+        throw std::runtime_error(std::format("Colormap needs at least 2 stops, real - {}", stops.size()));
+    }
+
+    const auto segments = static_cast<float>(stops.size() - 1);
+    for (size_t i = 0; i < m_table.size(); i++) {
+        const auto position = static_cast<float>(i) / (m_table.size() - 1) * segments;
+        const auto stop = std::min(static_cast<size_t>(position), stops.size() - 2);
+        const auto t = position - static_cast<float>(stop);
+
+        const auto& from = stops[stop];
+        const auto& to = stops[stop + 1];
+        m_table[i] = Pack({Lerp(from.r, to.r, t), Lerp(from.g, to.g, t), Lerp(from.b, to.b, t), Lerp(from.a, to.a, t)});
+    }
+}
+
+auto Colormap::Viridis() -> Colormap
+{
+    static constexpr auto stops = std::array<sf::Color, 5>{
+        sf::Color{68, 1, 84}, sf::Color{59, 82, 139}, sf::Color{33, 145, 140}, sf::Color{94, 201, 98},
+        sf::Color{253, 231, 37},
+    };
+    return Colormap(stops);
+}
+
+void Colormap::Map(std::span<const float> values, Range range, std::span<uint32_t> pixels) const
+{
+    assert(pixels.size() >= values.size());
+
+    const auto min = static_cast<float>(range.start);
+    const auto width = static_cast<float>(range.end - range.start);
+    const auto scale = width > 0 ? 255.f / width : 0.f;
+
+    auto indices = std::array<uint8_t, MAP_CHUNK>{};
+    for (size_t start = 0; start < values.size(); start += MAP_CHUNK) {
+        const auto count = std::min(MAP_CHUNK, values.size() - start);
+        const auto* chunk = values.data() + start;
+
+        // min / max in this order map NaN to 0
+        for (size_t i = 0; i < count; i++) {
+            const auto scaled = (chunk[i] - min) * scale;
+            indices[i] = static_cast<uint8_t>(std::max(0.f, std::min(scaled, 255.f)));
+        }
+
+        auto* out = pixels.data() + start;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = m_table[indices[i]];
+        }
+    }
+}
+
+auto Colormap::GetColor(uint8_t index) const -> sf::Color
+{
+    auto bytes = std::array<uint8_t, 4>{};
+    std::memcpy(bytes.data(), &m_table[index], sizeof(uint32_t));
+    return {bytes[0], bytes[1], bytes[2], bytes[3]};
+}
+
+PlotHeatmap::PlotHeatmap(Pos position, sf::Vector2u sizePx, uint32_t rows, uint32_t columns, Range valueRange,
+                         Colormap colormap)
+    : m_position(position)
+    , m_size(static_cast<float>(sizePx.x), static_cast<float>(sizePx.y))
+    , m_rows(rows)
+    , m_valueRange(valueRange)
+    , m_colormap(colormap)
+    , m_rowFactor(0)
+    , m_columnFactor(0)
+    , m_textureRows(0)
+    , m_textureColumns(0)
+    , m_pending()
+    , m_pendingColumns(0)
+    , m_pixels()
+    , m_head(0)
+    , m_filled(0)
+    , m_notUploaded(0)
+    , m_texture()
+    , m_vertices()
+    , m_stats()
+{
+    if (rows == 0 || columns == 0 || sizePx.x == 0 || sizePx.y == 0) {
+        throw std::runtime_error(std::format("Heatmap needs cells and pixels, rows - {}, columns - {}, size - {}x{}",
+                                             rows, columns, sizePx.x, sizePx.y));
+    }
+
+    // rows are drawn along the height and columns along the width
+    m_rowFactor = CeilDiv(rows, sizePx.y);
+    m_columnFactor = CeilDiv(columns, sizePx.x);
+    m_textureRows = CeilDiv(rows, m_rowFactor);
+    m_textureColumns = CeilDiv(columns, m_columnFactor);
+
+    m_pending.assign(m_textureRows, -std::numeric_limits<float>::infinity());
+    m_pixels.resize(size_t(m_textureRows) * m_textureColumns);
+
+    if (!m_texture.resize({m_textureRows, m_textureColumns})) {
+        throw std::runtime_error(
+            std::format("Could not create heatmap texture of {}x{}", m_textureRows, m_textureColumns));
+    }
+}
+
+void PlotHeatmap::PushColumn(std::span<const float> values)
+{
+    if (values.size() != m_rows) {
+        throw std::runtime_error(
+            std::format("Heatmap column size mismatch, expected - {}, real - {}", m_rows, values.size()));
+    }
+
+    m_stats.columnsPushed++;
+
+    for (uint32_t row = 0; row < m_rows; row++) {
+        auto& cell = m_pending[row / m_rowFactor];
+        cell = std::max(cell, values[row]);
+    }
+
+    if (++m_pendingColumns < m_columnFactor) {
+        return;
+    }
+
+    m_colormap.Map(m_pending, m_valueRange, {m_pixels.data() + size_t(m_head) * m_textureRows, m_textureRows});
+    std::ranges::fill(m_pending, -std::numeric_limits<float>::infinity());
+    m_pendingColumns = 0;
+
+    m_head = (m_head + 1) % m_textureColumns;
+    m_filled = std::min(m_filled + 1, m_textureColumns);
+    m_notUploaded = std::min(m_notUploaded + 1, m_textureColumns);
+}
+
+void PlotHeatmap::Update()
+{
+    if (m_notUploaded == 0) {
+        return;
+    }
+
+    // lines written since the last upload end at head, split where the ring wraps
+    const auto first = (m_head + m_textureColumns - m_notUploaded) % m_textureColumns;
+    const auto upload = [this](uint32_t line, uint32_t count) {
+        const auto* pixels = reinterpret_cast<const uint8_t*>(m_pixels.data() + size_t(line) * m_textureRows);
+        m_texture.update(pixels, {m_textureRows, count}, {0, line});
+        m_stats.linesUploaded += count;
+        m_stats.uploads++;
+    };
+
+    const auto beforeWrap = std::min(m_notUploaded, m_textureColumns - first);
+    upload(first, beforeWrap);
+    if (beforeWrap < m_notUploaded) {
+        upload(0, m_notUploaded - beforeWrap);
+    }
+
+    m_notUploaded = 0;
+    RebuildVertices();
+}
+
+auto PlotHeatmap::GetTextureSize() const -> sf::Vector2u
+{
+    return {m_textureRows, m_textureColumns};
+}
+
+auto PlotHeatmap::GetVertices() const -> std::span<const sf::Vertex> { return m_vertices; }
+
+auto PlotHeatmap::GetTexture() const -> const sf::Texture& { return m_texture; }
+
+auto PlotHeatmap::GetStats() const -> const PlotHeatmapStats& { return m_stats; }
+
+void PlotHeatmap::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    states.texture = &m_texture;
+    target.draw(m_vertices.data(), m_vertices.size(), sf::PrimitiveType::Triangles, states);
+}
+
+void PlotHeatmap::RebuildVertices()
+{
+    m_vertices.clear();
+
+    const auto columnWidth = m_size.x / static_cast<float>(m_textureColumns);
+    const auto top = m_position.top;
+    const auto bottom = m_position.top + m_size.y;
+    const auto rows = static_cast<float>(m_textureRows);
+
+    // oldest line is drawn first, the newest ends at the right edge
+    auto left = m_position.left + m_size.x - columnWidth * static_cast<float>(m_filled);
+    const auto addSegment = [&](uint32_t firstLine, uint32_t lineCount) {
+        if (lineCount == 0) {
+            return;
+        }
+
+        const auto right = left + columnWidth * static_cast<float>(lineCount);
+        const auto start = static_cast<float>(firstLine);
+        const auto end = static_cast<float>(firstLine + lineCount);
+
+        // texture x is the row, row 0 is at the bottom
+        const auto topLeft = sf::Vertex{{left, top}, sf::Color::White, {rows, start}};
+        const auto topRight = sf::Vertex{{right, top}, sf::Color::White, {rows, end}};
+        const auto bottomLeft = sf::Vertex{{left, bottom}, sf::Color::White, {0, start}};
+        const auto bottomRight = sf::Vertex{{right, bottom}, sf::Color::White, {0, end}};
+        m_vertices.insert(m_vertices.end(), {topLeft, topRight, bottomLeft, bottomLeft, topRight, bottomRight});
+
+        left = right;
+    };
+
+    const auto oldest = (m_head + m_textureColumns - m_filled) % m_textureColumns;
+    const auto beforeWrap = std::min(m_filled, m_textureColumns - oldest);
+    addSegment(oldest, beforeWrap);
+    addSegment(0, m_filled - beforeWrap);
+}
@@ -0,0 +1,63 @@
+#include "plot_series.h"
+
+#include <algorithm>
+
+PlotSeries::PlotSeries(size_t capacityPerProducer)
+    : m_queue(capacityPerProducer)
+    , m_samples()
+    , m_rollingStats()
+{
+}
+
+auto PlotSeries::GetQueue() -> MpscSampleQueue&
+{
+    return m_queue;
+}
+
+auto PlotSeries::Ingest() -> size_t
+{
+    return m_queue.Drain([this](std::span<const double> samples) {
+        m_samples.insert(m_samples.end(), samples.begin(), samples.end());
+        if (m_rollingStats) {
+            m_rollingStats->Push(samples);
+        }
+    });
+}
+
+auto PlotSeries::GetSamples() const -> const std::vector<double>&
+{
+    return m_samples;
+}
+
+void PlotSeries::SetSamples(std::span<const double> samples)
+{
+    m_samples.assign(samples.begin(), samples.end());
+    FillRollingStats();
+}
+
+void PlotSeries::SetRollingWindow(size_t window)
+{
+    if (window == 0) {
+        m_rollingStats.reset();
+        return;
+    }
+
+    m_rollingStats.emplace(window);
+    FillRollingStats();
+}
+
+auto PlotSeries::GetRollingStats() const -> const RollingStats*
+{
+    return m_rollingStats ? &*m_rollingStats : nullptr;
+}
+
+void PlotSeries::FillRollingStats()
+{
+    if (!m_rollingStats) {
+        return;
+    }
+
+    m_rollingStats->Clear();
+    const auto count = std::min(m_samples.size(), m_rollingStats->GetWindow());
+    m_rollingStats->Push(std::span(m_samples).last(count));
+}
@@ -7,72 +7,287 @@
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Graphics/Text.hpp>
 #include <SFML/System/Vector2.hpp>
+#include <array>
+#include <limits>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <queue>
 #include <utility>
 
-Renderer::Renderer(std::queue<UiElement*>& traverseBuffer) {}
+namespace {
 
-auto Renderer::GetDrawables(UiTree* root) -> std::vector<std::pair<std::string, sf::Drawable*>>
+// Clip of elements without a clipping ancestor
+constexpr auto UNCLIPPED = BoundingBox{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                                       std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+
+auto ToFloatRect(const BoundingBox& box) -> sf::FloatRect
+{
+    return {{box.left, box.top}, {box.right - box.left, box.bottom - box.top}};
+}
+
+} // namespace
+
+Renderer::Renderer(std::queue<UiElement*>& traverseBuffer)
+    : m_layers()
+    , m_frameArena()
+    , m_profiler(nullptr)
+    , m_textureCache(nullptr)
+    , m_frame(0)
+    , m_lastElementCount(0)
+    , m_culledElements(0)
+{
+}
+
+auto Renderer::GetDrawables(UiTree* root) -> const std::vector<std::pair<ElementId, sf::Drawable*>>&
+{
+    Update(root, nullptr);
+    return m_drawables;
+}
+
+void Renderer::BuildDisplayList(UiTree* uiTree, DisplayList& displayList)
+{
+    displayList.Clear();
+    Update(uiTree, &displayList);
+    displayList.SetFrame(m_frame);
+}
+
+void Renderer::Update(UiTree* root, DisplayList* displayList)
 {
-    auto uiElements = root->GetAllDescendantsBreathFirst();
+    m_frame++;
+    m_frameArena.Reset();
+
+    // layers are only composited into display lists, drawables are always per element
+    const auto useLayers = displayList != nullptr;
+
+    auto uiElements = std::pmr::vector<UiElement*>(m_frameArena.GetResource());
+    auto elementClips = std::pmr::vector<uint32_t>(m_frameArena.GetResource());
+    auto clipRects = std::pmr::vector<BoundingBox>(m_frameArena.GetResource());
+    {
+        const auto stage = FrameProfiler::ScopedStage(m_profiler, FrameStage::Traversal);
+        uiElements.reserve(m_lastElementCount);
+        elementClips.reserve(m_lastElementCount);
+        clipRects.push_back(UNCLIPPED);
+        root->GetAllDescendantsBreathFirst(uiElements, elementClips, clipRects, useLayers);
+        m_lastElementCount = uiElements.size();
+    }
 
     assert(uiElements.size() > 0);
 
-    // TODO: make it a buffer
-    auto newRenderTree = std::vector<std::pair<std::string, sf::Drawable*>>{};
-    for (const auto& elem : uiElements) {
-        newRenderTree.emplace_back(std::move(CreateNewDrawable(elem)));
+    {
+        const auto stage = FrameProfiler::ScopedStage(m_profiler, FrameStage::Drawables);
+        m_drawables.clear();
+        m_culledElements = 0;
+
+        // drawn in traversal order so overlapping elements keep their z-order, consecutive elements
+        // with the same clip rect share one batch and the clip only changes between runs
+        auto currentClip = uint32_t(0);
+        for (size_t i = 0; i < uiElements.size(); i++) {
+            auto* elem = uiElements[i];
+            const auto clip = elementClips[i];
+
+            // fully clipped elements are rejected before they are tessellated
+            if (clip != 0 && !clipRects[clip].Overlaps(elem->GetBounds())) {
+                m_culledElements++;
+                continue;
+            }
+
+            if (useLayers) {
+                if (clip != currentClip) {
+                    currentClip = clip;
+                    displayList->SetClipRect(clip == 0 ? std::nullopt : std::optional(ToFloatRect(clipRects[clip])));
+                }
+
+                if (elem->IsCachedAsLayer()) {
+                    AppendLayer(elem, *displayList);
+                }
+                // images which are not decoded yet are drawn as boxes
+                else if (elem->GetElementType() != ElemType::Image || !AppendImage(elem, *displayList)) {
+                    displayList->AddVertices(sf::PrimitiveType::Triangles, GetDrawable(elem).triangles);
+                }
+                continue;
+            }
+
+            const auto& cached = GetDrawable(elem);
+            m_drawables.emplace_back(elem->GetId(), cached.rect != nullptr ? cached.rect->GetUnderlayingShape() : nullptr);
+        }
+
+        if (useLayers && currentClip != 0) {
+            displayList->SetClipRect(std::nullopt);
+        }
     }
 
-    return newRenderTree;
+    if (m_profiler != nullptr) {
+        m_profiler->AddElementsVisited(static_cast<uint32_t>(uiElements.size()));
+        m_profiler->AddAllocations(static_cast<uint32_t>(m_frameArena.GetOverflowAllocations()));
+    }
+
+    // culled elements, subtrees under an empty clip and cached layers do not touch their entries,
+    // so only entries unused for CACHE_RETAIN_FRAMES are dropped, which are mostly removed elements.
+    // The sweep runs once per that many frames and only when the cache outgrew the tree
+    const auto liveElements = uiElements.size() + m_layers.TakeLayeredElementCount();
+    if (m_frame % CACHE_RETAIN_FRAMES == 0 && m_cache.size() > liveElements) {
+        std::erase_if(m_cache, [this](const auto& entry) {
+            return m_frame - entry.second.lastFrame >= CACHE_RETAIN_FRAMES;
+        });
+    }
 }
 
-auto Renderer::CreateNewDrawable(UiElement* element) -> std::pair<std::string, sf::Drawable*>
+void Renderer::AppendLayer(UiElement* root, DisplayList& displayList)
 {
-    switch (element->GetElementType()) {
-    case ElemType::Box: {
+    const auto version = root->GetSubtreeVersion();
+    if (const auto* layer = m_layers.Find(root, version)) {
+        displayList.AddVertices(sf::PrimitiveType::Triangles, *layer);
+        return;
+    }
 
-        const auto elementSize = Components::Size{element->properties.width, element->properties.height};
-        const auto elementborder =
-            Components::Border{element->properties.border_radius_px, element->properties.border_width};
-        const auto elementPositon = Pos{element->properties.position.x, element->properties.position.y};
+    // the root itself was already counted by the caller
+    auto subtree = std::pmr::vector<UiElement*>(m_frameArena.GetResource());
+    root->GetAllDescendantsBreathFirst(subtree);
 
-        auto newElem = std::make_unique<Components::Rect>(elementSize, elementborder, elementPositon);
-        const auto& elementColors = element->properties.color;
-        newElem->GetUnderlayingShape()->setFillColor(
-            {elementColors.red, elementColors.green, elementColors.blue, elementColors.alpha});
+    auto vertices = std::vector<sf::Vertex>();
+    for (auto* element : subtree) {
+        const auto& triangles = GetDrawable(element).triangles;
+        vertices.insert(vertices.end(), triangles.begin(), triangles.end());
+    }
 
-        newElem->GetUnderlayingShape()->setPosition({element->properties.position.x, element->properties.position.y});
+    const auto* stored = m_layers.Store(root, version, std::move(vertices), subtree.size() - 1);
+    if (stored != nullptr) {
+        displayList.AddVertices(sf::PrimitiveType::Triangles, *stored);
+        return;
+    }
+
+    // over the budget, drawn element by element
+    for (auto* element : subtree) {
+        displayList.AddVertices(sf::PrimitiveType::Triangles, GetDrawable(element).triangles);
+    }
+}
+
+auto Renderer::AppendImage(UiElement* element, DisplayList& displayList) -> bool
+{
+    const auto* region = m_textureCache != nullptr ? m_textureCache->GetImage(element->GetId()) : nullptr;
+    if (region == nullptr) {
+        return false;
+    }
+
+    const auto& properties = element->properties;
+    const auto& [x, y] = properties.position;
+    const auto& [u, v] = region->rect.position;
+    const auto& [textureWidth, textureHeight] = region->rect.size;
 
-        m_rectangles.emplace_back(std::move(newElem));
+    // alpha of the element fades the image
+    const auto color = sf::Color(255, 255, 255, properties.color.alpha);
+    const auto topLeft = sf::Vertex{{x, y}, color, {u, v}};
+    const auto topRight = sf::Vertex{{x + properties.width, y}, color, {u + textureWidth, v}};
+    const auto bottomRight = sf::Vertex{{x + properties.width, y + properties.height}, color,
+                                        {u + textureWidth, v + textureHeight}};
+    const auto bottomLeft = sf::Vertex{{x, y + properties.height}, color, {u, v + textureHeight}};
 
-        return {element->GetName(), m_rectangles.back()->GetUnderlayingShape()};
+    const auto quad = std::array<sf::Vertex, 6>{topLeft, topRight, bottomRight, topLeft, bottomRight, bottomLeft};
+    displayList.AddVertices(sf::PrimitiveType::Triangles, quad, region->texture);
+    return true;
+}
+
+auto Renderer::GetCulledElementCount() const -> size_t
+{
+    return m_culledElements;
+}
+
+auto Renderer::GetCachedElementCount() const -> size_t
+{
+    return m_cache.size();
+}
+
+void Renderer::SetTextureCache(TextureCache* textureCache)
+{
+    m_textureCache = textureCache;
+}
+
+auto Renderer::GetLayerCache() -> LayerCache&
+{
+    return m_layers;
+}
+
+auto Renderer::GetFrameArena() -> FrameArena&
+{
+    return m_frameArena;
+}
+
+void Renderer::SetProfiler(FrameProfiler* profiler)
+{
+    m_profiler = profiler;
+}
+
+auto Renderer::GetDrawable(UiElement* element) -> const CachedDrawable&
+{
+    // element memory is reused by the node pool, so type and properties decide validity, not the address
+    auto [entry, inserted] = m_cache.try_emplace(element);
+    auto& cached = entry->second;
+    cached.lastFrame = m_frame;
 
-        break;
+    if (inserted || cached.type != element->GetElementType() || cached.properties != element->properties) {
+        cached.type = element->GetElementType();
+        cached.properties = element->properties;
+
+        const auto stage = FrameProfiler::ScopedStage(m_profiler, FrameStage::Tessellation);
+        cached.rect = CreateNewDrawable(element);
+        Tessellate(cached);
+        if (m_profiler != nullptr) {
+            m_profiler->AddVerticesGenerated(static_cast<uint32_t>(cached.triangles.size()));
+        }
     }
 
-    case ElemType::Text:
-        [[fallthrough]];
+    return cached;
+}
 
-    case ElemType::Window:
-        [[fallthrough]];
+void Renderer::Tessellate(CachedDrawable& cached)
+{
+    cached.triangles.clear();
+    if (cached.rect == nullptr) {
+        return;
+    }
 
-    default:
-        return {"", nullptr};
+    // rect outline is convex, so a fan around the first point covers it
+    const auto* shape = cached.rect->GetUnderlayingShape();
+    const auto pointCount = shape->getPointCount();
+    if (pointCount < 3) {
+        return;
+    }
+
+    const auto offset = shape->getPosition();
+    const auto color = shape->getFillColor();
+    const auto first = sf::Vertex{shape->getPoint(0) + offset, color};
+
+    cached.triangles.reserve((pointCount - 2) * 3);
+    for (size_t i = 1; i + 1 < pointCount; i++) {
+        cached.triangles.push_back(first);
+        cached.triangles.push_back({shape->getPoint(i) + offset, color});
+        cached.triangles.push_back({shape->getPoint(i + 1) + offset, color});
     }
 }
 
-void Renderer::SyncProperties(UiElement* element, sf::Drawable* drawable)
+auto Renderer::CreateNewDrawable(UiElement* element) -> std::unique_ptr<Components::Rect>
 {
     switch (element->GetElementType()) {
+    // placeholder until the image is decoded
+    case ElemType::Image:
+        [[fallthrough]];
+
     case ElemType::Box: {
-        auto rect = dynamic_cast<sf::RectangleShape*>(drawable);
+
+        const auto elementSize = Components::Size{element->properties.width, element->properties.height};
+        const auto elementborder =
+            Components::Border{element->properties.border_radius_px, element->properties.border_width};
+        const auto elementPositon = Pos{element->properties.position.x, element->properties.position.y};
+
+        auto newElem = std::make_unique<Components::Rect>(elementSize, elementborder, elementPositon);
         const auto& elementColors = element->properties.color;
-        rect->setSize({float(element->properties.width), float(element->properties.height)});
-        rect->setFillColor({elementColors.red, elementColors.green, elementColors.blue});
-        rect->setPosition({element->properties.position.x, element->properties.position.y});
-        break;
+        newElem->GetUnderlayingShape()->setFillColor(
+            {elementColors.red, elementColors.green, elementColors.blue, elementColors.alpha});
+
+        newElem->GetUnderlayingShape()->setPosition({element->properties.position.x, element->properties.position.y});
+
+        return newElem;
     }
 
     case ElemType::Text:
@@ -82,6 +297,6 @@ void Renderer::SyncProperties(UiElement* element, sf::Drawable* drawable)
         [[fallthrough]];
 
     default:
-        break;
+        return nullptr;
     }
 }
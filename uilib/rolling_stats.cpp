@@ -0,0 +1,120 @@
+#include "rolling_stats.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+RollingStats::RollingStats(size_t window)
+    : m_window(window)
+    , m_samples(window)
+    , m_pushed(0)
+    , m_minimums()
+    , m_maximums()
+    , m_mean(0)
+    , m_squares(0)
+{
+    if (window == 0) {
+        throw std::runtime_error(std::format("Rolling stats window has to be positive, real - {}", window));
+    }
+}
+
+void RollingStats::Push(double sample)
+{
+    const auto index = m_pushed;
+    auto& slot = m_samples[index % m_window];
+
+    if (GetCount() == m_window) {
+        const auto removed = slot;
+        const auto remaining = static_cast<double>(m_window - 1);
+        if (remaining == 0) {
+            m_mean = 0;
+            m_squares = 0;
+        }
+        else {
+            const auto delta = removed - m_mean;
+            m_mean -= delta / remaining;
+            m_squares -= delta * (removed - m_mean);
+        }
+    }
+
+    slot = sample;
+    m_pushed++;
+
+    const auto count = static_cast<double>(GetCount());
+    const auto delta = sample - m_mean;
+    m_mean += delta / count;
+    m_squares += delta * (sample - m_mean);
+
+    // removing samples accumulates rounding errors, once per window the sums are recomputed
+    // from the ring which keeps the update amortised O(1)
+    if (m_pushed % m_window == 0) {
+        auto sum = 0.0;
+        for (const auto value : m_samples) {
+            sum += value;
+        }
+        m_mean = sum / static_cast<double>(m_window);
+
+        m_squares = 0;
+        for (const auto value : m_samples) {
+            m_squares += (value - m_mean) * (value - m_mean);
+        }
+    }
+
+    while (!m_minimums.empty() && m_minimums.back().value >= sample) {
+        m_minimums.pop_back();
+    }
+    m_minimums.push_back({index, sample});
+
+    while (!m_maximums.empty() && m_maximums.back().value <= sample) {
+        m_maximums.pop_back();
+    }
+    m_maximums.push_back({index, sample});
+
+    // the newest sample is never popped here, both deques stay non empty
+    while (m_minimums.front().index + m_window <= index) {
+        m_minimums.pop_front();
+    }
+    while (m_maximums.front().index + m_window <= index) {
+        m_maximums.pop_front();
+    }
+}
+
+void RollingStats::Push(std::span<const double> samples)
+{
+    for (const auto sample : samples) {
+        Push(sample);
+    }
+}
+
+void RollingStats::Clear()
+{
+    m_pushed = 0;
+    m_minimums.clear();
+    m_maximums.clear();
+    m_mean = 0;
+    m_squares = 0;
+}
+
+auto RollingStats::GetWindow() const -> size_t { return m_window; }
+
+auto RollingStats::GetCount() const -> size_t
+{
+    return static_cast<size_t>(std::min<uint64_t>(m_pushed, m_window));
+}
+
+auto RollingStats::GetMin() const -> double { return m_minimums.empty() ? 0 : m_minimums.front().value; }
+
+auto RollingStats::GetMax() const -> double { return m_maximums.empty() ? 0 : m_maximums.front().value; }
+
+auto RollingStats::GetMean() const -> double { return m_mean; }
+
+auto RollingStats::GetVariance() const -> double
+{
+    const auto count = GetCount();
+    return count == 0 ? 0 : std::max(0.0, m_squares) / static_cast<double>(count);
+}
+
+auto RollingStats::GetRange() const -> Range
+{
+    return {GetMin(), GetMax()};
+}
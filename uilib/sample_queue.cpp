@@ -0,0 +1,108 @@
+#include "sample_queue.h"
+
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+SpscSampleQueue::SpscSampleQueue(size_t capacity)
+    : m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1)
+    , m_samples(std::make_unique<double[]>(m_mask + 1))
+    , m_head(0)
+    , m_cachedTail(0)
+    , m_tail(0)
+    , m_cachedHead(0)
+{
+}
+
+auto SpscSampleQueue::Push(std::span<const double> samples) -> size_t
+{
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    const auto capacity = m_mask + 1;
+
+    // consumer position is only reloaded when the cached one says the ring is full
+    if (tail - m_cachedHead + samples.size() > capacity) {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+    }
+
+    const auto count = std::min(samples.size(), capacity - (tail - m_cachedHead));
+    if (count == 0) {
+        return 0;
+    }
+
+    const auto start = tail & m_mask;
+    const auto firstPart = std::min(count, capacity - start);
+    std::memcpy(m_samples.get() + start, samples.data(), firstPart * sizeof(double));
+    std::memcpy(m_samples.get(), samples.data() + firstPart, (count - firstPart) * sizeof(double));
+
+    m_tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+auto SpscSampleQueue::Drain(const std::function<void(std::span<const double>)>& append) -> size_t
+{
+    const auto head = m_head.load(std::memory_order_relaxed);
+    m_cachedTail = m_tail.load(std::memory_order_acquire);
+
+    const auto count = m_cachedTail - head;
+    if (count == 0) {
+        return 0;
+    }
+
+    const auto capacity = m_mask + 1;
+    const auto start = head & m_mask;
+    const auto firstPart = std::min(count, capacity - start);
+    append({m_samples.get() + start, firstPart});
+    if (count > firstPart) {
+        append({m_samples.get(), count - firstPart});
+    }
+
+    m_head.store(head + count, std::memory_order_release);
+    return count;
+}
+
+auto SpscSampleQueue::GetCapacity() const -> size_t
+{
+    return m_mask + 1;
+}
+
+MpscSampleQueue::MpscSampleQueue(size_t capacityPerProducer)
+    : m_capacityPerProducer(capacityPerProducer)
+    , m_producers()
+    , m_producerCount(0)
+{
+}
+
+auto MpscSampleQueue::RegisterProducer() -> SpscSampleQueue&
+{
+    const auto lock = std::lock_guard(m_registerMutex);
+
+    const auto index = m_producerCount.load(std::memory_order_relaxed);
+    if (index == MAX_PRODUCERS) {
+        throw std::runtime_error(std::format("Sample queue producer limit reached - {}", MAX_PRODUCERS));
+    }
+
+    m_producers[index] = std::make_unique<SpscSampleQueue>(m_capacityPerProducer);
+
+    // consumer only looks at queues below the published count
+    m_producerCount.store(index + 1, std::memory_order_release);
+    return *m_producers[index];
+}
+
+auto MpscSampleQueue::Drain(const std::function<void(std::span<const double>)>& append) -> size_t
+{
+    const auto producerCount = m_producerCount.load(std::memory_order_acquire);
+
+    size_t drained = 0;
+    for (size_t i = 0; i < producerCount; i++) {
+        drained += m_producers[i]->Drain(append);
+    }
+
+    return drained;
+}
+
+auto MpscSampleQueue::GetProducerCount() const -> size_t
+{
+    return m_producerCount.load(std::memory_order_acquire);
+}
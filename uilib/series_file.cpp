@@ -0,0 +1,310 @@
+#include "series_file.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t COLUMN_ALIGNMENT = 64;
+
+auto AlignUp(uint64_t offset, uint64_t alignment) -> uint64_t
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+void WritePadding(std::ostream& out, uint64_t& offset, uint64_t target)
+{
+    static constexpr auto zeros = std::array<char, COLUMN_ALIGNMENT>{};
+    while (offset < target) {
+        const auto size = std::min(target - offset, COLUMN_ALIGNMENT);
+        out.write(zeros.data(), static_cast<std::streamsize>(size));
+        offset += size;
+    }
+}
+
+void WriteBytes(std::ostream& out, uint64_t& offset, const void* data, uint64_t size)
+{
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    offset += size;
+}
+
+auto Trim(std::string_view text) -> std::string_view
+{
+    const auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+auto ParseDouble(std::string_view text) -> std::optional<double>
+{
+    text = Trim(text);
+    auto value = 0.0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || error != std::errc() || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+template <typename T> auto IsAligned(const std::byte* data) -> bool
+{
+    return reinterpret_cast<uintptr_t>(data) % alignof(T) == 0;
+}
+
+} // namespace
+
+void WriteSeries(std::span<const double> timestamps, std::span<const double> values, std::ostream& out,
+                 uint32_t chunkSize)
+{
+    if (timestamps.size() != values.size()) {
+        throw std::runtime_error(std::format("Series file - column size mismatch, timestamps - {}, values - {}",
+                                             timestamps.size(), values.size()));
+    }
+
+    if (chunkSize == 0) {
+        throw std::runtime_error("Series file - chunk size has to be positive");
+    }
+
+    const auto sampleCount = uint64_t(values.size());
+    const auto chunkCount = (sampleCount + chunkSize - 1) / chunkSize;
+    if (chunkCount > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error(std::format("Series file - too many chunks - {}", chunkCount));
+    }
+
+    auto chunks = std::vector<SeriesFileChunk>(chunkCount);
+    for (uint64_t chunk = 0; chunk < chunkCount; chunk++) {
+        const auto begin = chunk * chunkSize;
+        const auto end = std::min(begin + chunkSize, sampleCount);
+
+        auto record = SeriesFileChunk{timestamps[begin], timestamps[end - 1], values[begin], values[begin]};
+        for (auto i = begin; i < end; i++) {
+            // written so NaN fails, chunk lookup needs a sorted time column
+            if (i > 0 && !(timestamps[i] >= timestamps[i - 1])) {
+                throw std::runtime_error(std::format("Series file - timestamps are not ascending at sample {}", i));
+            }
+            record.minValue = std::min(record.minValue, values[i]);
+            record.maxValue = std::max(record.maxValue, values[i]);
+        }
+        chunks[chunk] = record;
+    }
+
+    auto header = SeriesFileHeader{};
+    header.magic = SERIES_FILE_MAGIC;
+    header.version = SERIES_FILE_VERSION;
+    header.chunkSize = chunkSize;
+    header.chunkCount = static_cast<uint32_t>(chunkCount);
+    header.sampleCount = sampleCount;
+    header.chunkTableOffset = sizeof(SeriesFileHeader);
+    header.timestampOffset =
+        AlignUp(header.chunkTableOffset + chunkCount * sizeof(SeriesFileChunk), COLUMN_ALIGNMENT);
+    header.valueOffset = AlignUp(header.timestampOffset + sampleCount * sizeof(double), COLUMN_ALIGNMENT);
+    header.fileSize = header.valueOffset + sampleCount * sizeof(double);
+
+    uint64_t offset = 0;
+    WriteBytes(out, offset, &header, sizeof(header));
+    WriteBytes(out, offset, chunks.data(), chunks.size() * sizeof(SeriesFileChunk));
+    WritePadding(out, offset, header.timestampOffset);
+    WriteBytes(out, offset, timestamps.data(), timestamps.size_bytes());
+    WritePadding(out, offset, header.valueOffset);
+    WriteBytes(out, offset, values.data(), values.size_bytes());
+
+    if (!out) {
+        throw std::runtime_error("Series file - could not write to the stream");
+    }
+}
+
+void WriteSeriesFile(std::span<const double> timestamps, std::span<const double> values,
+                     const std::filesystem::path& path, uint32_t chunkSize)
+{
+    auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("Could not open {} for writing", path.string()));
+    }
+
+    WriteSeries(timestamps, values, file, chunkSize);
+}
+
+auto ConvertCsvToSeries(std::string_view csv, std::ostream& out, uint32_t chunkSize) -> uint64_t
+{
+    // columns have to be written one after the other, so they are collected first
+    auto timestamps = std::vector<double>();
+    auto values = std::vector<double>();
+    const auto expectedSamples = std::ranges::count(csv, '\n') + 1;
+    timestamps.reserve(expectedSamples);
+    values.reserve(expectedSamples);
+
+    size_t lineNumber = 0;
+    while (!csv.empty()) {
+        const auto lineEnd = std::min(csv.find('\n'), csv.size());
+        const auto line = Trim(csv.substr(0, lineEnd));
+        csv.remove_prefix(std::min(lineEnd + 1, csv.size()));
+        lineNumber++;
+
+        if (line.empty()) {
+            continue;
+        }
+
+        const auto separator = std::min(line.find(','), line.size());
+        const auto timestamp = ParseDouble(line.substr(0, separator));
+        const auto value = ParseDouble(line.substr(std::min(separator + 1, line.size())));
+        if (!timestamp || !value) {
+            if (lineNumber == 1) {
+                continue;
+            }
+            throw std::runtime_error(std::format("Series csv - line {} is not \"timestamp,value\" - {}", lineNumber,
+                                                 line));
+        }
+
+        timestamps.push_back(*timestamp);
+        values.push_back(*value);
+    }
+
+    WriteSeries(timestamps, values, out, chunkSize);
+    return values.size();
+}
+
+auto ConvertCsvToSeriesFile(const std::filesystem::path& csvPath, const std::filesystem::path& seriesPath,
+                            uint32_t chunkSize) -> uint64_t
+{
+    const auto csv = MappedFile(csvPath);
+
+    auto file = std::ofstream(seriesPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("Could not open {} for writing", seriesPath.string()));
+    }
+
+    return ConvertCsvToSeries(csv.GetView(), file, chunkSize);
+}
+
+SeriesFile::SeriesFile(const std::filesystem::path& path)
+    : m_file(std::in_place, path)
+    , m_chunkSize(0)
+    , m_chunks()
+    , m_timestamps()
+    , m_values()
+{
+    Parse(m_file->GetData());
+}
+
+SeriesFile::SeriesFile(std::span<const std::byte> data)
+    : m_file()
+    , m_chunkSize(0)
+    , m_chunks()
+    , m_timestamps()
+    , m_values()
+{
+    Parse(data);
+}
+
+auto SeriesFile::GetSampleCount() const -> uint64_t { return m_values.size(); }
+
+auto SeriesFile::GetChunkSize() const -> uint32_t { return m_chunkSize; }
+
+auto SeriesFile::GetChunks() const -> std::span<const SeriesFileChunk> { return m_chunks; }
+
+auto SeriesFile::GetSamples() const -> SeriesSlice { return {m_timestamps, m_values}; }
+
+auto SeriesFile::GetSlice(Range timeRange) const -> SeriesSlice
+{
+    const auto [firstChunk, endChunk] = FindChunks(timeRange);
+    if (firstChunk >= endChunk) {
+        return {};
+    }
+
+    // only the boundary chunks are searched, every chunk between them is inside the range
+    const auto firstSample = size_t(firstChunk) * m_chunkSize;
+    const auto lastChunkSample = size_t(endChunk - 1) * m_chunkSize;
+    const auto endSample = std::min(lastChunkSample + m_chunkSize, m_timestamps.size());
+
+    const auto firstChunkSamples =
+        m_timestamps.subspan(firstSample, std::min<size_t>(m_chunkSize, endSample - firstSample));
+    const auto lastChunkSamples = m_timestamps.subspan(lastChunkSample, endSample - lastChunkSample);
+    const auto begin = std::ranges::lower_bound(firstChunkSamples, timeRange.start) - firstChunkSamples.begin();
+    const auto end = std::ranges::upper_bound(lastChunkSamples, timeRange.end) - lastChunkSamples.begin();
+
+    const auto sliceBegin = firstSample + size_t(begin);
+    const auto sliceEnd = lastChunkSample + size_t(end);
+    if (sliceBegin >= sliceEnd) {
+        return {};
+    }
+
+    const auto count = sliceEnd - sliceBegin;
+    return {m_timestamps.subspan(sliceBegin, count), m_values.subspan(sliceBegin, count)};
+}
+
+auto SeriesFile::GetValueRange(Range timeRange) const -> Range
+{
+    auto range = Range{std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+
+    const auto [firstChunk, endChunk] = FindChunks(timeRange);
+    for (auto chunk = firstChunk; chunk < endChunk; chunk++) {
+        range.start = std::min(range.start, m_chunks[chunk].minValue);
+        range.end = std::max(range.end, m_chunks[chunk].maxValue);
+    }
+
+    return range;
+}
+
+void SeriesFile::Parse(std::span<const std::byte> data)
+{
+    if (data.size() < sizeof(SeriesFileHeader)) {
+        throw std::runtime_error("Series file - file too small for header");
+    }
+
+    auto header = SeriesFileHeader{};
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != SERIES_FILE_MAGIC) {
+        throw std::runtime_error("Series file - invalid magic");
+    }
+
+    if (header.version != SERIES_FILE_VERSION) {
+        throw std::runtime_error(std::format("Series file - unsupported version, expected - {}, real - {}",
+                                             SERIES_FILE_VERSION, header.version));
+    }
+
+    const auto isColumnValid = [&](uint64_t offset) {
+        return offset <= data.size() && header.sampleCount <= (data.size() - offset) / sizeof(double) &&
+               IsAligned<double>(data.data() + offset);
+    };
+
+    if (header.chunkSize == 0 || header.sampleCount > data.size() / sizeof(double) ||
+        header.chunkCount != (header.sampleCount + header.chunkSize - 1) / header.chunkSize ||
+        header.fileSize > data.size() || header.chunkTableOffset > data.size() ||
+        header.chunkCount > (data.size() - header.chunkTableOffset) / sizeof(SeriesFileChunk) ||
+        !IsAligned<SeriesFileChunk>(data.data() + header.chunkTableOffset) || !isColumnValid(header.timestampOffset) ||
+        !isColumnValid(header.valueOffset)) {
+        throw std::runtime_error("Series file - section out of file bounds");
+    }
+
+    // records are fixed size and aligned, the mapped bytes are used in place
+    m_chunkSize = header.chunkSize;
+    m_chunks = {reinterpret_cast<const SeriesFileChunk*>(data.data() + header.chunkTableOffset), header.chunkCount};
+    m_timestamps = {reinterpret_cast<const double*>(data.data() + header.timestampOffset), header.sampleCount};
+    m_values = {reinterpret_cast<const double*>(data.data() + header.valueOffset), header.sampleCount};
+
+    for (size_t i = 0; i < m_chunks.size(); i++) {
+        const auto& chunk = m_chunks[i];
+        if (!(chunk.firstTimestamp <= chunk.lastTimestamp) ||
+            (i > 0 && !(m_chunks[i - 1].lastTimestamp <= chunk.firstTimestamp))) {
+            throw std::runtime_error(std::format("Series file - chunk {} is invalid", i));
+        }
+    }
+}
+
+auto SeriesFile::FindChunks(Range timeRange) const -> std::pair<size_t, size_t>
+{
+    // chunks are sorted by time and do not overlap
+    const auto first = std::ranges::lower_bound(m_chunks, timeRange.start, {}, &SeriesFileChunk::lastTimestamp);
+    const auto end = std::ranges::upper_bound(m_chunks, timeRange.end, {}, &SeriesFileChunk::firstTimestamp);
+
+    return {size_t(first - m_chunks.begin()), size_t(end - m_chunks.begin())};
+}
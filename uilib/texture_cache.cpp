@@ -0,0 +1,263 @@
+#include "texture_cache.h"
+
+#include <iterator>
+
+namespace {
+
+// Free texels between packed images, keeps filtering from bleeding neighbours in
+constexpr unsigned ATLAS_PADDING = 1;
+
+auto GetImageBytes(sf::Vector2u size) -> size_t
+{
+    return size_t(size.x) * size.y * 4;
+}
+
+} // namespace
+
+auto TextureCacheStats::GetHitRate() const -> double
+{
+    const auto lookups = hits + misses;
+    if (lookups == 0) {
+        return 0;
+    }
+
+    return static_cast<double>(hits) / static_cast<double>(lookups);
+}
+
+TextureCache::TextureCache(size_t budgetBytes, size_t decodeThreads, DecodeImageCallback decode)
+    : m_budgetBytes(budgetBytes)
+    , m_frame(0)
+    , m_readFrame(0)
+    , m_decoder(decodeThreads, std::move(decode))
+{
+}
+
+void TextureCache::SetImage(ElementId element, std::string source)
+{
+    m_elementImages.insert_or_assign(element, std::move(source));
+}
+
+auto TextureCache::GetImage(ElementId element) -> const TextureRegion*
+{
+    const auto found = m_elementImages.find(element);
+    if (found == m_elementImages.end()) {
+        return nullptr;
+    }
+
+    return Find(found->second);
+}
+
+auto TextureCache::Find(const std::string& source) -> const TextureRegion*
+{
+    const auto [found, inserted] = m_entries.try_emplace(source);
+    if (inserted) {
+        m_stats.misses++;
+        m_decoder.Submit(source);
+        return nullptr;
+    }
+
+    auto& entry = found->second;
+    if (entry.state != State::Ready) {
+        return nullptr;
+    }
+
+    m_stats.hits++;
+    entry.allocation->lastFrame = m_frame;
+    m_allocations.splice(m_allocations.begin(), m_allocations, entry.allocation);
+    return &entry.region;
+}
+
+void TextureCache::Update(uint64_t frame, uint64_t readFrame)
+{
+    m_frame = frame;
+    m_readFrame = readFrame;
+    std::erase_if(m_retired, [this](const auto& retired) { return !IsInFlight(retired.first); });
+
+    for (auto& decoded : m_decoder.TakeDecoded()) {
+        const auto found = m_entries.find(decoded.source);
+        if (found == m_entries.end()) {
+            continue;
+        }
+
+        auto& entry = found->second;
+        if (!decoded.image.has_value()) {
+            entry.state = State::Failed;
+            m_stats.decodeFailures++;
+            continue;
+        }
+
+        Upload(found->first, entry, *decoded.image);
+    }
+
+    EvictUntil(m_budgetBytes);
+    m_stats.retiredCount = m_retired.size();
+}
+
+void TextureCache::Update()
+{
+    // previous list was already drawn, nothing is in flight
+    Update(m_frame + 1, m_frame + 1);
+}
+
+void TextureCache::SetBudget(size_t budgetBytes)
+{
+    m_budgetBytes = budgetBytes;
+    EvictUntil(budgetBytes);
+    m_stats.retiredCount = m_retired.size();
+}
+
+auto TextureCache::GetPendingCount() const -> size_t
+{
+    return m_decoder.GetPendingCount();
+}
+
+auto TextureCache::GetStats() const -> const TextureCacheStats&
+{
+    return m_stats;
+}
+
+void TextureCache::Upload(const std::string& source, Entry& entry, const sf::Image& image)
+{
+    const auto size = image.getSize();
+    if (size.x <= MAX_ATLAS_IMAGE_SIZE && size.y <= MAX_ATLAS_IMAGE_SIZE && UploadToAtlas(source, entry, image)) {
+        return;
+    }
+
+    const auto bytes = GetImageBytes(size);
+    if (bytes > m_budgetBytes) {
+        entry.state = State::Failed;
+        m_stats.oversized++;
+        return;
+    }
+
+    auto texture = std::make_unique<sf::Texture>();
+    if (!texture->loadFromImage(image)) {
+        entry.state = State::Failed;
+        m_stats.decodeFailures++;
+        return;
+    }
+    texture->setSmooth(true);
+
+    const auto* uploaded = texture.get();
+    m_allocations.push_front({std::move(texture), bytes, {source}, {}, false, 0});
+    m_stats.textureCount++;
+    m_stats.usedBytes += bytes;
+
+    entry.state = State::Ready;
+    entry.region = {uploaded, {{0, 0}, {float(size.x), float(size.y)}}};
+    entry.allocation = m_allocations.begin();
+}
+
+auto TextureCache::UploadToAtlas(const std::string& source, Entry& entry, const sf::Image& image) -> bool
+{
+    const auto size = image.getSize();
+
+    auto position = std::optional<sf::Vector2u>();
+    auto page = m_allocations.begin();
+    for (; page != m_allocations.end(); page++) {
+        if (page->atlas && (position = Pack(*page, size)).has_value()) {
+            break;
+        }
+    }
+
+    if (page == m_allocations.end()) {
+        const auto bytes = GetImageBytes({ATLAS_SIZE, ATLAS_SIZE});
+        auto texture = std::make_unique<sf::Texture>();
+        if (bytes > m_budgetBytes || !texture->resize({ATLAS_SIZE, ATLAS_SIZE})) {
+            return false;
+        }
+
+        m_allocations.push_front({std::move(texture), bytes, {}, {}, true, 0});
+        m_stats.atlasCount++;
+        m_stats.usedBytes += bytes;
+
+        page = m_allocations.begin();
+        position = Pack(*page, size);
+    }
+
+    if (IsInFlight(page->lastFrame)) {
+        CopyPage(*page);
+    }
+
+    page->texture->update(image, *position);
+    page->sources.push_back(source);
+
+    entry.state = State::Ready;
+    entry.region = {page->texture.get(),
+                    {{float(position->x), float(position->y)}, {float(size.x), float(size.y)}}};
+    entry.allocation = page;
+    return true;
+}
+
+auto TextureCache::Pack(Allocation& page, sf::Vector2u size) -> std::optional<sf::Vector2u>
+{
+    const auto width = size.x + ATLAS_PADDING;
+    const auto height = size.y + ATLAS_PADDING;
+
+    // lowest shelf the image fits into wastes the least space
+    Shelf* best = nullptr;
+    for (auto& shelf : page.shelves) {
+        const auto fits = shelf.height >= height && shelf.used + width <= ATLAS_SIZE;
+        if (fits && (best == nullptr || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
+
+    if (best == nullptr) {
+        const auto top = page.shelves.empty() ? 0 : page.shelves.back().top + page.shelves.back().height;
+        if (top + height > ATLAS_SIZE) {
+            return std::nullopt;
+        }
+
+        page.shelves.push_back({top, height, 0});
+        best = &page.shelves.back();
+    }
+
+    const auto position = sf::Vector2u{best->used, best->top};
+    best->used += width;
+    return position;
+}
+
+auto TextureCache::IsInFlight(uint64_t lastFrame) const -> bool
+{
+    return lastFrame != 0 && lastFrame >= m_readFrame;
+}
+
+void TextureCache::CopyPage(Allocation& page)
+{
+    auto copy = std::make_unique<sf::Texture>(*page.texture);
+    for (const auto& source : page.sources) {
+        m_entries.at(source).region.texture = copy.get();
+    }
+
+    m_stats.atlasCopies++;
+    m_retired.emplace_back(page.lastFrame, std::move(page.texture));
+    page.texture = std::move(copy);
+    page.lastFrame = 0;
+}
+
+void TextureCache::Evict(std::list<Allocation>::iterator allocation)
+{
+    for (const auto& source : allocation->sources) {
+        m_entries.erase(source);
+    }
+
+    m_stats.evictions += allocation->sources.size();
+    m_stats.usedBytes -= allocation->bytes;
+    if (allocation->atlas) {
+        m_stats.atlasCount--;
+    }
+    else {
+        m_stats.textureCount--;
+    }
+
+    m_retired.emplace_back(allocation->lastFrame, std::move(allocation->texture));
+    m_allocations.erase(allocation);
+}
+
+void TextureCache::EvictUntil(size_t budgetBytes)
+{
+    while (m_stats.usedBytes > budgetBytes && !m_allocations.empty()) {
+        Evict(std::prev(m_allocations.end()));
+    }
+}
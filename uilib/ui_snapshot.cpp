@@ -0,0 +1,272 @@
+#include "ui_snapshot.h"
+
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace {
+
+constexpr uint64_t SAMPLE_ALIGNMENT = 64;
+
+auto AlignUp(uint64_t offset, uint64_t alignment) -> uint64_t
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Writes to the stream and keeps track of the file offset
+class SnapshotWriter {
+  public:
+    explicit SnapshotWriter(std::ostream& out)
+        : m_out(out)
+        , m_offset(0)
+    {
+    }
+
+    void Write(const void* data, uint64_t size)
+    {
+        m_out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        m_offset += size;
+    }
+
+    void PadTo(uint64_t offset)
+    {
+        static constexpr auto zeros = std::array<char, SAMPLE_ALIGNMENT>{};
+        while (m_offset < offset) {
+            Write(zeros.data(), std::min(offset - m_offset, SAMPLE_ALIGNMENT));
+        }
+    }
+
+  private:
+    std::ostream& m_out;
+    uint64_t m_offset;
+};
+
+template <typename T> auto ReadAt(std::span<const std::byte> data, size_t offset) -> T
+{
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+// Pre-order with children in their order, parents[i] is the index of the parent of elements[i]
+void CollectPreOrder(UiElement* root, std::vector<UiElement*>& elements, std::vector<uint32_t>& parents)
+{
+    auto stack = std::vector<std::pair<UiElement*, uint32_t>>{{root, UI_SNAPSHOT_NO_PARENT}};
+    while (!stack.empty()) {
+        const auto [element, parent] = stack.back();
+        stack.pop_back();
+
+        const auto index = static_cast<uint32_t>(elements.size());
+        elements.push_back(element);
+        parents.push_back(parent);
+
+        const auto children = element->GetAllChildren();
+        for (auto child = children.rbegin(); child != children.rend(); child++) {
+            stack.emplace_back(*child, index);
+        }
+    }
+}
+
+} // namespace
+
+void WriteUiSnapshot(UiTree& uiTree, std::span<const NamedPlotSeries> series, std::ostream& out)
+{
+    auto elements = std::vector<UiElement*>{};
+    auto parents = std::vector<uint32_t>{};
+    CollectPreOrder(uiTree.GetRoot(), elements, parents);
+
+    auto strings = std::string{};
+    auto elementRecords = std::vector<UiSnapshotElement>(elements.size());
+    for (size_t i = 0; i < elements.size(); i++) {
+        const auto name = elements[i]->GetName();
+
+        auto& record = elementRecords[i];
+        record.parent = parents[i];
+        record.nameOffset = static_cast<uint32_t>(strings.size());
+        record.nameLength = static_cast<uint32_t>(name.size());
+        record.type = static_cast<uint8_t>(elements[i]->GetElementType());
+        record.flags = elements[i]->IsCachedAsLayer() ? UI_SNAPSHOT_CACHED_AS_LAYER : 0;
+        record.properties = elements[i]->properties;
+
+        strings.append(name);
+    }
+
+    auto seriesRecords = std::vector<UiSnapshotSeries>(series.size());
+    for (size_t i = 0; i < series.size(); i++) {
+        seriesRecords[i].nameOffset = static_cast<uint32_t>(strings.size());
+        seriesRecords[i].nameLength = static_cast<uint32_t>(series[i].name.size());
+        seriesRecords[i].sampleCount = series[i].series->GetSamples().size();
+        strings.append(series[i].name);
+    }
+
+    auto header = UiSnapshotHeader{};
+    header.magic = UI_SNAPSHOT_MAGIC;
+    header.version = UI_SNAPSHOT_VERSION;
+    header.elementCount = static_cast<uint32_t>(elementRecords.size());
+    header.elementTableOffset = sizeof(UiSnapshotHeader);
+    header.stringTableOffset = header.elementTableOffset + header.elementCount * sizeof(UiSnapshotElement);
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+    header.seriesCount = static_cast<uint32_t>(seriesRecords.size());
+    header.seriesTableOffset = static_cast<uint32_t>(AlignUp(header.stringTableOffset + header.stringTableSize, 8));
+
+    auto dataOffset = AlignUp(header.seriesTableOffset + header.seriesCount * sizeof(UiSnapshotSeries), SAMPLE_ALIGNMENT);
+    for (auto& record : seriesRecords) {
+        record.dataOffset = dataOffset;
+        dataOffset = AlignUp(dataOffset + record.sampleCount * sizeof(double), SAMPLE_ALIGNMENT);
+    }
+    header.fileSize = dataOffset;
+
+    auto writer = SnapshotWriter(out);
+    writer.Write(&header, sizeof(header));
+    writer.Write(elementRecords.data(), elementRecords.size() * sizeof(UiSnapshotElement));
+    writer.Write(strings.data(), strings.size());
+    writer.PadTo(header.seriesTableOffset);
+    writer.Write(seriesRecords.data(), seriesRecords.size() * sizeof(UiSnapshotSeries));
+
+    for (size_t i = 0; i < series.size(); i++) {
+        const auto& samples = series[i].series->GetSamples();
+        writer.PadTo(seriesRecords[i].dataOffset);
+        writer.Write(samples.data(), samples.size() * sizeof(double));
+    }
+    writer.PadTo(header.fileSize);
+
+    if (!out) {
+        throw std::runtime_error("Ui snapshot - could not write to the stream");
+    }
+}
+
+void WriteUiSnapshotFile(UiTree& uiTree, std::span<const NamedPlotSeries> series, const std::filesystem::path& path)
+{
+    auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error(std::format("Could not open {} for writing", path.string()));
+    }
+
+    WriteUiSnapshot(uiTree, series, file);
+}
+
+auto LoadUiSnapshot(std::span<const std::byte> data, UiTree& uiTree, std::span<const NamedPlotSeries> series)
+    -> size_t
+{
+    if (data.size() < sizeof(UiSnapshotHeader)) {
+        throw std::runtime_error("Ui snapshot - file too small for header");
+    }
+
+    const auto header = ReadAt<UiSnapshotHeader>(data, 0);
+    if (header.magic != UI_SNAPSHOT_MAGIC) {
+        throw std::runtime_error("Ui snapshot - invalid magic");
+    }
+
+    if (header.version != UI_SNAPSHOT_VERSION) {
+        throw std::runtime_error(std::format("Ui snapshot - unsupported version, expected - {}, real - {}",
+                                             UI_SNAPSHOT_VERSION, header.version));
+    }
+
+    if (header.fileSize > data.size() || header.elementCount == 0 ||
+        size_t(header.elementTableOffset) + size_t(header.elementCount) * sizeof(UiSnapshotElement) > data.size() ||
+        size_t(header.stringTableOffset) + header.stringTableSize > data.size() ||
+        size_t(header.seriesTableOffset) + size_t(header.seriesCount) * sizeof(UiSnapshotSeries) > data.size()) {
+        throw std::runtime_error("Ui snapshot - section out of file bounds");
+    }
+
+    const auto strings = std::string_view(reinterpret_cast<const char*>(data.data()) + header.stringTableOffset,
+                                          header.stringTableSize);
+    const auto isNameValid = [&strings](uint32_t offset, uint32_t length) {
+        return size_t(offset) + length <= strings.size();
+    };
+
+    // everything is validated before the tree is touched
+    auto records = std::vector<UiSnapshotElement>(header.elementCount);
+    auto childCounts = std::vector<uint32_t>(header.elementCount, 0);
+    for (uint32_t i = 0; i < header.elementCount; i++) {
+        records[i] = ReadAt<UiSnapshotElement>(data, header.elementTableOffset + size_t(i) * sizeof(UiSnapshotElement));
+
+        const auto& record = records[i];
+        const auto validParent = i == 0 ? record.parent == UI_SNAPSHOT_NO_PARENT : record.parent < i;
+        if (!validParent || !isNameValid(record.nameOffset, record.nameLength) || record.type > ElemType::Image) {
+            throw std::runtime_error(std::format("Ui snapshot - element {} is invalid", i));
+        }
+
+        if (i > 0 && ++childCounts[record.parent] > MAX_CHILDREN) {
+            throw std::runtime_error(
+                std::format("Ui snapshot - too many children for element {}, max - {}", record.parent, MAX_CHILDREN));
+        }
+    }
+
+    auto seriesRecords = std::vector<UiSnapshotSeries>(header.seriesCount);
+    for (uint32_t i = 0; i < header.seriesCount; i++) {
+        seriesRecords[i] =
+            ReadAt<UiSnapshotSeries>(data, header.seriesTableOffset + size_t(i) * sizeof(UiSnapshotSeries));
+
+        const auto& record = seriesRecords[i];
+        const auto validData = record.dataOffset <= header.fileSize &&
+                               record.sampleCount <= (header.fileSize - record.dataOffset) / sizeof(double) &&
+                               reinterpret_cast<uintptr_t>(data.data() + record.dataOffset) % alignof(double) == 0;
+        if (!validData || !isNameValid(record.nameOffset, record.nameLength)) {
+            throw std::runtime_error(std::format("Ui snapshot - series {} is invalid", i));
+        }
+    }
+
+    // one lock and a few slabs instead of growing the pool element by element
+    UiElement::GetNodePool().Reserve(header.elementCount - 1);
+
+    auto* root = uiTree.GetRoot();
+    root->RemoveImmediateChildren();
+    root->properties = records[0].properties;
+    root->SetCachedAsLayer(records[0].flags & UI_SNAPSHOT_CACHED_AS_LAYER);
+
+    // grouped by parent so every parent takes its children at once, without layout, the
+    // snapshot already has the final positions
+    auto created = std::vector<UiElement*>(records.size(), nullptr);
+    auto children = std::vector<std::vector<std::unique_ptr<UiElement>>>(records.size());
+    created[0] = root;
+
+    for (size_t i = 1; i < records.size(); i++) {
+        const auto& record = records[i];
+        auto element = std::make_unique<UiElement>(strings.substr(record.nameOffset, record.nameLength),
+                                                   static_cast<ElemType>(record.type));
+        element->properties = record.properties;
+        if (record.flags & UI_SNAPSHOT_CACHED_AS_LAYER) {
+            element->SetCachedAsLayer(true);
+        }
+
+        created[i] = element.get();
+        children[record.parent].emplace_back(std::move(element));
+    }
+
+    for (size_t i = 0; i < records.size(); i++) {
+        if (!children[i].empty()) {
+            created[i]->AttachChildren(std::move(children[i]));
+        }
+    }
+
+    size_t restored = 0;
+    for (const auto& [name, plotSeries] : series) {
+        for (const auto& record : seriesRecords) {
+            if (strings.substr(record.nameOffset, record.nameLength) != name) {
+                continue;
+            }
+
+            const auto* samples = reinterpret_cast<const double*>(data.data() + record.dataOffset);
+            plotSeries->SetSamples({samples, record.sampleCount});
+            restored++;
+            break;
+        }
+    }
+
+    return restored;
+}
+
+auto LoadUiSnapshotFile(const std::filesystem::path& path, UiTree& uiTree, std::span<const NamedPlotSeries> series)
+    -> size_t
+{
+    const auto file = MappedFile(path);
+    return LoadUiSnapshot(file.GetData(), uiTree, series);
+}
@@ -1,26 +1,79 @@
 #include "uielement.h"
 #include "format"
 #include "types.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <iostream>
 #include <memory>
-#include <print>
 #include <queue>
 #include <ranges>
 #include <stdexcept>
+#include <unordered_map>
 #include <vector>
 
-UiElement::UiElement(const std::string& name, ElemType elementType)
-    : m_name(name)
-    , m_elementType(elementType)
+static auto GetNextVersion() -> uint64_t
+{
+    static auto nextVersion = std::atomic<uint64_t>(1);
+    return nextVersion.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto BoundingBox::Intersect(const BoundingBox& other) const -> BoundingBox
+{
+    return {std::max(left, other.left), std::max(top, other.top), std::min(right, other.right),
+            std::min(bottom, other.bottom)};
+}
+
+bool BoundingBox::IsEmpty() const
+{
+    return left >= right || top >= bottom;
+}
+
+bool BoundingBox::Overlaps(const BoundingBox& other) const
+{
+    return left <= other.right && other.left <= right && top <= other.bottom && other.top <= bottom;
+}
+
+UiElement::UiElement(std::string_view name, ElemType elementType)
+    : UiElement(InternElementId(name), elementType)
+{
+}
+
+UiElement::UiElement(ElementId id, ElemType elementType)
+    : m_children()
     , m_parent(nullptr)
+    , m_subtreeVersion(GetNextVersion())
+    , m_id(id)
+    , m_elementType(elementType)
+    , m_cachedAsLayer(false)
+{
+}
+
+void* UiElement::operator new(size_t size)
+{
+    assert(size <= GetNodePool().GetBlockSize());
+    return GetNodePool().Allocate();
+}
+
+void UiElement::operator delete(void* ptr, size_t)
+{
+    GetNodePool().Deallocate(ptr);
+}
+
+auto UiElement::GetNodePool() -> BlockPool&
+{
+    // intentionally never destroyed, elements owned by static objects can outlive any static pool
+    static auto* pool = new BlockPool(sizeof(UiElement), 1024);
+    return *pool;
+}
+
+auto UiElement::GetId() const -> ElementId
 {
-    m_children.reserve(MAX_CHILDREN);
-};
+    return m_id;
+}
 
-auto UiElement::GetName() const -> const std::string&
+auto UiElement::GetName() const -> std::string_view
 {
-    return m_name;
+    return GetElementName(m_id);
 }
 
 void UiElement::SetParent(UiElement* parent)
@@ -42,6 +95,70 @@ void UiElement::AddChild(std::unique_ptr<UiElement> child)
     RearrangeChildren();
 }
 
+void UiElement::AddChildren(std::vector<std::unique_ptr<UiElement>> children)
+{
+    AttachChildren(std::move(children));
+    RearrangeChildren();
+}
+
+void UiElement::AttachChildren(std::vector<std::unique_ptr<UiElement>> children)
+{
+    assert(m_children.size() + children.size() <= MAX_CHILDREN);
+    for (auto& child : children) {
+        child->SetParent(this);
+        m_children.emplace_back(std::move(child));
+    }
+    Invalidate();
+}
+
+auto UiElement::DetachChildren(const std::vector<UiElement*>& children) -> size_t
+{
+    Invalidate();
+    return std::erase_if(m_children, [&children](const std::unique_ptr<UiElement>& child) {
+        return std::ranges::find(children, child.get()) != children.end();
+    });
+}
+
+auto UiElement::ReleaseChild(UiElement* child) -> std::unique_ptr<UiElement>
+{
+    const auto found =
+        std::ranges::find_if(m_children, [child](const std::unique_ptr<UiElement>& elem) { return elem.get() == child; });
+    if (found == m_children.end()) {
+        return nullptr;
+    }
+
+    auto released = std::move(*found);
+    m_children.erase(found);
+    released->SetParent(nullptr);
+    Invalidate();
+
+    return released;
+}
+
+void UiElement::ReorderChildren(const std::vector<UiElement*>& order)
+{
+    assert(order.size() == m_children.size());
+
+    // every child is looked up once instead of searching and erasing it from the list
+    std::unordered_map<const UiElement*, size_t> positions;
+    positions.reserve(m_children.size());
+    for (size_t i = 0; i < m_children.size(); i++) {
+        positions.emplace(m_children[i].get(), i);
+    }
+
+    std::vector<std::unique_ptr<UiElement>> reordered;
+    reordered.reserve(m_children.size());
+
+    for (const auto& child : order) {
+        const auto position = positions.find(child);
+        assert(position != positions.end() && m_children[position->second] != nullptr);
+        reordered.emplace_back(std::move(m_children[position->second]));
+    }
+
+    m_children = std::move(reordered);
+    Invalidate();
+}
+
 auto UiElement::GetAllChildren() const -> std::vector<UiElement*>
 {
     if (m_children.size() == size_t(0)) {
@@ -52,6 +169,11 @@ auto UiElement::GetAllChildren() const -> std::vector<UiElement*>
     return std::vector(transformed.begin(), transformed.end());
 }
 
+auto UiElement::GetChildrenCapacity() const -> size_t
+{
+    return m_children.capacity();
+}
+
 auto UiElement::GetAllDescendants(std::vector<UiElement*>& traversalBuffer) -> std::vector<UiElement*>
 {
     if (m_children.size() == size_t(0)) {
@@ -107,7 +229,60 @@ auto UiElement::GetAllDescendantsBreathFirst(std::queue<UiElement*>& traversalBu
     return elements;
 }
 
-bool UiElement::HasChild(std::vector<UiElement*>& traversalBuffer, const std::string childName)
+void UiElement::GetAllDescendantsBreathFirst(std::pmr::vector<UiElement*>& elements, bool skipLayerSubtrees)
+{
+    elements.clear();
+    elements.push_back(this);
+
+    // elements after head are the queue, children are pushed in reverse like above
+    for (size_t head = 0; head < elements.size(); head++) {
+        if (skipLayerSubtrees && elements[head]->m_cachedAsLayer) {
+            continue;
+        }
+
+        const auto& children = elements[head]->m_children;
+        for (auto child = children.rbegin(); child != children.rend(); child++) {
+            elements.push_back(child->get());
+        }
+    }
+}
+
+void UiElement::GetAllDescendantsBreathFirst(std::pmr::vector<UiElement*>& elements,
+                                             std::pmr::vector<uint32_t>& elementClips,
+                                             std::pmr::vector<BoundingBox>& clipRects, bool skipLayerSubtrees)
+{
+    assert(!clipRects.empty());
+    elements.clear();
+    elementClips.clear();
+    elements.push_back(this);
+    elementClips.push_back(0);
+
+    for (size_t head = 0; head < elements.size(); head++) {
+        const auto* element = elements[head];
+        if (skipLayerSubtrees && element->m_cachedAsLayer) {
+            continue;
+        }
+
+        auto clip = elementClips[head];
+        if (element->properties.clip_children && !element->m_children.empty()) {
+            clipRects.push_back(clipRects[clip].Intersect(element->GetBounds()));
+            clip = static_cast<uint32_t>(clipRects.size() - 1);
+        }
+
+        // nothing below can be visible
+        if (clipRects[clip].IsEmpty()) {
+            continue;
+        }
+
+        const auto& children = element->m_children;
+        for (auto child = children.rbegin(); child != children.rend(); child++) {
+            elements.push_back(child->get());
+            elementClips.push_back(clip);
+        }
+    }
+}
+
+bool UiElement::HasChild(std::vector<UiElement*>& traversalBuffer, ElementId id)
 {
     if (traversalBuffer.size() > MAX_ALL_CHILDREN || traversalBuffer.capacity() != MAX_ALL_CHILDREN) {
         throw std::runtime_error(std::format("Ui tree traversal buffer - too big allocation, max - {}, real - {}",
@@ -120,22 +295,28 @@ bool UiElement::HasChild(std::vector<UiElement*>& traversalBuffer, const std::st
 
     while (!traversalBuffer.empty()) {
         auto elem = traversalBuffer.back();
-        if (elem->GetName() == childName) {
+        if (elem->m_id == id) {
             return true;
         }
 
         traversalBuffer.pop_back();
 
-        auto children = elem->GetAllChildren();
-        for (const auto& child : children) {
-            traversalBuffer.push_back(child);
+        for (const auto& child : elem->m_children) {
+            traversalBuffer.push_back(child.get());
         }
     }
 
     return false;
 }
 
-auto UiElement::GetChild(std::vector<UiElement*>& traversalBuffer, const std::string name) -> UiElement*
+bool UiElement::HasChild(std::vector<UiElement*>& traversalBuffer, std::string_view name)
+{
+    // a name which was never interned can not belong to any element
+    const auto id = FindElementId(name);
+    return id.has_value() && HasChild(traversalBuffer, *id);
+}
+
+auto UiElement::GetChild(std::vector<UiElement*>& traversalBuffer, ElementId id) -> UiElement*
 {
     if (traversalBuffer.size() > MAX_ALL_CHILDREN || traversalBuffer.capacity() != MAX_ALL_CHILDREN) {
         throw std::runtime_error(std::format("Ui tree traversal buffer - too big allocation, max - {}, real - {}",
@@ -149,18 +330,24 @@ auto UiElement::GetChild(std::vector<UiElement*>& traversalBuffer, const std::st
         auto elem = traversalBuffer.back();
         traversalBuffer.pop_back();
 
-        for (const auto& child : elem->GetAllChildren()) {
-            if (child->GetName() == name) {
-                return child;
+        for (const auto& child : elem->m_children) {
+            if (child->m_id == id) {
+                return child.get();
             }
 
-            traversalBuffer.push_back(child);
+            traversalBuffer.push_back(child.get());
         }
     }
 
     return nullptr;
 }
 
+auto UiElement::GetChild(std::vector<UiElement*>& traversalBuffer, std::string_view name) -> UiElement*
+{
+    const auto id = FindElementId(name);
+    return id.has_value() ? GetChild(traversalBuffer, *id) : nullptr;
+}
+
 bool UiElement::IsText()
 {
     return m_elementType == ElemType::Text;
@@ -171,27 +358,60 @@ auto UiElement::GetElementType() -> ElemType
     return m_elementType;
 }
 
-bool UiElement::RemoveChild(std::vector<UiElement*>& traversalBuffer, const std::string& childName)
+auto UiElement::GetBounds() const -> BoundingBox
+{
+    const auto& [x, y] = properties.position;
+    return {x, y, x + properties.width, y + properties.height};
+}
+
+bool UiElement::RemoveChild(std::vector<UiElement*>& traversalBuffer, ElementId id)
 {
     if (m_children.size() == size_t(0)) {
         return false;
     }
 
-    auto element = GetChild(traversalBuffer, childName);
-    auto parent = element->GetParent();
+    auto element = GetChild(traversalBuffer, id);
+    if (element == nullptr) {
+        return false;
+    }
 
-    return parent->RemoveImmediateChild(childName);
+    return element->GetParent()->RemoveImmediateChild(id);
 }
 
-bool UiElement::RemoveImmediateChild(const std::string& childName)
+bool UiElement::RemoveImmediateChild(ElementId id)
 {
-    return std::erase_if(m_children,
-                         [childName](std::unique_ptr<UiElement>& child) { return child->GetName() == childName; });
+    Invalidate();
+    return std::erase_if(m_children, [id](const std::unique_ptr<UiElement>& child) { return child->m_id == id; });
 }
 
 void UiElement::RemoveImmediateChildren()
 {
     m_children.clear();
+    Invalidate();
+}
+
+void UiElement::Invalidate()
+{
+    const auto version = GetNextVersion();
+    for (auto* element = this; element != nullptr; element = element->m_parent) {
+        element->m_subtreeVersion = version;
+    }
+}
+
+auto UiElement::GetSubtreeVersion() const -> uint64_t
+{
+    return m_subtreeVersion;
+}
+
+void UiElement::SetCachedAsLayer(bool cached)
+{
+    m_cachedAsLayer = cached;
+    Invalidate();
+}
+
+auto UiElement::IsCachedAsLayer() const -> bool
+{
+    return m_cachedAsLayer;
 }
 
 void UiElement::RearrangeChildren()
@@ -209,11 +429,13 @@ void UiElement::RearrangeChildren()
             const auto childPosX = parentPosition.x + i * childSpace;
             child->properties.position = {childPosX, parentPosition.y};
 
-            std::println("width : {} pos : {}", child->properties.width, childPosX);
-
             i++;
         }
+    }
 
-        std::cout << "===================== " << std::endl;
+    // children got new sizes, so layers rooted at them are stale too
+    Invalidate();
+    for (const auto& child : m_children) {
+        child->m_subtreeVersion = m_subtreeVersion;
     }
 }
@@ -2,6 +2,7 @@
 #include "types.h"
 #include "uielement.h"
 #include <memory>
+#include <memory_resource>
 #include <vector>
 
 UiTree::UiTree(Size screenSize, const size_t traverseBufferCapacity)
@@ -16,14 +17,21 @@ UiTree::UiTree(Size screenSize, const size_t traverseBufferCapacity)
 
 auto UiTree::GetRoot() -> UiElement* { return m_root.get(); }
 
-void UiTree::RemoveChild(const std::string& elementName)
+void UiTree::RemoveChild(ElementId id)
 {
-    m_root->RemoveChild(m_traverseBuffer, elementName);
+    m_root->RemoveChild(m_traverseBuffer, id);
 }
 
-auto UiTree::GetImmediateChildren(const std::string& elementName) -> std::vector<UiElement*>
+void UiTree::RemoveChild(std::string_view elementName)
 {
-    auto child = m_root->GetChild(m_traverseBuffer, "bla");
+    if (const auto id = FindElementId(elementName)) {
+        RemoveChild(*id);
+    }
+}
+
+auto UiTree::GetImmediateChildren(std::string_view elementName) -> std::vector<UiElement*>
+{
+    auto child = m_root->GetChild(m_traverseBuffer, elementName);
     if (child == nullptr) {
         return std::vector<UiElement*>{};
     }
@@ -41,9 +49,66 @@ auto UiTree::GetAllDescendantsBreathFirst() -> std::vector<UiElement*>
     return m_root->GetAllDescendantsBreathFirst(m_traverseBufferQue);
 }
 
-bool UiTree::HasChild(const std::string& name) { return m_root->HasChild(m_traverseBuffer, name); }
+void UiTree::GetAllDescendantsBreathFirst(std::pmr::vector<UiElement*>& elements, bool skipLayerSubtrees)
+{
+    m_root->GetAllDescendantsBreathFirst(elements, skipLayerSubtrees);
+}
+
+void UiTree::GetAllDescendantsBreathFirst(std::pmr::vector<UiElement*>& elements,
+                                          std::pmr::vector<uint32_t>& elementClips,
+                                          std::pmr::vector<BoundingBox>& clipRects, bool skipLayerSubtrees)
+{
+    m_root->GetAllDescendantsBreathFirst(elements, elementClips, clipRects, skipLayerSubtrees);
+}
+
+bool UiTree::HasChild(ElementId id) { return m_root->HasChild(m_traverseBuffer, id); }
+
+bool UiTree::HasChild(std::string_view name) { return m_root->HasChild(m_traverseBuffer, name); }
+
+auto UiTree::GetChild(ElementId id) -> UiElement*
+{
+    return m_root->GetChild(m_traverseBuffer, id);
+}
 
-auto UiTree::GetChild(const std::string& name) -> UiElement*
+auto UiTree::GetChild(std::string_view name) -> UiElement*
 {
     return m_root->GetChild(m_traverseBuffer, name);
 }
+
+auto UiTree::BeginTransaction() -> UiTreeTransaction
+{
+    return UiTreeTransaction(*this);
+}
+
+auto UiTreeMemoryUsage::GetTotal() const -> size_t
+{
+    return elements + children + traversalBuffers;
+}
+
+auto UiTreeMemoryUsage::GetBytesPerElement() const -> double
+{
+    if (elementCount == 0) {
+        return 0;
+    }
+
+    return static_cast<double>(elements + children) / static_cast<double>(elementCount);
+}
+
+auto UiTree::GetMemoryUsage() -> UiTreeMemoryUsage
+{
+    auto elements = std::pmr::vector<UiElement*>();
+    m_root->GetAllDescendantsBreathFirst(elements);
+
+    auto usage = UiTreeMemoryUsage{};
+    usage.elementCount = elements.size();
+    usage.elements = elements.size() * UiElement::GetNodePool().GetBlockSize();
+    for (const auto* element : elements) {
+        usage.children += element->GetChildrenCapacity() * sizeof(std::unique_ptr<UiElement>);
+    }
+
+    usage.traversalBuffers = m_traverseBuffer.capacity() * sizeof(UiElement*);
+    usage.nodePoolReserved = UiElement::GetNodePool().GetReservedBytes();
+    usage.internedNames = GetInternedNameBytes();
+
+    return usage;
+}
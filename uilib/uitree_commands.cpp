@@ -0,0 +1,322 @@
+#include "uitree_commands.h"
+
+#include <cassert>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "uitree.h"
+#include "uitree_transaction.h"
+
+namespace {
+
+// Writes value into the matching field, returns false if the value type does not match
+auto WriteProperty(Properties& properties, PropertyField field, const PropertyValue& value) -> bool
+{
+    const auto write = [&value]<typename T>(T& target) {
+        const auto* typed = std::get_if<T>(&value);
+        if (typed == nullptr) {
+            return false;
+        }
+        target = *typed;
+        return true;
+    };
+
+    switch (field) {
+    case PropertyField::Width:
+        return write(properties.width);
+    case PropertyField::Height:
+        return write(properties.height);
+    case PropertyField::BorderRadius:
+        return write(properties.border_radius_px);
+    case PropertyField::BorderWidth:
+        return write(properties.border_width);
+    case PropertyField::Border:
+        return write(properties.border);
+    case PropertyField::Hidden:
+        return write(properties.hidden);
+    case PropertyField::LayoutChildren:
+        return write(properties.layout_children);
+    case PropertyField::ClipChildren:
+        return write(properties.clip_children);
+    case PropertyField::Position:
+        return write(properties.position);
+    case PropertyField::Color:
+        return write(properties.color);
+    }
+
+    return false;
+}
+
+struct PendingInsertion {
+    UiElement* parent;
+    std::unique_ptr<UiElement> child;
+    bool removed = false;
+};
+
+struct PairHash {
+    auto operator()(const std::pair<UiElement*, PropertyField>& key) const -> size_t
+    {
+        return std::hash<UiElement*>{}(key.first) ^ (static_cast<size_t>(key.second) << 1);
+    }
+};
+
+// State of the tree as seen by the commands of the current batch, elements is the index
+// of the queue which is updated along with the batch
+class BatchState {
+  public:
+    BatchState(UiTree& uiTree, std::unordered_map<ElementId, UiElement*>& elements)
+        : m_root(uiTree.GetRoot())
+        , m_elements(elements)
+    {
+    }
+
+    auto Find(ElementId id) -> UiElement*
+    {
+        const auto found = m_elements.find(id);
+        if (found == m_elements.end() || IsRemoved(found->second)) {
+            return nullptr;
+        }
+        return found->second;
+    }
+
+    auto SetProperty(const SetPropertyCommand& command, UiTreeCommandStats& stats) -> bool
+    {
+        auto* element = Find(command.element);
+        if (element == nullptr) {
+            return false;
+        }
+
+        // elements added in this batch are not in the tree yet and are written directly
+        auto* properties = &element->properties;
+        if (!m_pendingIndex.contains(element)) {
+            properties = &m_propertyWrites.try_emplace(element, element->properties).first->second;
+        }
+
+        if (!WriteProperty(*properties, command.field, command.value)) {
+            return false;
+        }
+
+        if (!m_writtenFields.emplace(element, command.field).second) {
+            stats.coalesced++;
+        }
+        return true;
+    }
+
+    auto AddChild(const AddChildCommand& command) -> bool
+    {
+        auto* parent = Find(command.parent);
+        if (parent == nullptr) {
+            return false;
+        }
+
+        auto child = std::make_unique<UiElement>(command.child, command.type);
+        child->properties = command.properties;
+
+        m_elements.insert_or_assign(command.child, child.get());
+        m_pendingIndex.emplace(child.get(), m_pending.size());
+        m_pending.push_back({parent, std::move(child)});
+        return true;
+    }
+
+    auto RemoveSubtree(const RemoveSubtreeCommand& command) -> bool
+    {
+        auto* element = Find(command.element);
+        if (element == nullptr || element == m_root) {
+            return false;
+        }
+
+        const auto pending = m_pendingIndex.find(element);
+        if (pending != m_pendingIndex.end()) {
+            m_pending[pending->second].removed = true;
+        }
+        else {
+            m_removed.insert(element);
+            m_removals.push_back(element);
+        }
+
+        m_elements.erase(element->GetId());
+        return true;
+    }
+
+    void Commit(UiTree& uiTree)
+    {
+        // subtrees removed before their ancestor go away with it, the transaction rejects nested removals
+        std::erase_if(m_removals, [this](UiElement* element) { return IsRemoved(element->GetParent()); });
+
+        // removed subtrees leave the index while their elements are still alive
+        auto subtree = std::pmr::vector<UiElement*>();
+        for (auto* element : m_removals) {
+            element->GetAllDescendantsBreathFirst(subtree);
+            for (auto* removed : subtree) {
+                Unindex(removed);
+            }
+        }
+
+        auto transaction = uiTree.BeginTransaction();
+
+        for (auto* element : m_removals) {
+            transaction.RemoveChild(element);
+        }
+
+        for (const auto& [element, properties] : m_propertyWrites) {
+            if (!IsRemoved(element) && properties != element->properties) {
+                transaction.SetProperties(element, properties);
+            }
+        }
+
+        // parents always come before their children, so removal of a pending parent is known here
+        for (auto& insertion : m_pending) {
+            if (insertion.removed || IsRemoved(insertion.parent)) {
+                insertion.removed = true;
+                Unindex(insertion.child.get());
+                continue;
+            }
+            transaction.AddChild(insertion.parent, std::move(insertion.child));
+        }
+
+        transaction.Commit();
+    }
+
+  private:
+    // Removes the entry of element, an element with the same id elsewhere keeps its entry
+    void Unindex(UiElement* element)
+    {
+        const auto found = m_elements.find(element->GetId());
+        if (found != m_elements.end() && found->second == element) {
+            m_elements.erase(found);
+        }
+    }
+
+    auto IsRemoved(UiElement* element) const -> bool
+    {
+        const auto pending = m_pendingIndex.find(element);
+        if (pending != m_pendingIndex.end()) {
+            const auto& insertion = m_pending[pending->second];
+            return insertion.removed || IsRemoved(insertion.parent);
+        }
+
+        for (auto* current = element; current != nullptr; current = current->GetParent()) {
+            if (m_removed.contains(current)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    UiElement* m_root;
+    std::unordered_map<ElementId, UiElement*>& m_elements;
+
+    std::vector<PendingInsertion> m_pending;
+    std::unordered_map<UiElement*, size_t> m_pendingIndex;
+
+    std::unordered_set<UiElement*> m_removed;
+    std::vector<UiElement*> m_removals;
+
+    std::unordered_map<UiElement*, Properties> m_propertyWrites;
+    std::unordered_set<std::pair<UiElement*, PropertyField>, PairHash> m_writtenFields;
+};
+
+} // namespace
+
+void UiTreeCommandQueue::Post(UiTreeCommand command)
+{
+    const auto lock = std::lock_guard(m_mutex);
+    m_commands.push_back(std::move(command));
+}
+
+void UiTreeCommandQueue::SetProperty(ElementId element, PropertyField field, PropertyValue value)
+{
+    Post(SetPropertyCommand{element, field, value});
+}
+
+void UiTreeCommandQueue::AddChild(ElementId parent, ElementId child, ElemType type, const Properties& properties)
+{
+    Post(AddChildCommand{parent, child, type, properties});
+}
+
+void UiTreeCommandQueue::RemoveSubtree(ElementId element)
+{
+    Post(RemoveSubtreeCommand{element});
+}
+
+auto UiTreeCommandQueue::Apply(UiTree& uiTree) -> UiTreeCommandStats
+{
+    {
+        const auto lock = std::lock_guard(m_mutex);
+        std::swap(m_commands, m_applying);
+    }
+
+    auto stats = UiTreeCommandStats{};
+    if (m_applying.empty()) {
+        return stats;
+    }
+
+    // any change made outside the queue bumps the root version, versions are never reused
+    auto* root = uiTree.GetRoot();
+    if (root != m_indexedRoot || root->GetSubtreeVersion() != m_indexedVersion) {
+        Reindex(uiTree);
+        stats.reindexed = true;
+    }
+
+    auto batch = BatchState(uiTree, m_elements);
+    for (auto& command : m_applying) {
+        const auto applied = std::visit(
+            [&batch, &stats](auto& typed) {
+                using Command = std::decay_t<decltype(typed)>;
+                if constexpr (std::is_same_v<Command, SetPropertyCommand>) {
+                    return batch.SetProperty(typed, stats);
+                }
+                else if constexpr (std::is_same_v<Command, AddChildCommand>) {
+                    return batch.AddChild(typed);
+                }
+                else {
+                    return batch.RemoveSubtree(typed);
+                }
+            },
+            command);
+
+        if (applied) {
+            stats.applied++;
+        }
+        else {
+            stats.dropped++;
+        }
+    }
+    m_applying.clear();
+
+    // the index already reflects the batch, it is stale if the transaction is rejected
+    try {
+        batch.Commit(uiTree);
+    }
+    catch (const std::runtime_error&) {
+        m_indexedRoot = nullptr;
+        throw;
+    }
+
+    m_indexedVersion = root->GetSubtreeVersion();
+    return stats;
+}
+
+void UiTreeCommandQueue::Reindex(UiTree& uiTree)
+{
+    auto* root = uiTree.GetRoot();
+
+    m_elements.clear();
+    for (auto* element : uiTree.GetAllDescendantsDepthFirst()) {
+        m_elements.insert_or_assign(element->GetId(), element);
+    }
+    m_elements.insert_or_assign(root->GetId(), root);
+
+    m_indexedRoot = root;
+    m_indexedVersion = root->GetSubtreeVersion();
+}
+
+auto UiTreeCommandQueue::GetPendingCount() const -> size_t
+{
+    const auto lock = std::lock_guard(m_mutex);
+    return m_commands.size();
+}
@@ -0,0 +1,343 @@
+#include "uitree_transaction.h"
+#include "uielement.h"
+#include "uitree.h"
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// Relayouts element and all of its descendants top down, so every parent is
+// positioned before its own children are arranged
+void RearrangeSubtree(UiElement* element, std::vector<UiElement*>& stack)
+{
+    stack.clear();
+    stack.push_back(element);
+
+    while (!stack.empty()) {
+        auto current = stack.back();
+        stack.pop_back();
+
+        current->RearrangeChildren();
+        for (const auto& child : current->GetAllChildren()) {
+            stack.push_back(child);
+        }
+    }
+}
+
+// True if an ancestor of element is dirty. covered remembers the answer for the ancestors which
+// were walked through, so walks of many dirty elements share their common part
+auto IsCoveredByDirtyAncestor(UiElement* element, const std::unordered_set<UiElement*>& dirty,
+                              std::unordered_map<UiElement*, bool>& covered, std::vector<UiElement*>& path) -> bool
+{
+    // ancestor's own answer is whether it or anything above it is dirty
+    path.clear();
+    auto result = false;
+    for (auto* ancestor = element->GetParent(); ancestor != nullptr; ancestor = ancestor->GetParent()) {
+        if (const auto known = covered.find(ancestor); known != covered.end()) {
+            result = known->second;
+            break;
+        }
+        if (dirty.contains(ancestor)) {
+            result = true;
+            break;
+        }
+        path.push_back(ancestor);
+    }
+
+    for (auto* ancestor : path) {
+        covered.emplace(ancestor, result);
+    }
+    return result;
+}
+
+} // namespace
+
+UiTreeTransaction::UiTreeTransaction(UiTree& uiTree)
+    : m_uiTree(&uiTree)
+{
+}
+
+void UiTreeTransaction::AddChild(UiElement* parent, std::unique_ptr<UiElement> child)
+{
+    m_insertions.push_back({parent, std::move(child)});
+}
+
+void UiTreeTransaction::RemoveChild(UiElement* element)
+{
+    m_removals.push_back(element);
+}
+
+void UiTreeTransaction::MoveChild(UiElement* element, UiElement* newParent)
+{
+    m_moves.push_back({element, newParent});
+}
+
+void UiTreeTransaction::ReorderChildren(UiElement* parent, std::vector<UiElement*> order)
+{
+    m_reorders.push_back({parent, std::move(order)});
+}
+
+void UiTreeTransaction::SetProperties(UiElement* element, const Properties& properties)
+{
+    m_propertyChanges.push_back({element, properties});
+}
+
+auto UiTreeTransaction::GetSize() const -> size_t
+{
+    return m_insertions.size() + m_removals.size() + m_moves.size() + m_reorders.size() + m_propertyChanges.size();
+}
+
+void UiTreeTransaction::Validate() const
+{
+    auto* root = m_uiTree->GetRoot();
+
+    // elements created or moved in this transaction are looked up through their queued parent
+    auto pendingParents = std::unordered_map<UiElement*, UiElement*>{};
+    for (const auto& [parent, child] : m_insertions) {
+        if (parent == nullptr || child == nullptr) {
+            throw std::runtime_error("Ui tree transaction - insertion with null parent or child");
+        }
+        pendingParents.emplace(child.get(), parent);
+    }
+
+    auto movedElements = std::unordered_set<UiElement*>{};
+    for (const auto& [element, newParent] : m_moves) {
+        if (element == nullptr || newParent == nullptr || element == root) {
+            throw std::runtime_error("Ui tree transaction - invalid move");
+        }
+
+        if (pendingParents.contains(element) || !movedElements.insert(element).second) {
+            throw std::runtime_error("Ui tree transaction - element can be moved only once and only if in the tree");
+        }
+    }
+
+    // live parents are needed to check moved elements, so they are added only after the loop above
+    for (const auto& [element, newParent] : m_moves) {
+        pendingParents[element] = newParent;
+    }
+
+    auto removed = std::unordered_set<UiElement*>(m_removals.begin(), m_removals.end());
+    if (removed.contains(root)) {
+        throw std::runtime_error("Ui tree transaction - root element can not be removed");
+    }
+
+    // walks up to the root, fails for elements outside of the tree or inside removed subtrees,
+    // with moves queued the queued parents can form a cycle which also fails. Walks stop at elements
+    // an earlier walk already reached the root from, so every element is walked through once
+    auto visited = std::unordered_set<UiElement*>{};
+    auto reachable = std::unordered_set<UiElement*>{root};
+    const auto checkReachable = [&](UiElement* element, std::string_view operation) {
+        visited.clear();
+        for (auto* current = element; !reachable.contains(current);) {
+            if (current == nullptr) {
+                throw std::runtime_error(
+                    std::format("Ui tree transaction - {} targets element outside the tree", operation));
+            }
+
+            if (removed.contains(current) && current != element) {
+                throw std::runtime_error(std::format("Ui tree transaction - {} targets removed subtree", operation));
+            }
+
+            if (visited.contains(current)) {
+                throw std::runtime_error(std::format("Ui tree transaction - {} creates a cycle", operation));
+            }
+
+            visited.insert(current);
+            const auto pending = pendingParents.find(current);
+            current = pending != pendingParents.end() ? pending->second : current->GetParent();
+        }
+
+        // a removed element itself is reachable, but nothing below it is
+        for (auto* current : visited) {
+            if (!removed.contains(current)) {
+                reachable.insert(current);
+            }
+        }
+    };
+
+    // final number of children of every parent which gains children
+    auto childCounts = std::unordered_map<UiElement*, size_t>{};
+    const auto addChildTo = [&](UiElement* parent) {
+        auto [count, inserted] = childCounts.try_emplace(parent, parent->GetAllChildren().size());
+        count->second++;
+    };
+
+    for (const auto& [parent, child] : m_insertions) {
+        if (removed.contains(parent)) {
+            throw std::runtime_error("Ui tree transaction - insertion into removed element");
+        }
+        checkReachable(parent, "insertion");
+        addChildTo(parent);
+    }
+
+    for (const auto& [element, newParent] : m_moves) {
+        if (removed.contains(element) || removed.contains(newParent)) {
+            throw std::runtime_error("Ui tree transaction - move of or into removed element");
+        }
+        checkReachable(element, "move");
+        addChildTo(newParent);
+    }
+
+    for (const auto& [element, newParent] : m_moves) {
+        if (auto count = childCounts.find(element->GetParent()); count != childCounts.end()) {
+            count->second--;
+        }
+    }
+
+    for (const auto& element : m_removals) {
+        if (pendingParents.contains(element)) {
+            throw std::runtime_error("Ui tree transaction - removal of element added or moved in the same transaction");
+        }
+        checkReachable(element, "removal");
+
+        if (auto count = childCounts.find(element->GetParent()); count != childCounts.end()) {
+            count->second--;
+        }
+    }
+
+    for (const auto& [element, _] : m_propertyChanges) {
+        if (removed.contains(element)) {
+            throw std::runtime_error("Ui tree transaction - property change of removed element");
+        }
+        checkReachable(element, "property change");
+    }
+
+    for (const auto& [parent, count] : childCounts) {
+        if (count > MAX_CHILDREN) {
+            throw std::runtime_error(std::format("Ui tree transaction - too many children for {}, max - {}, real - {}",
+                                                 parent->GetName(), MAX_CHILDREN, count));
+        }
+    }
+
+    if (!m_reorders.empty()) {
+        ValidateReorders(pendingParents, removed);
+    }
+}
+
+void UiTreeTransaction::ValidateReorders(const std::unordered_map<UiElement*, UiElement*>& pendingParents,
+                                         const std::unordered_set<UiElement*>& removed) const
+{
+    // children which end up under a parent through this transaction
+    auto arriving = std::unordered_map<UiElement*, std::vector<UiElement*>>{};
+    for (const auto& [child, parent] : pendingParents) {
+        arriving[parent].push_back(child);
+    }
+
+    auto finalChildren = std::unordered_set<UiElement*>{};
+    for (const auto& [parent, order] : m_reorders) {
+        if (parent == nullptr || removed.contains(parent)) {
+            throw std::runtime_error("Ui tree transaction - reorder of removed element");
+        }
+
+        finalChildren.clear();
+        for (const auto& child : parent->GetAllChildren()) {
+            // children moved away keep an entry in pending parents pointing elsewhere
+            if (!removed.contains(child) && !pendingParents.contains(child)) {
+                finalChildren.insert(child);
+            }
+        }
+
+        if (const auto found = arriving.find(parent); found != arriving.end()) {
+            finalChildren.insert(found->second.begin(), found->second.end());
+        }
+
+        if (order.size() != finalChildren.size()) {
+            throw std::runtime_error(std::format("Ui tree transaction - reorder of {} has {} children, expected {}",
+                                                 parent->GetName(), order.size(), finalChildren.size()));
+        }
+
+        for (const auto& child : order) {
+            if (finalChildren.erase(child) == 0) {
+                throw std::runtime_error(
+                    std::format("Ui tree transaction - reorder of {} lists unknown or duplicate child", parent->GetName()));
+            }
+        }
+    }
+}
+
+void UiTreeTransaction::Commit()
+{
+    Validate();
+
+    // every parent that gets new or loses old children, and every element with new
+    // properties needs a relayout of its subtree
+    auto dirty = std::unordered_set<UiElement*>{};
+
+    auto removed = std::unordered_set<UiElement*>(m_removals.begin(), m_removals.end());
+    const auto isInRemovedSubtree = [&removed](UiElement* element) {
+        for (auto* current = element; current != nullptr; current = current->GetParent()) {
+            if (removed.contains(current)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // moves go first, so elements moved out of removed subtrees survive the removal
+    for (const auto& [element, newParent] : m_moves) {
+        auto* oldParent = element->GetParent();
+        auto released = oldParent->ReleaseChild(element);
+
+        auto moved = std::vector<std::unique_ptr<UiElement>>{};
+        moved.emplace_back(std::move(released));
+        newParent->AttachChildren(std::move(moved));
+
+        if (!isInRemovedSubtree(oldParent)) {
+            dirty.insert(oldParent);
+        }
+        dirty.insert(newParent);
+    }
+
+    auto removalsByParent = std::unordered_map<UiElement*, std::vector<UiElement*>>{};
+    for (const auto& element : m_removals) {
+        removalsByParent[element->GetParent()].push_back(element);
+    }
+
+    for (auto& [parent, children] : removalsByParent) {
+        parent->DetachChildren(children);
+        dirty.insert(parent);
+    }
+
+    for (auto& [element, properties] : m_propertyChanges) {
+        element->properties = properties;
+        element->Invalidate();
+        dirty.insert(element);
+    }
+
+    // insertion order is kept per parent
+    auto insertionsByParent = std::unordered_map<UiElement*, std::vector<std::unique_ptr<UiElement>>>{};
+    for (auto& [parent, child] : m_insertions) {
+        insertionsByParent[parent].emplace_back(std::move(child));
+    }
+
+    for (auto& [parent, children] : insertionsByParent) {
+        parent->AttachChildren(std::move(children));
+        dirty.insert(parent);
+    }
+
+    for (const auto& [parent, order] : m_reorders) {
+        parent->ReorderChildren(order);
+        dirty.insert(parent);
+    }
+
+    // only the top most dirty elements are relaid out, their subtrees cover the rest
+    auto stack = std::vector<UiElement*>{};
+    auto path = std::vector<UiElement*>{};
+    auto covered = std::unordered_map<UiElement*, bool>{};
+    for (auto* element : dirty) {
+        if (!IsCoveredByDirtyAncestor(element, dirty, covered, path)) {
+            RearrangeSubtree(element, stack);
+        }
+    }
+
+    m_insertions.clear();
+    m_removals.clear();
+    m_moves.clear();
+    m_reorders.clear();
+    m_propertyChanges.clear();
+}
@@ -0,0 +1,207 @@
+#include "virtual_list.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+VirtualList::VirtualList(UiElement* container, float rowHeight, BindRowCallback bindRow, size_t overscan,
+                         CreateRowCallback createRow)
+    : m_container(container)
+    , m_rowHeight(rowHeight)
+    , m_overscan(overscan)
+    , m_bindRow(std::move(bindRow))
+    , m_createRow(std::move(createRow))
+    , m_rowCount(0)
+    , m_scrollOffset(0)
+    , m_slots()
+    , m_subtree()
+    , m_stats()
+{
+    assert(m_container != nullptr);
+    assert(m_rowHeight > 0);
+
+    if (!m_createRow) {
+        m_createRow = [](ElementId id) { return std::make_unique<UiElement>(id, ElemType::Box); };
+    }
+
+    // rows are positioned by the list, horizontal layout would squeeze them next to each other,
+    // rows scrolled past the edges are cut and overscan rows are culled by the renderer
+    m_container->properties.layout_children = LayoutDirection::Vertical;
+    m_container->properties.clip_children = true;
+}
+
+void VirtualList::SetRowCount(size_t rowCount)
+{
+    m_rowCount = rowCount;
+    ScrollTo(m_scrollOffset);
+    Refresh();
+}
+
+auto VirtualList::GetRowCount() const -> size_t
+{
+    return m_rowCount;
+}
+
+void VirtualList::Refresh()
+{
+    for (auto& slot : m_slots) {
+        slot.row = UNBOUND;
+    }
+}
+
+void VirtualList::ScrollTo(double offset)
+{
+    m_scrollOffset = std::clamp(offset, 0.0, GetMaxScrollOffset());
+}
+
+void VirtualList::ScrollBy(double delta)
+{
+    ScrollTo(m_scrollOffset + delta);
+}
+
+auto VirtualList::GetScrollOffset() const -> double
+{
+    return m_scrollOffset;
+}
+
+auto VirtualList::GetMaxScrollOffset() const -> double
+{
+    return std::max(0.0, static_cast<double>(m_rowCount) * m_rowHeight - GetViewportHeight());
+}
+
+auto VirtualList::GetFirstVisibleRow() const -> size_t
+{
+    if (m_rowCount == 0) {
+        return 0;
+    }
+
+    return std::min(static_cast<size_t>(m_scrollOffset / m_rowHeight), m_rowCount - 1);
+}
+
+auto VirtualList::GetRowAt(float y) const -> std::optional<size_t>
+{
+    const auto viewportY = static_cast<double>(y) - m_container->properties.position.y;
+    if (viewportY < 0 || viewportY >= GetViewportHeight()) {
+        return std::nullopt;
+    }
+
+    const auto row = static_cast<size_t>((m_scrollOffset + viewportY) / m_rowHeight);
+    if (row >= m_rowCount) {
+        return std::nullopt;
+    }
+
+    return row;
+}
+
+auto VirtualList::GetRowElement(size_t row) const -> UiElement*
+{
+    if (m_slots.empty()) {
+        return nullptr;
+    }
+
+    const auto& slot = m_slots[row % m_slots.size()];
+    return slot.row == row ? slot.element : nullptr;
+}
+
+void VirtualList::Update()
+{
+    // a partially visible row at both edges, overscan on both sides
+    const auto visibleRows = static_cast<size_t>(std::ceil(GetViewportHeight() / m_rowHeight)) + 1;
+    const auto poolSize = std::min(m_rowCount, visibleRows + 2 * m_overscan);
+    if (poolSize > MAX_CHILDREN) {
+        throw std::runtime_error(
+            std::format("Virtual list viewport needs too many rows, max - {}, real - {}", MAX_CHILDREN, poolSize));
+    }
+
+    if (poolSize != m_slots.size()) {
+        ResizePool(poolSize);
+    }
+
+    // ScrollTo clamped against the previous height if the container was resized since
+    ScrollTo(m_scrollOffset);
+    if (m_slots.empty()) {
+        return;
+    }
+
+    // window has exactly one row per slot, at the ends the overscan moves to the other side
+    const auto firstVisible = GetFirstVisibleRow();
+    const auto firstRow = std::min(firstVisible - std::min(firstVisible, m_overscan), m_rowCount - poolSize);
+
+    const auto& container = m_container->properties;
+    for (auto row = firstRow; row < firstRow + poolSize; row++) {
+        auto& slot = m_slots[row % poolSize];
+        auto* element = slot.element;
+
+        // relative to the scroll offset in double, absolute row positions do not fit a float
+        const auto viewportY = static_cast<double>(row) * m_rowHeight - m_scrollOffset;
+        const auto y = container.position.y + static_cast<float>(viewportY);
+
+        if (slot.row != row) {
+            slot.row = row;
+            element->properties.position = {container.position.x, y};
+            element->properties.width = container.width;
+            element->properties.height = m_rowHeight;
+            m_bindRow(row, *element);
+            element->Invalidate();
+            m_stats.rowsBound++;
+        }
+        else if (element->properties.position.y != y) {
+            MoveSubtree(element, y - element->properties.position.y);
+            element->Invalidate();
+            m_stats.rowsMoved++;
+        }
+    }
+}
+
+auto VirtualList::GetMaterializedRowCount() const -> size_t
+{
+    return m_slots.size();
+}
+
+auto VirtualList::GetStats() const -> const VirtualListStats&
+{
+    return m_stats;
+}
+
+auto VirtualList::GetViewportHeight() const -> double
+{
+    return m_container->properties.height;
+}
+
+void VirtualList::ResizePool(size_t poolSize)
+{
+    if (poolSize < m_slots.size()) {
+        auto released = std::vector<UiElement*>();
+        for (auto slot = m_slots.begin() + poolSize; slot != m_slots.end(); slot++) {
+            released.push_back(slot->element);
+        }
+
+        m_container->DetachChildren(released);
+        m_slots.resize(poolSize);
+    }
+    else {
+        auto created = std::vector<std::unique_ptr<UiElement>>();
+        for (auto slot = m_slots.size(); slot < poolSize; slot++) {
+            auto element = m_createRow(InternElementId(std::format("{}-row-{}", m_container->GetName(), slot)));
+            m_slots.push_back({element.get(), UNBOUND});
+            created.push_back(std::move(element));
+        }
+
+        m_stats.rowsCreated += created.size();
+        m_container->AttachChildren(std::move(created));
+    }
+
+    // slot of a row depends on the pool size
+    Refresh();
+}
+
+void VirtualList::MoveSubtree(UiElement* element, float deltaY)
+{
+    element->GetAllDescendantsBreathFirst(m_subtree);
+    for (auto* descendant : m_subtree) {
+        descendant->properties.position.y += deltaY;
+    }
+}